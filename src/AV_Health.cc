@@ -25,6 +25,11 @@
 #include "Disease.h"
 #include "Person.h"
 #include "Global.h"
+#include "Population.h"
+#include "AV_Manager.h"
+#include "Antivirals.h"
+#include "Checkpoint.h"
+#include "Utils.h"
 
 using namespace std;
 
@@ -37,6 +42,44 @@ AV_Health::AV_Health(int _av_day, Antiviral* _AV, Health* _health){
   av_end_day      = av_day + AV->get_course_length();
 } 
 
+AV_Health::AV_Health() {
+  av_day = -1;
+  av_end_day = -1;
+  health = NULL;
+  disease = -1;
+  AV = NULL;
+}
+
+void AV_Health::write_checkpoint( Checkpoint & checkpoint ) const {
+  checkpoint.write( av_day );
+  checkpoint.write( av_end_day );
+  checkpoint.write( disease );
+  Antivirals * antivirals = Global::Pop.get_av_manager()->get_antivirals();
+  int av_index = -1;
+  for ( int i = 0; i < antivirals->get_number_antivirals(); ++i ) {
+    if ( antivirals->get_AV( i ) == AV ) {
+      av_index = i;
+    }
+  }
+  checkpoint.write( av_index );
+}
+
+AV_Health * AV_Health::read_checkpoint( Health * health, Checkpoint & checkpoint ) {
+  AV_Health * av_health = new AV_Health();
+  av_health->health = health;
+  checkpoint.read( av_health->av_day );
+  checkpoint.read( av_health->av_end_day );
+  checkpoint.read( av_health->disease );
+  int av_index;
+  checkpoint.read( av_index );
+  Antivirals * antivirals = Global::Pop.get_av_manager()->get_antivirals();
+  if ( av_index < 0 || av_index >= antivirals->get_number_antivirals() ) {
+    Utils::fred_abort( "Checkpoint has antiviral %d, which is not in the parameters\n", av_index );
+  }
+  av_health->AV = antivirals->get_AV( av_index );
+  return av_health;
+}
+
 void AV_Health::print() const {
   // Need to figure out what to write here
   cout << "\nAV_Status";
@@ -25,6 +25,7 @@
 class Antiviral;
 class Antivirals;
 class Health;
+class Checkpoint;
 
 using namespace std;
 
@@ -103,6 +104,10 @@ public:
    * Print out information about this object to the trace file
    */
   virtual void printTrace() const;
+
+  // see Checkpoint
+  void write_checkpoint( Checkpoint & checkpoint ) const;
+  static AV_Health * read_checkpoint( Health * health, Checkpoint & checkpoint );
   
   
 private:
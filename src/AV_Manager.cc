@@ -24,6 +24,9 @@
 #include "Antiviral.h"
 #include "Params.h"
 #include "Person.h"
+#include "Health.h"
+#include "Checkpoint.h"
+#include "Utils.h"
 
 AV_Manager::AV_Manager() {
   pop = NULL;
@@ -94,10 +97,32 @@ void AV_Manager::set_policies(){
   are_policies_set = true;
 }
 
+void AV_Manager::give_to_symptomatics::operator() (Person & person) {
+  if(!person.is_symptomatic()){
+    // no longer symptomatic with any disease
+    Global::Pop.clear_mask_by_index(fred::Symptomatic, person.get_pop_index());
+    return;
+  }
+  if(av->get_current_stock() == 0) return;
+  if(!person.get_health()->is_symptomatic(av->get_disease())) return;
+  if(av->get_policy()->choose_first_negative(&person,av->get_disease(),day) == true){
+    if(Global::Debug > 3) cout << "Giving Antiviral for disease " << av->get_disease() << " to " << person.get_pop_index() << "\n";
+    av->remove_stock(1);
+    person.get_health()->take(&person,av,day);
+  }
+}
+
 void AV_Manager::disseminate(int day){
   // There is no queue, only the whole population
   if(do_av==0) return;
   int npeople = pop->get_pop_size();
+  // timed for tests/av_dissemination (verbose > 1)
+  double start_time = 0.0;
+  int symptomatic = 0;
+  if(Global::Verbose > 1){
+    start_time = fred::omp_get_wtime();
+    symptomatic = pop->size(fred::Symptomatic);
+  }
   //current_day = day;
   // The av_package are in a priority based order, so lets loop over the av_package first
   vector < Antiviral* > avs = av_package->get_AV_vector();
@@ -109,6 +134,14 @@ void AV_Manager::disseminate(int day){
       
       current_av = av;
 
+      if(!av->is_prophylaxis()){
+        // Only symptomatic people can pass AV_Decision_Give_to_Sympt, so
+        // visit just those, in the same (index) order as the loop below
+        give_to_symptomatics give(av, day);
+        pop->masked_apply(fred::Symptomatic, give);
+        continue;
+      }
+
       for(int ip=0;ip<npeople;ip++){
         if(av->get_current_stock()== 0) break;
         Person* current_person = pop->get_person_by_index(ip);
@@ -123,6 +156,26 @@ void AV_Manager::disseminate(int day){
       }
     }
   }
+  FRED_STATUS(1, "day %d antivirals disseminated: %d symptomatic of %d people, %.3f ms\n",
+      day, symptomatic, npeople, 1000.0 * (fred::omp_get_wtime() - start_time));
 }
 
+void AV_Manager::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("antiviral manager");
+  checkpoint.write(do_av);
+  if (do_av) {
+    av_package->write_checkpoint(checkpoint);
+  }
+}
 
+void AV_Manager::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("antiviral manager");
+  bool saved_do_av;
+  checkpoint.read(saved_do_av);
+  if (saved_do_av != do_av) {
+    Utils::fred_abort("Checkpoint was taken with%s antivirals\n", saved_do_av ? "" : "out");
+  }
+  if (do_av) {
+    av_package->read_checkpoint(checkpoint);
+  }
+}
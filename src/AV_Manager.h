@@ -26,6 +26,7 @@
 class Population;
 class Person;
 class Policy; 
+class Checkpoint;
 
 class AV_Manager: public Manager {
 public:
@@ -97,6 +98,13 @@ public:
    */
   void reset();
 
+  /**
+   * Write the stocks and counts to a checkpoint, or read them back (see
+   * Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Print out information about this object
    */
@@ -115,6 +123,14 @@ private:
   bool are_policies_set;         //Ensure that the policies for AVs have been set.
   
   Antiviral* current_av;           //NEED TO ELIMINATE, HIDDEN to IMPLEMENTATION
+
+  // disseminate to the people with fred::Symptomatic set
+  struct give_to_symptomatics {
+    Antiviral * av;
+    int day;
+    give_to_symptomatics(Antiviral * a, int d) : av(a), day(d) { }
+    void operator() (Person & person);
+  };
 };
 
 #endif
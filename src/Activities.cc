@@ -35,6 +35,7 @@
 #include "Place_List.h"
 #include "Utils.h"
 #include "Travel.h"
+#include "Checkpoint.h"
 
 bool Activities::is_initialized = false;
 bool Activities::is_weekday = false;
@@ -439,6 +440,7 @@ void Activities::assign_school( Person * self ) {
   Place *p = grid_cell->select_random_school(age);
   if (p != NULL) {
     set_school(p);
+    p->enroll(self);
     set_classroom(NULL);
     assign_classroom( self );
     return;
@@ -485,6 +487,7 @@ void Activities::assign_school( Person * self ) {
         p = nbr->select_random_school(age);
         if(p != NULL) {
           set_school(p);
+          p->enroll(self);
           set_classroom(NULL);
           assign_classroom( self );
           return;
@@ -528,6 +531,7 @@ void Activities::assign_workplace( Person * self ) {
   Place *p = grid_cell->select_random_workplace();
   if (p != NULL) {
     set_workplace(p);
+    p->enroll(self);
     set_office(NULL);
     assign_office( self );
     return;
@@ -575,6 +579,7 @@ void Activities::assign_workplace( Person * self ) {
         p = nbr->select_random_workplace();
         if(p != NULL) {
           set_workplace(p);
+          p->enroll(self);
           set_office(NULL);
           assign_office( self );
           return;
@@ -646,12 +651,14 @@ void Activities::update_profile( Person * self ) {
           to_string( self ).c_str() );
     }
     else {
+      c->unenroll(self);
       if ( s != NULL && s->classrooms_for_age( age ) > 0 ) {
         // pick a new classrooms in current school
         set_classroom(NULL);
         assign_classroom( self );
       }
       else {
+        if (s != NULL) s->unenroll(self);
         assign_school( self );
       }
       FRED_STATUS( 1,
@@ -669,6 +676,8 @@ void Activities::update_profile( Person * self ) {
 
   if ( profile == STUDENT_PROFILE && Global::ADULT_AGE <= age ) {
     // leave school
+    if (get_school() != NULL) get_school()->unenroll(self);
+    if (get_classroom() != NULL) get_classroom()->unenroll(self);
     set_school(NULL);
     set_classroom(NULL);
     // get a job
@@ -688,9 +697,13 @@ void Activities::update_profile( Person * self ) {
       FRED_STATUS( 1, "to_string: %s\n", to_string( self ).c_str() );
       // quit working
       if (is_teacher()) {
+        if (get_school() != NULL) get_school()->unenroll(self);
+        if (get_classroom() != NULL) get_classroom()->unenroll(self);
         set_school(NULL);
         set_classroom(NULL);
       }
+      if (get_workplace() != NULL) get_workplace()->unenroll(self);
+      if (get_office() != NULL) get_office()->unenroll(self);
       set_workplace(NULL);
       set_office(NULL);
       profile = RETIRED_PROFILE;
@@ -914,3 +927,105 @@ void Activities::terminate( Person * self ) {
 
 void Activities::end_of_run() {
 }
+
+void Activities::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write( travel_status );
+  checkpoint.write( traveling_outside );
+  write_favorite_places( checkpoint, favorite_places_map );
+  // the places kept while traveling within the modeled area
+  if ( travel_status && !traveling_outside ) {
+    write_favorite_places( checkpoint, *tmp_favorite_places_map );
+  }
+  checkpoint.write_place( home_neighborhood );
+  checkpoint.write( on_schedule.to_ulong() );
+  checkpoint.write( schedule_updated );
+  checkpoint.write( profile );
+  checkpoint.write( my_sick_days_absent );
+  checkpoint.write( my_sick_days_present );
+  checkpoint.write( sick_days_remaining );
+  checkpoint.write( sick_leave_available );
+  checkpoint.write( my_sick_leave_decision_has_been_made );
+  checkpoint.write( my_sick_leave_decision );
+}
+
+void Activities::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read( travel_status );
+  checkpoint.read( traveling_outside );
+  read_favorite_places( checkpoint, favorite_places_map );
+  tmp_favorite_places_map = NULL;
+  if ( travel_status && !traveling_outside ) {
+    tmp_favorite_places_map = new std::map< int, Place * >();
+    read_favorite_places( checkpoint, *tmp_favorite_places_map );
+  }
+  household_census_block = NULL;
+  home_neighborhood = checkpoint.read_place();
+  unsigned long schedule;
+  checkpoint.read( schedule );
+  on_schedule = std::bitset< FAVORITE_PLACES >( schedule );
+  checkpoint.read( schedule_updated );
+  checkpoint.read( profile );
+  checkpoint.read( my_sick_days_absent );
+  checkpoint.read( my_sick_days_present );
+  checkpoint.read( sick_days_remaining );
+  checkpoint.read( sick_leave_available );
+  checkpoint.read( my_sick_leave_decision_has_been_made );
+  checkpoint.read( my_sick_leave_decision );
+}
+
+void Activities::write_favorite_places( Checkpoint & checkpoint,
+    std::map< int, Place * > & places ) {
+  checkpoint.write_size( places.size() );
+  for ( std::map< int, Place * >::iterator it = places.begin(); it != places.end(); ++it ) {
+    checkpoint.write( it->first );
+    checkpoint.write_place( it->second );
+  }
+}
+
+void Activities::read_favorite_places( Checkpoint & checkpoint,
+    std::map< int, Place * > & places ) {
+  places.clear();
+  size_t n = checkpoint.read_size();
+  for ( size_t i = 0; i < n; ++i ) {
+    int activity;
+    checkpoint.read( activity );
+    places[ activity ] = checkpoint.read_place();
+  }
+}
+
+void Activities::write_static_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write_tag( "activities" );
+  checkpoint.write( Sick_days_present );
+  checkpoint.write( Sick_days_absent );
+  checkpoint.write( School_sick_days_present );
+  checkpoint.write( School_sick_days_absent );
+  checkpoint.write( employees_small_with_sick_leave );
+  checkpoint.write( employees_small_without_sick_leave );
+  checkpoint.write( employees_med_with_sick_leave );
+  checkpoint.write( employees_med_without_sick_leave );
+  checkpoint.write( employees_large_with_sick_leave );
+  checkpoint.write( employees_large_without_sick_leave );
+  checkpoint.write( employees_xlarge_with_sick_leave );
+  checkpoint.write( employees_xlarge_without_sick_leave );
+  checkpoint.write( mobility_count );
+  checkpoint.write( mobility_moved );
+  checkpoint.write( mcount );
+}
+
+void Activities::read_static_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "activities" );
+  checkpoint.read( Sick_days_present );
+  checkpoint.read( Sick_days_absent );
+  checkpoint.read( School_sick_days_present );
+  checkpoint.read( School_sick_days_absent );
+  checkpoint.read( employees_small_with_sick_leave );
+  checkpoint.read( employees_small_without_sick_leave );
+  checkpoint.read( employees_med_with_sick_leave );
+  checkpoint.read( employees_med_without_sick_leave );
+  checkpoint.read( employees_large_with_sick_leave );
+  checkpoint.read( employees_large_without_sick_leave );
+  checkpoint.read( employees_xlarge_with_sick_leave );
+  checkpoint.read( employees_xlarge_without_sick_leave );
+  checkpoint.read( mobility_count );
+  checkpoint.read( mobility_moved );
+  checkpoint.read( mcount );
+}
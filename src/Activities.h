@@ -27,6 +27,7 @@
 
 class Person;
 class Place;
+class Checkpoint;
 
 // the following enum defines symbolic names for
 // activities.  The last element should always be
@@ -361,6 +362,7 @@ public:
   static void update(int day);
   static void end_of_run();
   static void before_run();
+  static double get_community_distance() { return Community_distance; }
   bool is_teacher() { return profile == TEACHER_PROFILE; }
   bool is_student() { return profile == STUDENT_PROFILE; }
 
@@ -371,6 +373,15 @@ public:
    */
   static void read_init_files();
 
+  /**
+   * Write the activities of this Person, or the counts kept for all of them,
+   * to a checkpoint, or read them back (see Checkpoint)
+   */
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
+  static void write_static_checkpoint( Checkpoint & checkpoint );
+  static void read_static_checkpoint( Checkpoint & checkpoint );
+
 private:
 
   // current favorite places
@@ -484,6 +495,9 @@ private:
     delete tmp_favorite_places_map;
   }
 
+  static void write_favorite_places( Checkpoint & checkpoint, std::map< int, Place * > & places );
+  static void read_favorite_places( Checkpoint & checkpoint, std::map< int, Place * > & places );
+
   int get_place_id( int p ) {
     return get_favorite_place( p ) == NULL ?
       -1 : get_favorite_place( p )->get_id();
@@ -26,6 +26,7 @@
 #include "Global.h"
 #include "Evolution.h"
 #include "Population.h"
+#include "Checkpoint.h"
 
 Antiviral::Antiviral(int _disease, int _course_length, double _reduce_infectivity,
                      double _reduce_susceptibility, double _reduce_asymp_period,
@@ -192,3 +193,20 @@ void Antiviral::modify_symptomaticity(Health *health, int disease, int cur_day)
   }
 }
 
+void Antiviral::write_checkpoint(Checkpoint & checkpoint) const {
+  checkpoint.write(initial_stock);
+  checkpoint.write(stock);
+  checkpoint.write(total_avail);
+  checkpoint.write(reserve);
+  checkpoint.write(given_out);
+  checkpoint.write(ineff_given_out);
+}
+
+void Antiviral::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read(initial_stock);
+  checkpoint.read(stock);
+  checkpoint.read(total_avail);
+  checkpoint.read(reserve);
+  checkpoint.read(given_out);
+  checkpoint.read(ineff_given_out);
+}
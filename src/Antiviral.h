@@ -28,6 +28,7 @@ class Disease;
 class Health;
 class Policy;
 class AV_Health;
+class Checkpoint;
 
 /**
  * Antiviral is a class to hold all of the parameters to describe a
@@ -197,6 +198,13 @@ public:
    */
   void reset();
 
+  /**
+   * Write the stocks and counts to a checkpoint, or read them back (see
+   * Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint) const;
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Print out a daily report
    *
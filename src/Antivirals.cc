@@ -24,6 +24,8 @@ using namespace std;
 #include "Params.h"
 #include "Person.h"
 #include "Health.h"
+#include "Checkpoint.h"
+#include "Utils.h"
 
 Antivirals::Antivirals(){
   int nav;
@@ -139,3 +141,21 @@ void Antivirals::reset(){
     AVs[iav]->reset();
 }
 
+void Antivirals::write_checkpoint(Checkpoint & checkpoint) const {
+  checkpoint.write((int) AVs.size());
+  for (unsigned int i = 0; i < AVs.size(); i++) {
+    AVs[i]->write_checkpoint(checkpoint);
+  }
+}
+
+void Antivirals::read_checkpoint(Checkpoint & checkpoint) {
+  int number_antivirals;
+  checkpoint.read(number_antivirals);
+  if (number_antivirals != (int) AVs.size()) {
+    Utils::fred_abort("Checkpoint has %d antivirals, but the parameters have %d\n",
+        number_antivirals, (int) AVs.size());
+  }
+  for (unsigned int i = 0; i < AVs.size(); i++) {
+    AVs[i]->read_checkpoint(checkpoint);
+  }
+}
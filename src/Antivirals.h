@@ -24,6 +24,7 @@
 using namespace std;
 
 class Antiviral;
+class Checkpoint;
 
 /**
  * Antivirals is a class to contain a group of Antiviral classes
@@ -80,6 +81,13 @@ public:
    */
   void reset();
 
+  /**
+   * Write the stocks and counts to a checkpoint, or read them back (see
+   * Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint) const;
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Perform the daily update for this object
    *
@@ -19,6 +19,7 @@
 #include "Random.h"
 #include "Utils.h"
 #include "Behavior.h"
+#include "Checkpoint.h"
 
 Attitude::Attitude(int _index) {
   index = _index;
@@ -57,7 +58,7 @@ Attitude::Attitude(int _index) {
   }
 
   FRED_VERBOSE(1,
-	       "created ATTITUDE %d name %d strategy %d freq %d expir %d probability %f\n",
+	       "created ATTITUDE %d name %s strategy %d freq %d expir %d probability %f\n",
 	       index, params->name, strategy,
 	       frequency, expiration, probability);
 }
@@ -76,9 +77,28 @@ void Attitude::update(int day) {
   }
 
   FRED_VERBOSE(1,
-	       "update ATTITUDE %d willing %d  %d expir %d\n",
+	       "update ATTITUDE %d willing %d expir %d\n",
 	       index, willing?1:0, expiration);
 
 }
 
+void Attitude::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write( index );
+  checkpoint.write( strategy );
+  checkpoint.write( probability );
+  checkpoint.write( frequency );
+  checkpoint.write( expiration );
+  checkpoint.write( willing );
+}
 
+Attitude * Attitude::read_checkpoint( Checkpoint & checkpoint ) {
+  Attitude * attitude = new Attitude();
+  checkpoint.read( attitude->index );
+  checkpoint.read( attitude->strategy );
+  checkpoint.read( attitude->probability );
+  checkpoint.read( attitude->frequency );
+  checkpoint.read( attitude->expiration );
+  checkpoint.read( attitude->willing );
+  attitude->params = Behavior::get_behavior_params( attitude->index );
+  return attitude;
+}
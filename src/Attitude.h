@@ -21,6 +21,8 @@
 #include "Random.h"
 #include "Behavior.h"
 
+class Checkpoint;
+
 class Attitude {
 public:
   /**
@@ -47,7 +49,13 @@ public:
   double get_frequency () { return frequency; }
   bool is_willing() { return willing; }
 
+  // see Checkpoint
+  void write_checkpoint( Checkpoint & checkpoint );
+  static Attitude * read_checkpoint( Checkpoint & checkpoint );
+
  private:
+  Attitude() { }
+
   int index;
   int strategy;
   double probability;
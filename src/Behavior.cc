@@ -23,6 +23,8 @@
 #include "Place_List.h"
 #include "Utils.h"
 #include "Household.h"
+#include "Population.h"
+#include "Checkpoint.h"
 
 //Private static variable to assure we only lookup parameters once
 bool Behavior::parameters_are_set = false;
@@ -79,6 +81,7 @@ void Behavior::setup( Person * self ) {
                  self->get_id(), self->get_age());
     health_decision_maker = NULL;
     setup_attitudes();
+    update_decision_maker_mask( self );
     return;
   }
 
@@ -94,6 +97,7 @@ void Behavior::setup( Person * self ) {
     // no separate health decision maker
     health_decision_maker = NULL;
     setup_attitudes();
+    update_decision_maker_mask( self );
     return;
   }
 
@@ -103,6 +107,7 @@ void Behavior::setup( Person * self ) {
                  self->get_id(), self->get_age(), person->get_id(), person->get_age());
     health_decision_maker = person;
     person->become_health_decision_maker();
+    update_decision_maker_mask( self );
     return;
   }
 
@@ -110,9 +115,62 @@ void Behavior::setup( Person * self ) {
   FRED_VERBOSE(1,"behavior_setup for child %d age %d -- adult person %d age %d will make health decisions\n",
                self->get_id(), self->get_age(), person->get_id(), person->get_age());
   health_decision_maker = person; // no need to setup atitudes for adults
+  update_decision_maker_mask( self );
   return;
 }
 
+void Behavior::set_health_decision_maker( Person * self, Person * p ) {
+  health_decision_maker = p; 
+  if (p != NULL) delete_attitudes();
+  update_decision_maker_mask( self );
+}
+
+void Behavior::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write_person( health_decision_maker );
+  checkpoint.write( (char) ( attitude != NULL ) );
+  if ( attitude != NULL ) {
+    for ( int i = 0; i < NUM_BEHAVIORS; i++ ) {
+      checkpoint.write( (char) ( attitude[i] != NULL ) );
+      if ( attitude[i] != NULL ) {
+        attitude[i]->write_checkpoint( checkpoint );
+      }
+    }
+  }
+}
+
+void Behavior::read_checkpoint( Checkpoint & checkpoint ) {
+  health_decision_maker = checkpoint.read_person();
+  attitude = NULL;
+  char has;
+  checkpoint.read( has );
+  if ( has ) {
+    attitude = new Attitude * [ NUM_BEHAVIORS ];
+    for ( int i = 0; i < NUM_BEHAVIORS; i++ ) {
+      checkpoint.read( has );
+      attitude[i] = has ? Attitude::read_checkpoint( checkpoint ) : NULL;
+    }
+  }
+}
+
+void Behavior::become_health_decision_maker( Person * self ) {
+  if (health_decision_maker != NULL) {
+    health_decision_maker = NULL;
+    delete_attitudes();
+    setup_attitudes();
+    update_decision_maker_mask( self );
+  }
+}
+
+// the daily update of attitudes is run over fred::Decision_Maker
+void Behavior::update_decision_maker_mask( Person * self ) {
+  if ( health_decision_maker == NULL && attitude != NULL ) {
+    Global::Pop.set_mask_by_index( fred::Decision_Maker, self->get_pop_index() );
+  }
+  else {
+    Global::Pop.clear_mask_by_index( fred::Decision_Maker, self->get_pop_index() );
+  }
+}
+
 void Behavior::setup_attitudes() {
   if (Global::Enable_Behaviors == 0) return;
 
@@ -23,6 +23,7 @@
 class Attitude;
 class Person;
 class Household;
+class Checkpoint;
 
 // the following enum defines symbolic names for
 // current behaviors.  The last element should always be
@@ -120,20 +121,14 @@ public:
   Person * get_health_decision_maker() { return health_decision_maker; }
   bool is_health_decision_maker() { return health_decision_maker == NULL; }
 
-  void set_health_decision_maker(Person * p) {
-    health_decision_maker = p; 
-    if (p != NULL) delete_attitudes();
-  }
-
-  void become_health_decision_maker() {
-    if (health_decision_maker != NULL) {
-      health_decision_maker = NULL;
-      delete_attitudes();
-      setup_attitudes();
-    }
-  }
+  void set_health_decision_maker( Person * self, Person * p );
+  void become_health_decision_maker( Person * self );
 
   static Behavior_params * get_behavior_params(int i) { return behavior_params[i]; }
+
+  // see Checkpoint
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
   static void print_params(int n);
 
 private:
@@ -151,6 +146,7 @@ private:
   static void get_parameters_for_behavior(char * behavior_name, int n);
   Person * select_adult(Household *h, int relationship, Person * self);
   void delete_attitudes();
+  void update_decision_maker_mask( Person * self );
 
 protected:
   friend class Person;
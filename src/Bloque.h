@@ -42,6 +42,8 @@
 #include <stdint.h>
 #include <assert.h>
 
+#include "Work_Stealing_Scheduler.h"
+
 /*
  * use SSE2 (8 128 XMM registers)
  */
@@ -54,9 +56,17 @@
 #define registersPerBlock 256
 // bitsPerBlock = registersPerBlock * registerWidth
 #define bitsPerBlock 16384 
+// registers per task in scheduled sweeps (1024 items)
+#define registersPerTask 16
 
 typedef uint64_t BitType;
 
+/*
+ * index of the lowest set bit, and number of set bits, of a (non-zero) register
+ */
+#define lowestSetBit( reg ) __builtin_ctzll( reg )
+#define countSetBits( reg ) __builtin_popcountll( reg )
+
 template < typename ObjectType, typename MaskType, typename LinkObjectType = int, typename LinkMaskType = char >
 class bloque {
 
@@ -85,7 +95,6 @@ private:
   typedef typename MaskMap::iterator MaskMapItr;
 
   MaskMap userMasks;
-  std::map< MaskType, int > user_mask_num_items;
 
   /*
    * itemPosition: class to simplify conversions to/from (block,slot) coordinates
@@ -180,7 +189,6 @@ public:
   void add_mask( MaskType maskName ) {
     #pragma omp critical(BLOQUE_ADD_MASK)   
     if ( userMasks.find( maskName ) == userMasks.end() ) {
-      user_mask_num_items[ maskName ] = 0;
       for ( size_t i = 0; i < blockVector.size(); ++i ) { 
         userMasks[ maskName ].push_back( new BitType[ registersPerBlock ] );
         for ( size_t j = 0; j < registersPerBlock; ++j ) {
@@ -238,8 +246,27 @@ public:
     return numItems;
   }
 
-  size_t size( MaskType mask ) {
-    return user_mask_num_items[ mask ];
+  /*
+   * One past the largest index that has been allocated; arrays indexed by
+   * item index need this many entries
+   */
+  size_t get_end_index() {
+    return endIndex;
+  }
+
+  /*
+   * Number of valid items with the given mask set; counted from the bitsets
+   */
+  size_t mask_count( MaskType m ) {
+    mask & userMask = userMasks[ m ];
+    size_t count = 0;
+    for ( size_t i = 0; i < blockVector.size(); ++i ) {
+      for ( size_t j = 0; j < registersPerBlock; ++j ) {
+        BitType reg = ( defaultMask[ i ][ j ] ) & ( userMask[ i ][ j ] );
+        count += countSetBits( reg );
+      }
+    }
+    return count;
   }
 
   void mark_valid_by_index( size_t index ) {
@@ -279,9 +306,6 @@ public:
       if ( ( (*mit).second[ pos.block ][ pos.slot / registerWidth ] ) & ( (BitType) 1 << ( pos.slot % registerWidth ) ) ) {
         // unset the bit for this index in this mask
         clearBit( (*mit).second[ pos.block ][ pos.slot / registerWidth ], ( pos.slot % registerWidth ) );
-        // decrement the count for this mask; must be protected from concurrent writes
-        #pragma omp atomic
-        --( user_mask_num_items[ (*mit).first ] );
       }
     }
   }
@@ -293,9 +317,6 @@ public:
     itemPosition pos = itemPosition( index );
     // set the bit for this index in this mask
     setBit( userMasks[ mask ][ pos.block ][ pos.slot / registerWidth ], pos.slot % registerWidth );
-    // increment the count for this mask; must be protected from concurrent writes
-    #pragma omp atomic
-    ++( user_mask_num_items[ mask ] );
   }
 
   /*
@@ -305,9 +326,6 @@ public:
     itemPosition pos = itemPosition( index );
     // unset the bit for this index in this mask
     clearBit( userMasks[ mask ][ pos.block ][ pos.slot / registerWidth ], pos.slot % registerWidth );
-    // decrement the count for this mask; must be protected from concurrent writes
-    #pragma omp atomic
-    --( user_mask_num_items[ mask ] );
   }
  
   void clear_mask( MaskType m ) {
@@ -319,7 +337,6 @@ public:
           userMask[ i ][ j ] = (BitType) 0;
         }
       }
-      user_mask_num_items[ m ] = 0;
     }
   }
 
@@ -353,12 +370,11 @@ public:
     #pragma omp parallel for if(enable_parallelism)
     for ( int i = 0; i < blockVector.size(); ++i ) {
       for ( int j = 0; j < registersPerBlock; ++j ) {
-        if ( ( defaultMask[ i ][ j ] ) > ( (BitType) 0 ) ) {
-          for ( int k = 0; k < registerWidth; ++k ) {
-            if ( ( defaultMask[ i ][ j ] ) & ( (BitType) 1 << ( k ) ) ) {
-              f( blockVector[ i ][ ( j * registerWidth ) + k ] );
-            }
-          }
+        BitType reg = defaultMask[ i ][ j ];
+        ObjectType * items = &( blockVector[ i ][ j * registerWidth ] );
+        while ( reg ) {
+          f( items[ lowestSetBit( reg ) ] );
+          reg &= reg - 1;
         }
       }
     }
@@ -372,19 +388,72 @@ public:
     mask & userMask = userMasks[ m ]; 
     #pragma omp parallel for if(enable_parallelism)
     for ( int i = 0; i < blockVector.size(); ++i ) {
+      BitType regs[ registersPerBlock ];
+      and_block( regs, defaultMask[ i ], userMask[ i ] );
       for ( int j = 0; j < registersPerBlock; ++j ) {
-        BitType reg = ( defaultMask[ i ][ j ] ) & ( userMask[ i ][ j ] );  
-        if ( reg > ( (BitType) 0 ) ) {
-          for ( int k = 0; k < registerWidth; ++k ) {
-            if ( ( reg ) & ( (BitType) 1 << ( k ) ) ) {
-              f( blockVector[ i ][ ( j * registerWidth ) + k ] );
-            }
-          }
+        BitType reg = regs[ j ];
+        ObjectType * items = &( blockVector[ i ][ j * registerWidth ] );
+        while ( reg ) {
+          f( items[ lowestSetBit( reg ) ] );
+          reg &= reg - 1;
+        }
+      }
+    }
+  }
+
+  /*
+   * Generic, parallel 'masked apply' over a linked child bloque: the functor is
+   * applied to the child's item (and its index) wherever this bloque's item is
+   * valid and has the given mask set.  Useful for sweeping compact per-item
+   * state kept in the child without touching the items of this bloque.
+   */
+  template < typename Functor > 
+  void linked_masked_apply( int link, MaskType m, Functor & f, bool enable_parallelism ) {
+    assert( is_linked && is_parent && link < links.size() );
+    bloque< LinkObjectType, LinkMaskType, ObjectType, MaskType > & child = *( links[ link ] );
+    mask & userMask = userMasks[ m ]; 
+    #pragma omp parallel for if(enable_parallelism)
+    for ( int i = 0; i < blockVector.size(); ++i ) {
+      BitType regs[ registersPerBlock ];
+      and_block( regs, defaultMask[ i ], userMask[ i ] );
+      for ( int j = 0; j < registersPerBlock; ++j ) {
+        BitType reg = regs[ j ];
+        while ( reg ) {
+          size_t slot = ( j * registerWidth ) + lowestSetBit( reg );
+          f( child.blockVector[ i ][ slot ], ( i * bitsPerBlock ) + slot );
+          reg &= reg - 1;
         }
       }
     }
   }
 
+  template < typename Functor >
+  void parallel_linked_masked_apply( int link, MaskType m, Functor & f ) {
+    linked_masked_apply( link, m, f, true );
+  }
+
+  /*
+   * Parallel 'masked apply' balanced by a work-stealing scheduler: each block is
+   * divided into tasks of registersPerTask registers, costed by the number of
+   * items they hold with the mask set; empty tasks are skipped.
+   */
+  template < typename Functor >
+  void scheduled_masked_apply( MaskType m, Functor & f, Work_Stealing_Scheduler & scheduler ) {
+    Masked_Task< Functor > task( *this, userMasks[ m ], f );
+    schedule_masked_tasks( userMasks[ m ], task, scheduler );
+  }
+
+  /*
+   * As scheduled_masked_apply, over a linked child bloque (see linked_masked_apply)
+   */
+  template < typename Functor >
+  void scheduled_linked_masked_apply( int link, MaskType m, Functor & f,
+      Work_Stealing_Scheduler & scheduler ) {
+    assert( is_linked && is_parent && link < links.size() );
+    Linked_Masked_Task< Functor > task( *this, *( links[ link ] ), userMasks[ m ], f );
+    schedule_masked_tasks( userMasks[ m ], task, scheduler );
+  }
+
   /*
    * Generic, parallel 'not masked apply' method for all items in container
    *
@@ -398,12 +467,10 @@ public:
     for ( int i = 0; i < blockVector.size(); ++i ) {
       for ( int j = 0; j < registersPerBlock; ++j ) {
         BitType reg = ( defaultMask[ i ][ j ] ) & ( ~( userMask[ i ][ j ] ) );  
-        if ( reg > ( (BitType) 0 ) ) {
-          for ( int k = 0; k < registerWidth; ++k ) {
-            if ( ( reg ) & ( (BitType) 1 << ( k ) ) ) {
-              f( blockVector[ i ][ ( j * registerWidth ) + k ] );
-            }
-          }
+        ObjectType * items = &( blockVector[ i ][ j * registerWidth ] );
+        while ( reg ) {
+          f( items[ lowestSetBit( reg ) ] );
+          reg &= reg - 1;
         }
       }
     }
@@ -466,6 +533,65 @@ public:
     size_t slot = itemIndex % bitsPerBlock;
     return is_valid_item( block, slot );
   }
+
+  /*
+   * The allocation state of the container: its blocks, masks and free slots
+   * (in the order they will be handed out), but not the items themselves.
+   * set_layout makes a container that has at most as many blocks the same as
+   * the one get_layout was called on; the items in any new blocks are
+   * default-constructed, and linked containers grow with this one.
+   */
+  struct Layout {
+    size_t number_of_blocks;
+    std::vector< BitType > default_mask;
+    std::map< MaskType, std::vector< BitType > > user_masks;
+    std::vector< size_t > free_slots;
+    size_t first_item_index, last_item_index;
+  };
+
+  void get_layout( Layout & layout ) {
+    layout.number_of_blocks = blockVector.size();
+    copy_mask( defaultMask, layout.default_mask );
+    layout.user_masks.clear();
+    for ( MaskMapItr mit = userMasks.begin(); mit != userMasks.end(); ++mit ) {
+      copy_mask( (*mit).second, layout.user_masks[ (*mit).first ] );
+    }
+    layout.free_slots.clear();
+    for ( size_t i = 0; i < freeSlots.size(); ++i ) {
+      layout.free_slots.push_back( freeSlots[ i ].asIndex() );
+    }
+    layout.first_item_index = firstItemPosition.asIndex();
+    layout.last_item_index = lastItemPosition.asIndex();
+  }
+
+  void set_layout( const Layout & layout ) {
+    assert( is_child == false );
+    assert( layout.number_of_blocks >= blockVector.size() );
+    while ( blockVector.size() < layout.number_of_blocks ) {
+      addBlock();
+      for ( int i = 0; i < links.size(); ++i ) {
+        links[ i ]->addBlock();
+      }
+    }
+    numItems = 0;
+    set_mask( defaultMask, layout.default_mask );
+    for ( size_t i = 0; i < layout.default_mask.size(); ++i ) {
+      numItems += countSetBits( layout.default_mask[ i ] );
+    }
+    for ( MaskMapItr mit = userMasks.begin(); mit != userMasks.end(); ++mit ) {
+      typename std::map< MaskType, std::vector< BitType > >::const_iterator saved =
+        layout.user_masks.find( (*mit).first );
+      assert( saved != layout.user_masks.end() );
+      set_mask( (*mit).second, saved->second );
+    }
+    freeSlots.clear();
+    for ( size_t i = 0; i < layout.free_slots.size(); ++i ) {
+      freeSlots.push_back( itemPosition( layout.free_slots[ i ] ) );
+    }
+    firstItemPosition = itemPosition( layout.first_item_index );
+    lastItemPosition = itemPosition( layout.last_item_index );
+  }
+
 /* ****************************************************************
  * private methods ************************************************
  * ****************************************************************
@@ -508,9 +634,93 @@ private:
     endIndex += blockSize;
   }
 
+  /*
+   * AND two masks over a whole block; a simple loop over registers that the
+   * compiler vectorizes
+   */
+  void and_block( BitType * result, const BitType * a, const BitType * b ) {
+    for ( size_t j = 0; j < registersPerBlock; ++j ) {
+      result[ j ] = a[ j ] & b[ j ];
+    }
+  }
+
+  /*
+   * add a task to the scheduler for each range of registersPerTask registers
+   * that has items with the mask set, then run them
+   */
+  template < typename Task_Functor >
+  void schedule_masked_tasks( mask & userMask, Task_Functor & task,
+      Work_Stealing_Scheduler & scheduler ) {
+    scheduler.clear();
+    for ( int i = 0; i < blockVector.size(); ++i ) {
+      for ( int first = 0; first < registersPerBlock; first += registersPerTask ) {
+        int count = 0;
+        for ( int j = first; j < first + registersPerTask; ++j ) {
+          count += countSetBits( defaultMask[ i ][ j ] & userMask[ i ][ j ] );
+        }
+        if ( count > 0 ) {
+          scheduler.add_task( i, first, first + registersPerTask, count );
+        }
+      }
+    }
+    scheduler.run( task );
+  }
+
+  template < typename Functor >
+  struct Masked_Task {
+    bloque & blq;
+    mask & userMask;
+    Functor & f;
+    Masked_Task( bloque & b, mask & m, Functor & _f ) : blq( b ), userMask( m ), f( _f ) { }
+    void operator() ( const Work_Stealing_Scheduler::Task & task ) {
+      for ( int j = task.first; j < task.last; ++j ) {
+        BitType reg = blq.defaultMask[ task.index ][ j ] & userMask[ task.index ][ j ];
+        ObjectType * items = &( blq.blockVector[ task.index ][ j * registerWidth ] );
+        while ( reg ) {
+          f( items[ lowestSetBit( reg ) ] );
+          reg &= reg - 1;
+        }
+      }
+    }
+  };
+
+  template < typename Functor >
+  struct Linked_Masked_Task {
+    bloque & blq;
+    bloque< LinkObjectType, LinkMaskType, ObjectType, MaskType > & child;
+    mask & userMask;
+    Functor & f;
+    Linked_Masked_Task( bloque & b, bloque< LinkObjectType, LinkMaskType, ObjectType, MaskType > & c,
+        mask & m, Functor & _f ) : blq( b ), child( c ), userMask( m ), f( _f ) { }
+    void operator() ( const Work_Stealing_Scheduler::Task & task ) {
+      for ( int j = task.first; j < task.last; ++j ) {
+        BitType reg = blq.defaultMask[ task.index ][ j ] & userMask[ task.index ][ j ];
+        while ( reg ) {
+          size_t slot = ( j * registerWidth ) + lowestSetBit( reg );
+          f( child.blockVector[ task.index ][ slot ], ( task.index * bitsPerBlock ) + slot );
+          reg &= reg - 1;
+        }
+      }
+    }
+  };
+
   void addSlot( size_t slot_index ) {
     freeSlots.push_back( itemPosition( slot_index ) );        
   }
+
+  void copy_mask( const mask & m, std::vector< BitType > & registers ) {
+    registers.resize( m.size() * registersPerBlock );
+    for ( size_t i = 0; i < m.size(); ++i ) {
+      std::copy( m[ i ], m[ i ] + registersPerBlock, &( registers[ i * registersPerBlock ] ) );
+    }
+  }
+
+  void set_mask( mask & m, const std::vector< BitType > & registers ) {
+    assert( registers.size() == m.size() * registersPerBlock );
+    for ( size_t i = 0; i < m.size(); ++i ) {
+      std::copy( &( registers[ i * registersPerBlock ] ), &( registers[ i * registersPerBlock ] ) + registersPerBlock, m[ i ] );
+    }
+  }
   
   void setBit( BitType & registerSet, size_t bit ) {
     #pragma omp atomic
@@ -57,6 +57,7 @@ void Cell::make_neighborhood( Place::Allocator< Neighborhood > & neighborhood_al
 
   neighborhood = new ( neighborhood_allocator.get_free() )
     Neighborhood( str, lon, lat, 0, &Global::Pop );
+  neighborhood->set_grid_cell(this);
 }
 
 void Cell::add_household(Place *p) {
@@ -123,7 +124,7 @@ Place * Cell::select_neighborhood(double community_prob,
 
   // select a random cell with community_prob
   if (r < community_prob) {
-    grid_cell = grid->select_random_grid_cell(center_x, center_y, community_distance);
+    grid_cell = grid->select_random_grid_cell(row, col, community_distance);
   }
   else if (r < community_prob + local_prob) {
     // select local grid_cell with local_prob
@@ -143,7 +144,7 @@ Place * Cell::select_new_neighborhood( double community_prob,
   // this method only called if r > local_prob, so the following
   // selects a random cell with community_prob
   if (r < community_prob + local_prob) {
-    grid_cell = grid->select_random_grid_cell(center_x, center_y, community_distance);
+    grid_cell = grid->select_random_grid_cell(row, col, community_distance);
   }
   // select randomly from among immediate neighbors
   else {
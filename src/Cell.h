@@ -113,7 +113,8 @@ public:
   /**
    * @return list of households in this grid cell.
    */
-  vector <Place *> get_households() { return household; }
+  const vector <Place *> & get_households() { return household; }
+  Place * get_household(int i) { return household[i]; }
 
   /**
    * @return a pointer to this Cell's Neighborhood
@@ -0,0 +1,106 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Census_Block_Tracker.cc
+//
+
+#include <algorithm>
+
+#include "Census_Block_Tracker.h"
+#include "Checkpoint.h"
+#include "Utils.h"
+
+const char * Census_Block_Tracker::COLUMN_NAMES[ NUMBER_OF_COLUMNS ] = {
+  "Av", "C", "Cs", "Day", "E", "I", "Is", "M", "N", "R", "S", "V"
+};
+
+Census_Block_Tracker::Census_Block_Tracker( std::string _index_name ) :
+  thread_counts( NCPU ) {
+  index_name = _index_name;
+}
+
+int Census_Block_Tracker::add_block( const std::string & block ) {
+  std::map< std::string, int >::iterator itr = block_index.find( block );
+  if ( itr != block_index.end() ) {
+    return itr->second;
+  }
+  int index = block_names.size();
+  block_index[ block ] = index;
+  block_names.push_back( block );
+  totals.resize( block_names.size() * NUMBER_OF_COLUMNS, 0 );
+  for ( int t = 0; t < thread_counts.size(); ++t ) {
+    thread_counts( t ).resize( totals.size(), 0 );
+  }
+  return index;
+}
+
+int Census_Block_Tracker::get_block_index( const std::string & block ) {
+  std::map< std::string, int >::iterator itr = block_index.find( block );
+  return itr == block_index.end() ? -1 : itr->second;
+}
+
+void Census_Block_Tracker::reduce() {
+  int size = totals.size();
+  for ( int t = 0; t < thread_counts.size(); ++t ) {
+    std::vector< int > & counts = thread_counts( t );
+    for ( int i = 0; i < size; ++i ) {
+      totals[ i ] += counts[ i ];
+      counts[ i ] = 0;
+    }
+  }
+}
+
+void Census_Block_Tracker::set_column( Column column, int value ) {
+  for ( int i = column; i < totals.size(); i += NUMBER_OF_COLUMNS ) {
+    totals[ i ] = value;
+  }
+}
+
+void Census_Block_Tracker::output_csv_report_format( FILE * fp, bool print_header ) {
+  if ( print_header ) {
+    fprintf( fp, "%s", index_name.c_str() );
+    for ( int c = 0; c < NUMBER_OF_COLUMNS; ++c ) {
+      fprintf( fp, ",%s", COLUMN_NAMES[ c ] );
+    }
+    fprintf( fp, "\n" );
+  }
+  // the map gives the blocks in sorted order
+  std::map< std::string, int >::iterator itr = block_index.begin();
+  for ( ; itr != block_index.end(); ++itr ) {
+    const int * row = &( totals[ itr->second * NUMBER_OF_COLUMNS ] );
+    fprintf( fp, "%s", itr->first.c_str() );
+    for ( int c = 0; c < NUMBER_OF_COLUMNS; ++c ) {
+      fprintf( fp, ",%d", row[ c ] );
+    }
+    fprintf( fp, "\n" );
+  }
+}
+
+void Census_Block_Tracker::write_checkpoint( Checkpoint & checkpoint ) {
+  reduce();
+  checkpoint.write_tag( "census blocks" );
+  checkpoint.write_vector( totals );
+}
+
+void Census_Block_Tracker::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "census blocks" );
+  std::vector< int > saved;
+  checkpoint.read_vector( saved );
+  if ( saved.size() != totals.size() ) {
+    Utils::fred_abort( "Checkpoint has counts for %d census blocks, but the population has %d\n",
+        (int) ( saved.size() / NUMBER_OF_COLUMNS ), get_number_of_blocks() );
+  }
+  totals.swap( saved );
+  for ( int t = 0; t < thread_counts.size(); ++t ) {
+    std::fill( thread_counts( t ).begin(), thread_counts( t ).end(), 0 );
+  }
+}
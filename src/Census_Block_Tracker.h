@@ -0,0 +1,93 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Census_Block_Tracker.h
+//
+
+#ifndef _FRED_CENSUS_BLOCK_TRACKER_H
+#define _FRED_CENSUS_BLOCK_TRACKER_H
+
+/*
+ * Daily disease state counts by census block group, written to
+ * blockseday<run>.txt when report_epidemic_data_by_census_block is set.
+ *
+ * Block ids are interned to dense indices when the tracker is set up (each
+ * household keeps its block's index) and the columns are a fixed enum, so a
+ * state transition is a single add into a flat array.  Each thread adds into
+ * its own array; reduce() folds them into the totals once per day, before
+ * the totals are changed or written.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#include "Global.h"
+#include "State.h"
+
+class Checkpoint;
+
+class Census_Block_Tracker {
+
+public:
+
+  // in the order in which they are written
+  enum Column { AV, C, CS, DAY, E, I, IS, M, N, R, S, V, NUMBER_OF_COLUMNS };
+
+  Census_Block_Tracker( std::string index_name );
+
+  /**
+   * Add a block during setup (not thread-safe).  Blocks are written in
+   * sorted order.
+   * @return the block's index
+   */
+  int add_block( const std::string & block );
+
+  /// @return the block's index, or -1
+  int get_block_index( const std::string & block );
+
+  int get_number_of_blocks() { return block_names.size(); }
+
+  void increment( int block, Column column, int value ) {
+    thread_counts()[ block * NUMBER_OF_COLUMNS + column ] += value;
+  }
+
+  /// add every thread's increments to the totals
+  void reduce();
+
+  // the following use the totals only; call reduce() first
+
+  int get_count( int block, Column column ) {
+    return totals[ block * NUMBER_OF_COLUMNS + column ];
+  }
+
+  void set_column( Column column, int value );
+
+  void output_csv_report_format( FILE * fp, bool print_header );
+
+  /// writes the counts (after reducing them) to a checkpoint, or reads them back
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
+
+private:
+
+  static const char * COLUMN_NAMES[ NUMBER_OF_COLUMNS ];
+
+  std::string index_name;
+  std::map< std::string, int > block_index;
+  std::vector< std::string > block_names;
+  std::vector< int > totals;
+  State< std::vector< int > > thread_counts;
+};
+
+#endif // _FRED_CENSUS_BLOCK_TRACKER_H
@@ -0,0 +1,403 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Checkpoint.cc
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Checkpoint.h"
+#include "Params.h"
+#include "Utils.h"
+#include "Date.h"
+#include "Random.h"
+#include "Population.h"
+#include "Person.h"
+#include "Place.h"
+#include "Place_List.h"
+#include "Grid.h"
+#include "Large_Grid.h"
+#include "Travel.h"
+#include "Activities.h"
+#include "Disease.h"
+#include "Epidemic.h"
+#include "Census_Block_Tracker.h"
+
+using namespace std;
+
+const char Checkpoint::MAGIC[ 8 ] = { 'F', 'R', 'E', 'D', 'C', 'K', 'P', '\0' };
+
+char Checkpoint::checkpoint_date_match[ FRED_STRING_SIZE ];
+char Checkpoint::restart_file[ FRED_STRING_SIZE ] = "none";
+int Checkpoint::restart_reseed = 0;
+
+void Checkpoint::write_bytes( const void * bytes, size_t n ) {
+  const char * b = (const char *) bytes;
+  data.insert( data.end(), b, b + n );
+}
+
+void Checkpoint::read_bytes( void * bytes, size_t n ) {
+  if ( position + n > data.size() ) {
+    Utils::fred_abort( "Checkpoint is truncated\n" );
+  }
+  if ( n > 0 ) {
+    memcpy( bytes, &( data[ position ] ), n );
+  }
+  position += n;
+}
+
+size_t Checkpoint::read_size() {
+  uint64_t n;
+  read( n );
+  return n;
+}
+
+void Checkpoint::write_string( const string & s ) {
+  write_size( s.size() );
+  write_bytes( s.data(), s.size() );
+}
+
+void Checkpoint::read_string( string & s ) {
+  size_t n = read_size();
+  if ( position + n > data.size() ) {
+    Utils::fred_abort( "Checkpoint is truncated\n" );
+  }
+  s.assign( n > 0 ? &( data[ position ] ) : "", n );
+  position += n;
+}
+
+void Checkpoint::write_person( Person * person ) {
+  write( (int32_t) ( person == NULL ? -1 : person->get_pop_index() ) );
+}
+
+Person * Checkpoint::read_person() {
+  int32_t index;
+  read( index );
+  if ( index < 0 ) {
+    return NULL;
+  }
+  if ( index >= Global::Pop.get_index_limit() ) {
+    Utils::fred_abort( "Checkpoint has a person with index %d outside the population\n", index );
+  }
+  // may be the slot of someone who has died since, as in the run that wrote it
+  return Global::Pop.get_person_slot( index );
+}
+
+void Checkpoint::write_place( Place * place ) {
+  write( (int32_t) ( place == NULL ? -1 : place->get_id() ) );
+}
+
+Place * Checkpoint::read_place() {
+  int32_t id;
+  read( id );
+  if ( id < 0 ) {
+    return NULL;
+  }
+  if ( id >= Global::Places.get_number_of_places()
+      || Global::Places.get_place_at_position( id )->get_id() != id ) {
+    Utils::fred_abort( "Checkpoint has a place with id %d that is not in the population\n", id );
+  }
+  return Global::Places.get_place_at_position( id );
+}
+
+void Checkpoint::write_tag( const char * tag ) {
+  write_string( tag );
+}
+
+void Checkpoint::read_tag( const char * tag ) {
+  string s;
+  read_string( s );
+  if ( s != tag ) {
+    Utils::fred_abort( "Checkpoint is corrupt or from another version of FRED: expected %s, found %s\n",
+        tag, s.c_str() );
+  }
+}
+
+void Checkpoint::save( const char * filename ) {
+  // written under a temporary name and renamed, so that an interrupted run
+  // never leaves a partial checkpoint
+  char temporary[ FRED_STRING_SIZE + 32 ];
+  snprintf( temporary, sizeof( temporary ), "%s.%d.tmp", filename, (int) getpid() );
+  FILE * fp = fopen( temporary, "wb" );
+  if ( fp == NULL ) {
+    Utils::fred_abort( "Can't open %s\n", temporary );
+  }
+  uint32_t byte_order = BYTE_ORDER_MARK;
+  uint32_t version = VERSION;
+  uint64_t n = data.size();
+  bool ok = fwrite( MAGIC, sizeof( MAGIC ), 1, fp ) == 1
+    && fwrite( &byte_order, sizeof( byte_order ), 1, fp ) == 1
+    && fwrite( &version, sizeof( version ), 1, fp ) == 1
+    && fwrite( &n, sizeof( n ), 1, fp ) == 1
+    && ( n == 0 || fwrite( &( data[ 0 ] ), n, 1, fp ) == 1 );
+  if ( fclose( fp ) != 0 || !ok || rename( temporary, filename ) != 0 ) {
+    Utils::fred_abort( "Error writing checkpoint %s\n", filename );
+  }
+}
+
+void Checkpoint::load( const char * filename ) {
+  FILE * fp = fopen( filename, "rb" );
+  if ( fp == NULL ) {
+    Utils::fred_abort( "Can't open checkpoint %s\n", filename );
+  }
+  char magic[ 8 ];
+  uint32_t byte_order, version;
+  uint64_t n;
+  if ( fread( magic, sizeof( magic ), 1, fp ) != 1 || memcmp( magic, MAGIC, sizeof( MAGIC ) ) != 0
+      || fread( &byte_order, sizeof( byte_order ), 1, fp ) != 1
+      || fread( &version, sizeof( version ), 1, fp ) != 1
+      || fread( &n, sizeof( n ), 1, fp ) != 1 ) {
+    Utils::fred_abort( "%s is not a FRED checkpoint\n", filename );
+  }
+  if ( byte_order != BYTE_ORDER_MARK || version != VERSION ) {
+    Utils::fred_abort( "%s was written by another version of FRED, or on another platform\n", filename );
+  }
+  data.resize( n );
+  position = 0;
+  if ( n > 0 && fread( &( data[ 0 ] ), n, 1, fp ) != 1 ) {
+    Utils::fred_abort( "Checkpoint %s is truncated\n", filename );
+  }
+  fclose( fp );
+}
+
+void Checkpoint::get_parameters() {
+  Params::get_param_from_string( "checkpoint_date_match", checkpoint_date_match );
+  Params::get_param_from_string( "restart_file", restart_file );
+  Params::get_param_from_string( "restart_reseed", &restart_reseed );
+
+  if ( strcmp( checkpoint_date_match, "none" ) == 0 && !is_restart() ) {
+    return;
+  }
+  // the state of strain evolution and of the climate is not checkpointed
+  if ( Global::Enable_Seasonality ) {
+    Utils::fred_abort( "Checkpoints are not supported with enable_seasonality\n" );
+  }
+  for ( int d = 0; d < Global::Diseases; ++d ) {
+    int evolution_type = 0;
+    Params::get_indexed_param( "evolution", d, &evolution_type );
+    if ( evolution_type != 0 ) {
+      Utils::fred_abort( "Checkpoints are not supported with evolution[%d] = %d\n", d, evolution_type );
+    }
+  }
+}
+
+bool Checkpoint::is_checkpoint_date() {
+  return strcmp( checkpoint_date_match, "none" ) != 0
+    && Date::match_pattern( Global::Sim_Current_Date, checkpoint_date_match );
+}
+
+static void write_date( Checkpoint & checkpoint, Date * date ) {
+  checkpoint.write( date->get_year() );
+  checkpoint.write( date->get_month() );
+  checkpoint.write( date->get_day_of_month() );
+}
+
+static void read_date( Checkpoint & checkpoint, Date * date ) {
+  int year, month, day_of_month;
+  checkpoint.read( year );
+  checkpoint.read( month );
+  checkpoint.read( day_of_month );
+  *date = Date( year, month, day_of_month );
+}
+
+// the states of all threads' generators and of the serial counter stream;
+// kept here so that Random.o doesn't depend on the rest of FRED
+static void write_random( Checkpoint & checkpoint ) {
+  checkpoint.write_tag( "random" );
+  checkpoint.write( RNG::counter_streams );
+  checkpoint.write( RNG::counter_seed );
+  checkpoint.write( RNG::serial_stream );
+  checkpoint.write( (int) Global::MAX_NUM_THREADS );
+  for ( int i = 0; i < Global::MAX_NUM_THREADS; ++i ) {
+    checkpoint.write( rng_state[ i ] );
+  }
+}
+
+static void read_random( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "random" );
+  bool saved_counter_streams;
+  checkpoint.read( saved_counter_streams );
+  if ( saved_counter_streams != RNG::counter_streams ) {
+    Utils::fred_abort( "Checkpoint was taken with enable_counter_rng = %d\n", (int) saved_counter_streams );
+  }
+  checkpoint.read( RNG::counter_seed );
+  checkpoint.read( RNG::serial_stream );
+  int threads;
+  checkpoint.read( threads );
+  // counter streams don't depend on the threads' generators, so a run that
+  // uses them can go on with another number of threads
+  if ( threads != Global::MAX_NUM_THREADS && !RNG::counter_streams ) {
+    Utils::fred_abort( "Checkpoint was taken by FRED built with NCPU=%d\n", threads );
+  }
+  for ( int i = 0; i < threads; ++i ) {
+    Thread_RNG_State state;
+    checkpoint.read( state );
+    if ( i < Global::MAX_NUM_THREADS ) {
+      rng_state[ i ] = state;
+    }
+  }
+}
+
+void Checkpoint::write_state( Checkpoint & checkpoint, int day ) {
+  checkpoint.write_tag( "simulation" );
+  checkpoint.write_string( Global::Places.get_population_fingerprint( Global::Pop.get_demes() ) );
+  checkpoint.write( Global::Places.get_number_of_places() );
+  checkpoint.write( Global::Diseases );
+  checkpoint.write( day );
+  write_date( checkpoint, Global::Sim_Start_Date );
+  write_date( checkpoint, Global::Sim_Current_Date );
+
+  write_random( checkpoint );
+  Global::Pop.write_checkpoint( checkpoint );
+  Global::Places.write_checkpoint( checkpoint );
+  Global::Cells->write_checkpoint( checkpoint );
+  if ( Global::Enable_Travel ) {
+    Global::Large_Cells->write_checkpoint( checkpoint );
+    Travel::write_checkpoint( checkpoint );
+  }
+  Activities::write_static_checkpoint( checkpoint );
+  for ( int d = 0; d < Global::Diseases; ++d ) {
+    Global::Pop.get_disease( d )->get_epidemic()->write_checkpoint( checkpoint );
+  }
+  if ( Global::Report_Epidemic_Data_By_Census_Block ) {
+    Global::Block_Epi_Day_Tracker->write_checkpoint( checkpoint );
+  }
+  checkpoint.write_tag( "end of simulation" );
+}
+
+int Checkpoint::read_state( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "simulation" );
+  string fingerprint;
+  checkpoint.read_string( fingerprint );
+  int number_of_places, diseases;
+  checkpoint.read( number_of_places );
+  checkpoint.read( diseases );
+  if ( fingerprint != Global::Places.get_population_fingerprint( Global::Pop.get_demes() )
+      || number_of_places != Global::Places.get_number_of_places()
+      || diseases != Global::Diseases ) {
+    Utils::fred_abort( "Checkpoint is of another population or set of diseases\n" );
+  }
+  int day;
+  checkpoint.read( day );
+  read_date( checkpoint, Global::Sim_Start_Date );
+  read_date( checkpoint, Global::Sim_Current_Date );
+
+  read_random( checkpoint );
+  Global::Pop.read_checkpoint( checkpoint );
+  Global::Places.read_checkpoint( checkpoint );
+  Global::Cells->read_checkpoint( checkpoint );
+  if ( Global::Enable_Travel ) {
+    Global::Large_Cells->read_checkpoint( checkpoint );
+    Travel::read_checkpoint( checkpoint );
+  }
+  Activities::read_static_checkpoint( checkpoint );
+  for ( int d = 0; d < Global::Diseases; ++d ) {
+    Global::Pop.get_disease( d )->get_epidemic()->read_checkpoint( checkpoint );
+  }
+  if ( Global::Report_Epidemic_Data_By_Census_Block ) {
+    Global::Block_Epi_Day_Tracker->read_checkpoint( checkpoint );
+  }
+  checkpoint.read_tag( "end of simulation" );
+  return day;
+}
+
+// the output files that are written as the simulation goes, by name; a
+// restart puts back what had been written when the checkpoint was taken
+static struct {
+  const char * name;
+  FILE ** fp;
+} output_files[] = {
+  { "out", &Global::Outfp },
+  { "trace", &Global::Tracefp },
+  { "infections", &Global::Infectionfp },
+  { "report", &Global::Reportfp },
+  { "vacctr", &Global::VaccineTracefp },
+  { "vaccinf", &Global::VaccineInfectionTrackerfp },
+  { "births", &Global::Birthfp },
+  { "deaths", &Global::Deathfp },
+  { "immunity", &Global::Immunityfp },
+  { "households", &Global::Householdfp },
+  { "blockseday", &Global::BlockDayfp }
+};
+
+static const int number_of_output_files = sizeof( output_files ) / sizeof( output_files[ 0 ] );
+
+void Checkpoint::write_output_files( Checkpoint & checkpoint ) {
+  checkpoint.write_tag( "output files" );
+  vector< char > contents;
+  for ( int i = 0; i < number_of_output_files; ++i ) {
+    FILE * fp = *( output_files[ i ].fp );
+    checkpoint.write( (char) ( fp != NULL ) );
+    if ( fp == NULL ) {
+      continue;
+    }
+    fflush( fp );
+    long n = ftell( fp );
+    contents.resize( n );
+    if ( n < 0 || ( n > 0 && pread( fileno( fp ), &( contents[ 0 ] ), n, 0 ) != n ) ) {
+      Utils::fred_abort( "Can't read back the %s output file for a checkpoint\n", output_files[ i ].name );
+    }
+    checkpoint.write_vector( contents );
+  }
+}
+
+void Checkpoint::read_output_files( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "output files" );
+  vector< char > contents;
+  for ( int i = 0; i < number_of_output_files; ++i ) {
+    char was_open;
+    checkpoint.read( was_open );
+    FILE * fp = *( output_files[ i ].fp );
+    if ( was_open != ( fp != NULL ) ) {
+      Utils::fred_abort( "The %s output file was %s when the checkpoint was taken\n",
+          output_files[ i ].name, was_open ? "open" : "not open" );
+    }
+    if ( fp == NULL ) {
+      continue;
+    }
+    checkpoint.read_vector( contents );
+    fflush( fp );
+    ::rewind( fp );
+    if ( ftruncate( fileno( fp ), 0 ) != 0
+        || ( !contents.empty() && fwrite( &( contents[ 0 ] ), contents.size(), 1, fp ) != 1 )
+        || fflush( fp ) != 0 ) {
+      Utils::fred_abort( "Can't restore the %s output file from the checkpoint\n", output_files[ i ].name );
+    }
+  }
+}
+
+void Checkpoint::save_simulation( int day, int run ) {
+  char filename[ FRED_STRING_SIZE ];
+  snprintf( filename, sizeof( filename ), "%s/checkpoint%d_%s.ckp", Global::Output_directory,
+      run, Global::Sim_Current_Date->get_YYYYMMDD().c_str() );
+  Checkpoint checkpoint;
+  write_state( checkpoint, day );
+  write_output_files( checkpoint );
+  checkpoint.save( filename );
+  FRED_STATUS( 0, "checkpoint written to %s (%llu bytes) for day %d\n", filename,
+      (unsigned long long) checkpoint.size(), day );
+}
+
+int Checkpoint::restore_simulation( unsigned long seed ) {
+  Checkpoint checkpoint;
+  checkpoint.load( restart_file );
+  int day = read_state( checkpoint );
+  read_output_files( checkpoint );
+  if ( restart_reseed ) {
+    INIT_RANDOM( seed );
+  }
+  FRED_STATUS( 0, "restarted from %s on day %d%s\n", restart_file, day,
+      restart_reseed ? " with a new seed" : "" );
+  return day;
+}
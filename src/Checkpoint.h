@@ -0,0 +1,199 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Checkpoint.h
+//
+
+#ifndef _FRED_CHECKPOINT_H
+#define _FRED_CHECKPOINT_H
+
+/*
+ * Checkpoint and restart of a simulation, at the end of any day whose date
+ * matches the checkpoint_date_match parameter (see Checkpoint::save_simulation
+ * and Checkpoint::restore_simulation).
+ *
+ * A restarted run reads the same parameters and builds the population,
+ * places and grids as usual; everything that changes from day to day -- the
+ * people and their health, the places and grids, the epidemics, the vaccine
+ * and antiviral stocks and queues, the travelers, the random number
+ * generators, the date and the output files -- is then replaced by what the
+ * checkpoint holds, and the run goes on from the next day, writing the same
+ * output the uninterrupted run would have.  With restart_reseed set, the
+ * random number generators are reseeded instead, so that several runs can
+ * branch from the same day.
+ *
+ * Each part of the simulation writes its own state to a Checkpoint, which
+ * is a byte stream held in memory; tags between the parts catch a mismatch
+ * at once.  People are written as their population index and places as their
+ * id, which are the same in every run built from the same parameters.
+ *
+ * File layout (native byte order):
+ *
+ *   magic             char[ 8 ]
+ *   byte_order        uint32_t
+ *   version           uint32_t
+ *   size              uint64_t
+ *   data              char[ size ]
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include <string.h>
+
+#include "Global.h"
+
+class Person;
+class Place;
+
+class Checkpoint {
+
+public:
+
+  static const uint32_t VERSION = 1;
+
+  Checkpoint() : position( 0 ) { }
+
+  /// empties the checkpoint, keeping its storage
+  void clear() { data.clear(); position = 0; }
+
+  /// goes back to the start, to read the checkpoint again
+  void rewind() { position = 0; }
+
+  size_t size() const { return data.size(); }
+
+  void write_bytes( const void * bytes, size_t n );
+  void read_bytes( void * bytes, size_t n );
+
+  /// for plain data: numbers, dates, arrays and structs without pointers
+  template< typename T > void write( const T & value ) { write_bytes( &value, sizeof( T ) ); }
+  template< typename T > void read( T & value ) { read_bytes( &value, sizeof( T ) ); }
+
+  template< typename T > void write_vector( const std::vector< T > & v ) {
+    write( (uint64_t) v.size() );
+    if ( !v.empty() ) {
+      write_bytes( &( v[ 0 ] ), v.size() * sizeof( T ) );
+    }
+  }
+
+  template< typename T > void read_vector( std::vector< T > & v ) {
+    v.resize( read_size() );
+    if ( !v.empty() ) {
+      read_bytes( &( v[ 0 ] ), v.size() * sizeof( T ) );
+    }
+  }
+
+  void write_size( size_t n ) { write( (uint64_t) n ); }
+  size_t read_size();
+
+  void write_string( const std::string & s );
+  void read_string( std::string & s );
+
+  /// a person (possibly NULL, or no longer alive) as its population index
+  void write_person( Person * person );
+  Person * read_person();
+
+  template< typename Container > void write_people( const Container & people ) {
+    write_size( people.size() );
+    for ( typename Container::const_iterator it = people.begin(); it != people.end(); ++it ) {
+      write_person( *it );
+    }
+  }
+
+  template< typename Container > void read_people( Container & people ) {
+    people.clear();
+    size_t n = read_size();
+    for ( size_t i = 0; i < n; ++i ) {
+      people.insert( people.end(), read_person() );
+    }
+  }
+
+  /// a place (possibly NULL) as its id
+  void write_place( Place * place );
+  Place * read_place();
+
+  template< typename Container > void write_places( const Container & places ) {
+    write_size( places.size() );
+    for ( typename Container::const_iterator it = places.begin(); it != places.end(); ++it ) {
+      write_place( *it );
+    }
+  }
+
+  template< typename Container > void read_places( Container & places ) {
+    places.clear();
+    size_t n = read_size();
+    for ( size_t i = 0; i < n; ++i ) {
+      places.insert( places.end(), read_place() );
+    }
+  }
+
+  /// marks the start of a part; read_tag aborts unless the same tag is next
+  void write_tag( const char * tag );
+  void read_tag( const char * tag );
+
+  /// writes the checkpoint to a file, or aborts
+  void save( const char * filename );
+
+  /// replaces the checkpoint with one read from a file, or aborts
+  void load( const char * filename );
+
+  static void get_parameters();
+
+  /// is this run restarted from a checkpoint file?
+  static bool is_restart() { return strcmp( restart_file, "none" ) != 0; }
+
+  /// should a checkpoint be taken at the end of today (after the date has advanced)?
+  static bool is_checkpoint_date();
+
+  /**
+   * Writes the state of the simulation to the checkpoint file
+   * checkpoint<run>_<YYYY-MM-DD>.ckp in the output directory, named for the
+   * date of the next day to be simulated
+   * @param day the next day to be simulated
+   */
+  static void save_simulation( int day, int run );
+
+  /**
+   * Replaces the state of a simulation that has been set up with the one in
+   * the restart file.
+   * @param seed the seed to start the random number generators from, if
+   * restart_reseed is set
+   * @return the next day to be simulated
+   */
+  static int restore_simulation( unsigned long seed );
+
+  /**
+   * Writes the state of the simulation, other than the output files, to
+   * checkpoint, and reads it back; used for restarts and for runs that share
+   * the same set up.
+   */
+  static void write_state( Checkpoint & checkpoint, int day );
+  static int read_state( Checkpoint & checkpoint );
+
+private:
+
+  std::vector< char > data;
+  size_t position;
+
+  static char checkpoint_date_match[ FRED_STRING_SIZE ];
+  static char restart_file[ FRED_STRING_SIZE ];
+  static int restart_reseed;
+
+  static const char MAGIC[ 8 ];
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+  static void write_output_files( Checkpoint & checkpoint );
+  static void read_output_files( Checkpoint & checkpoint );
+};
+
+#endif // _FRED_CHECKPOINT_H
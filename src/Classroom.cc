@@ -20,6 +20,7 @@
 #include "Random.h"
 #include "Person.h"
 #include "Disease.h"
+#include "Checkpoint.h"
 
 //Private static variables that will be set by parameter lookups
 double * Classroom::Classroom_contacts_per_day;
@@ -74,6 +75,7 @@ void Classroom::get_parameters(int diseases) {
 }
 
 void Classroom::enroll(Person * per) {
+  add_enrollee(per);
   N++;
   int age = per->get_age();
   if (age_level == -1 && age < Global::ADULT_AGE) {
@@ -103,3 +105,12 @@ double Classroom::get_contacts_per_day(int disease) {
   return Classroom::Classroom_contacts_per_day[disease];
 }
 
+void Classroom::write_checkpoint(Checkpoint & checkpoint) {
+  Place::write_checkpoint(checkpoint);
+  checkpoint.write(age_level);
+}
+
+void Classroom::read_checkpoint(Checkpoint & checkpoint) {
+  Place::read_checkpoint(checkpoint);
+  checkpoint.read(age_level);
+}
@@ -61,6 +61,12 @@ public:
    */
   void enroll(Person * per);
 
+  /**
+   * @see Place::write_checkpoint(Checkpoint & checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * @see Place::get_group(int disease, Person * per)
    */
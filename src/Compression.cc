@@ -14,7 +14,7 @@
 #include "Compression.h"
 
 
-void SnappyFileCompression::compress_file_to_stdout() {
+void SnappyFileCompression::compress_file_to_stdout( size_t block_size ) {
   using namespace std;
   // open the uncompressed input file
   FILE * fp = fopen( infile_name, "r" );
@@ -30,10 +30,10 @@ void SnappyFileCompression::compress_file_to_stdout() {
       PROT_READ, MAP_PRIVATE, fd, 0 );
   // layout will be:
   // [ size compressed_size_0 ][ char * compressed_data_0 ]...
-  // target uncompressed size will be default_block_size bytes
+  // target uncompressed size will be block_size bytes
   // but to ease parsing, ensure that blocks end with newline...
   size_t target_block_size =
-    default_block_size > infile_size ? infile_size : default_block_size;
+    block_size > infile_size ? infile_size : block_size;
   // pointers into the mmapped file
   begin = map;
   end = begin;
@@ -43,7 +43,7 @@ void SnappyFileCompression::compress_file_to_stdout() {
   total_header_bytes = 0;
   // write magic bytes:
   printf( "%s", FSZ_MAGIC() ); 
-  // run through the mapped file and compress approximately default_block_size
+  // run through the mapped file and compress approximately block_size
   // bytes into blocks that are preceeded by their byte-encoded size.  Ensure
   // that the blocks end on newlines to facillitate parallel processing when reading
   // compressed file
@@ -182,79 +182,43 @@ bool SnappyFileCompression::check_magic_bytes() {
   }
 }
 
-bool SnappyFileCompression::load_next_block_stream( std::stringstream & stream ) {
-  
-  fred::Scoped_Lock lock( mutex );
-
-  if ( begin < end ) {
-    char current_block_size_byte_array[ sizeof( size_t ) ];
-    // grab the block size as byte array from mmapped compressed file
-    memcpy( current_block_size_byte_array, begin, sizeof( size_t ) );
-    // Cast the block size into integer
-    size_t * current_block_size = reinterpret_cast< size_t * > ( &current_block_size_byte_array );
-    // string to contain uncompressed output
-    std::string uncompressed_output;
-    // advance reading pointer past the header bytes
-    begin += sizeof( size_t );
-    // uncompress into a string
-    snappy::Uncompress( begin, *current_block_size, &uncompressed_output );
-    // add to stream
-    if ( uncompressed_output.empty() ) {
-      return false;
+int SnappyFileCompression::build_block_index() {
+  block_data.clear();
+  block_size.clear();
+  const char * current = begin;
+  while ( current < end ) {
+    if ( current + sizeof( size_t ) > end ) {
+      FSZ_ABORT( "truncated block header in %s\n", infile_name );
     }
-    else {
-      stream.str( uncompressed_output );
-      stream.clear();
+    size_t compressed_size;
+    // grab the block size from the header bytes
+    memcpy( &compressed_size, current, sizeof( size_t ) );
+    current += sizeof( size_t );
+    if ( compressed_size > (size_t) ( end - current ) ) {
+      FSZ_ABORT( "truncated block %d in %s\n", (int) block_data.size(), infile_name );
     }
-    // advance read pointer to next block
-    begin += (*current_block_size);
-    // running totals for final reporting
-    total_compressed_bytes += *current_block_size;
-    total_uncompressed_bytes += uncompressed_output.size();
+    block_data.push_back( current );
+    block_size.push_back( compressed_size );
+    total_compressed_bytes += compressed_size;
     total_header_bytes += sizeof( size_t );
-    return true;
-  }
-  else {
-    return false;
+    // advance to the next block header
+    current += compressed_size;
   }
+  return block_data.size();
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+size_t SnappyFileCompression::uncompress_block( int i, std::vector< char > & buffer ) {
+  size_t uncompressed_size;
+  if ( !( snappy::GetUncompressedLength( block_data[ i ], block_size[ i ], &uncompressed_size ) ) ) {
+    FSZ_ABORT( "corrupt block %d in %s\n", i, infile_name );
+  }
+  if ( buffer.size() < uncompressed_size + 1 ) {
+    buffer.resize( uncompressed_size + 1 );
+  }
+  // uncompress directly into the buffer; no intermediate string
+  if ( !( snappy::RawUncompress( block_data[ i ], block_size[ i ], &buffer[ 0 ] ) ) ) {
+    FSZ_ABORT( "corrupt block %d in %s\n", i, infile_name );
+  }
+  buffer[ uncompressed_size ] = '\0';
+  return uncompressed_size;
+}
@@ -80,7 +80,9 @@ class SnappyFileCompression {
   uint64_t total_compressed_bytes;
   uint64_t total_header_bytes;
 
-  fred::Mutex mutex;
+  // start and compressed size of each block, see build_block_index
+  std::vector< const char * > block_data;
+  std::vector< size_t > block_size;
 
   public:
 
@@ -90,9 +92,10 @@ class SnappyFileCompression {
   }
 
   /*
-   * Compresses file supplied to constructor to stdout
+   * Compresses file supplied to constructor to stdout, in blocks of about
+   * block_size uncompressed bytes
    */
-  void compress_file_to_stdout(); 
+  void compress_file_to_stdout( size_t block_size = default_block_size ); 
 
   /*
    * Uncompresses file supplied to constructor to stdout
@@ -103,7 +106,23 @@ class SnappyFileCompression {
 
   bool check_magic_bytes();
 
-  bool load_next_block_stream( std::stringstream & stream );
+  /*
+   * Records where each compressed block starts (after check_magic_bytes);
+   * only the block headers are read.  Returns the number of blocks.
+   */
+  int build_block_index();
+
+  int get_number_of_blocks() {
+    return block_data.size();
+  }
+
+  /*
+   * Uncompresses block i into buffer, which is grown as needed so that it
+   * can be reused for the next block, and appends a terminating '\0'.
+   * Returns the uncompressed size.  Blocks are independent, so different
+   * threads may uncompress different blocks at the same time.
+   */
+  size_t uncompress_block( int i, std::vector< char > & buffer );
 
 };
 
@@ -0,0 +1,153 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Contact_Sampler.h
+//
+
+#ifndef _FRED_CONTACT_SAMPLER_H
+#define _FRED_CONTACT_SAMPLER_H
+
+/*
+ * Flat, reusable contact tally for Place::spread_infection.
+ *
+ * Contacts are drawn with replacement into a flat buffer of target positions,
+ * which is then sorted and collapsed into (position, times drawn) runs.  This
+ * replaces the std::map< int, int > that was built for every infector, and
+ * allocated a tree node per distinct contact.  Random draws are made in exactly
+ * the same order as before, and the runs come out in ascending position order
+ * (the iteration order of the map), so results are unchanged.
+ *
+ * sample_skip_ahead() is an optional faster variant for large places, used
+ * when Global::Enable_Skip_Ahead_Transmission is set.
+ *
+ * One sampler is kept per thread (see Place::Contact_Samplers) so the buffers
+ * grow to the largest place seen and are then reused without allocation.
+ */
+
+#include <vector>
+#include <algorithm>
+
+#include "Random.h"
+
+struct Contact_Sampler {
+
+  std::vector< int > draws;        // raw target positions, in draw order
+  std::vector< int > positions;    // distinct positions, ascending
+  std::vector< int > times_drawn;  // number of draws for each distinct position
+
+  /**
+   * Draw contacts with replacement from among the potential targets of a place.
+   * Positions >= number_susceptibles are contacts with non-susceptibles and are
+   * dropped.  Drawing the infector itself is redrawn, unless the infector is the
+   * only susceptible, in which case sampling stops.
+   *
+   * @param contact_count the number of contacts to draw
+   * @param number_targets the number of potential targets (at least number_susceptibles)
+   * @param susceptibles the susceptible visitors
+   * @param number_susceptibles the number of susceptible visitors
+   * @param self the infector
+   * @return the number of distinct susceptibles contacted
+   */
+  template< typename T >
+  int sample( int contact_count, int number_targets, T * susceptibles,
+      int number_susceptibles, T self ) {
+    draws.clear();
+    for ( int c = 0; c < contact_count; ++c ) {
+      // select a target infectee from among susceptibles with replacement
+      int pos = IRAND( 0, number_targets - 1 );
+      if ( pos < number_susceptibles ) {
+        if ( self == susceptibles[ pos ] ) {
+          if ( number_susceptibles > 1 ) {
+            --( c ); // redo
+            continue;
+          }
+          else {
+            break; // give up
+          }
+        }
+        draws.push_back( pos );
+      }
+    }
+    tally();
+    return positions.size();
+  }
+
+  /**
+   * Skip-ahead alternative to sample() for large places.  Rather than drawing
+   * every contact, draw the number of contacts that would transmit to a
+   * susceptible with the largest transmission probability, max_prob (a
+   * binomial variate), and pick targets only for those.  Each candidate must then
+   * be accepted with probability (its own transmission probability) / max_prob,
+   * which makes the result equivalent in distribution to sample() followed by
+   * one transmission attempt per draw.
+   *
+   * The infector must not be among the susceptibles, and max_prob must not
+   * exceed 1.
+   *
+   * @param contact_count the number of contacts
+   * @param number_targets the number of potential targets (at least number_susceptibles)
+   * @param number_susceptibles the number of susceptible visitors
+   * @param max_prob the largest per-contact transmission probability
+   * @return the number of distinct candidate infectees
+   */
+  int sample_skip_ahead( int contact_count, int number_targets,
+      int number_susceptibles, double max_prob ) {
+    draws.clear();
+    double hit_prob = max_prob * number_susceptibles / number_targets;
+    int candidates = draw_binomial( contact_count, hit_prob );
+    for ( int c = 0; c < candidates; ++c ) {
+      draws.push_back( IRAND( 0, number_susceptibles - 1 ) );
+    }
+    tally();
+    return positions.size();
+  }
+
+  int size() { return positions.size(); }
+  int get_position( int i ) { return positions[ i ]; }
+  int get_times_drawn( int i ) { return times_drawn[ i ]; }
+
+  void clear() {
+    draws.clear();
+    positions.clear();
+    times_drawn.clear();
+  }
+
+  void reset() {
+    draws = std::vector< int >();
+    positions = std::vector< int >();
+    times_drawn = std::vector< int >();
+  }
+
+private:
+
+  // collapse the raw draws into ascending (position, count) runs
+  void tally() {
+    positions.clear();
+    times_drawn.clear();
+    if ( draws.empty() ) { return; }
+    std::sort( draws.begin(), draws.end() );
+    positions.push_back( draws[ 0 ] );
+    times_drawn.push_back( 1 );
+    for ( int i = 1; i < draws.size(); ++i ) {
+      if ( draws[ i ] == positions.back() ) {
+        ++( times_drawn.back() );
+      }
+      else {
+        positions.push_back( draws[ i ] );
+        times_drawn.push_back( 1 );
+      }
+    }
+  }
+
+};
+
+#endif // _FRED_CONTACT_SAMPLER_H
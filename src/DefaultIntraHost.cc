@@ -19,7 +19,8 @@
 #include "Params.h"
 #include "Random.h"
 
-DefaultIntraHost::DefaultIntraHost() {
+DefaultIntraHost::DefaultIntraHost() :
+  shapes( NCPU ) {
   prob_symptomatic = -1.0;
   asymp_infectivity = -1.0;
   symp_infectivity = -1.0;
@@ -70,18 +71,13 @@ void DefaultIntraHost::setup(Disease *disease) {
 
 Trajectory * DefaultIntraHost::get_trajectory( Infection *infection, Transmission::Loads * loads ) {
   // TODO  take loads into account - multiple strains
-  Trajectory * trajectory = new Trajectory();
   int sequential = get_infection_model();
 
   int will_be_symptomatic = get_symptoms();
 
   int days_latent = get_days_latent();
-  int days_incubating;
   int days_asymptomatic = 0;
   int days_symptomatic = 0;
-  double symptomatic_infectivity = get_symp_infectivity();
-  double asymptomatic_infectivity = get_asymp_infectivity();
-  double symptomaticity = 1.0;
 
   if (sequential) { // SEiIR model
     days_asymptomatic = get_days_asymp();
@@ -97,22 +93,41 @@ Trajectory * DefaultIntraHost::get_trajectory( Infection *infection, Transmissio
     }
   }
 
-  days_incubating = days_latent + days_asymptomatic;
+  if (loads->size() != 1) {
+    return new Trajectory(get_table(loads, days_latent, days_asymptomatic, days_symptomatic));
+  }
+
+  Shape shape(loads->begin()->first, days_latent, days_asymptomatic, days_symptomatic);
+  Shape_Map & tables = shapes();
+  Shape_Map::iterator it = tables.find(shape);
+  if (it == tables.end()) {
+    const Trajectory_Table * table = get_table(loads, days_latent, days_asymptomatic, days_symptomatic);
+    it = tables.insert(Shape_Map::value_type(shape, table)).first;
+  }
+  return new Trajectory(it->second);
+}
+
+const Trajectory_Table * DefaultIntraHost::get_table( Transmission::Loads * loads, int days_latent,
+                                                      int days_asymptomatic, int days_symptomatic ) {
+  int days_incubating = days_latent + days_asymptomatic;
+  double symptomatic_infectivity = get_symp_infectivity();
+  double asymptomatic_infectivity = get_asymp_infectivity();
+  double symptomaticity = 1.0;
 
+  map<int, trajectory_t> infectivities;
   map<int, double> :: iterator it;
 
   for(it = loads->begin(); it != loads->end(); it++) {
     vector<double> infectivity_trajectory(days_latent, 0.0);
     infectivity_trajectory.insert(infectivity_trajectory.end(), days_asymptomatic, asymptomatic_infectivity);
     infectivity_trajectory.insert(infectivity_trajectory.end(), days_symptomatic, symptomatic_infectivity);
-    trajectory->set_infectivity_trajectory(it->first, infectivity_trajectory);
+    infectivities[it->first] = infectivity_trajectory;
   }
 
   vector<double> symptomaticity_trajectory(days_incubating, 0.0);
   symptomaticity_trajectory.insert(symptomaticity_trajectory.end(), days_symptomatic, symptomaticity);
-  trajectory->set_symptomaticity_trajectory(symptomaticity_trajectory);
 
-  return trajectory;
+  return Trajectory_Table::intern(infectivities, symptomaticity_trajectory);
 }
 
 int DefaultIntraHost::get_days_latent() {
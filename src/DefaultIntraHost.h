@@ -19,6 +19,7 @@
 #include "Infection.h"
 #include "Trajectory.h"
 #include "Transmission.h"
+#include "State.h"
 
 class Infection;
 class Trajectory;
@@ -117,6 +118,28 @@ class DefaultIntraHost : public IntraHost {
     double *days_asymp;
     double *days_symp;
     double prob_symptomatic;
+
+    // With one strain the trajectory is determined by the strain and the
+    // three periods, so each thread remembers the shared table for them.
+    struct Shape {
+      int strain;
+      int days_latent;
+      int days_asymptomatic;
+      int days_symptomatic;
+      Shape( int s, int l, int a, int y ) :
+        strain( s ), days_latent( l ), days_asymptomatic( a ), days_symptomatic( y ) { }
+      bool operator<( const Shape & other ) const {
+        if ( strain != other.strain ) return strain < other.strain;
+        if ( days_latent != other.days_latent ) return days_latent < other.days_latent;
+        if ( days_asymptomatic != other.days_asymptomatic ) return days_asymptomatic < other.days_asymptomatic;
+        return days_symptomatic < other.days_symptomatic;
+      }
+    };
+    typedef std::map< Shape, const Trajectory_Table * > Shape_Map;
+    State< Shape_Map > shapes;
+
+    const Trajectory_Table * get_table( Transmission::Loads * loads, int days_latent,
+                                        int days_asymptomatic, int days_symptomatic );
   };
 
 #endif
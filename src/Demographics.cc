@@ -23,6 +23,7 @@
 #include "Global.h"
 #include "Date.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 
 class Global;
 
@@ -115,7 +116,7 @@ void Demographics::setup( Person * self, short int _age, char _sex,
     if ( RANDOM() <= pct_chance_to_die ) {
       //Yes, so set the death day (in simulation days)
       this->deceased_sim_day = (day + IRAND(1,364));
-      Global::Pop.set_mask_by_index( fred::Update_Deaths, self_index );
+      Global::Pop.schedule_death( deceased_sim_day, self_index );
     }
   }
 
@@ -125,7 +126,7 @@ void Demographics::setup( Person * self, short int _age, char _sex,
       //Yes, so set the due_date (in simulation days)
       this->due_sim_day = ( day + IRAND( 1, 280 ) );
       this->pregnant = true;
-      Global::Pop.set_mask_by_index( fred::Update_Births, self_index );
+      Global::Pop.schedule_birth( due_sim_day, self_index );
       FRED_STATUS( 2, "Birth scheduled during initialization! conception day: %d, delivery day: %d\n",
             conception_sim_day, due_sim_day );
     }
@@ -146,8 +147,6 @@ void Demographics::update_births( Person * self, int day ) {
       conception_sim_day = -1;
       due_sim_day = -1;
       pregnant = false;
-      // don't update this person's demographics anymore
-      Global::Pop.clear_mask_by_index( fred::Update_Births, self->get_pop_index() );
       // give birth
       Global::Pop.prepare_to_give_birth( day, self->get_pop_index() );
     }
@@ -157,15 +156,43 @@ void Demographics::update_births( Person * self, int day ) {
 void Demographics::update_deaths( Person * self, int day ) {
   if ( Global::Enable_Deaths ) {
     //Is this your day to die?
-    if ( deceased_sim_day == day ) {
-      // don't update this person's demographics anymore
-      Global::Pop.clear_mask_by_index( fred::Update_Deaths, self->get_pop_index() );
+    if ( deceased_sim_day == day && !deceased ) {
       deceased = true;
       Global::Pop.prepare_to_die( day, self->get_pop_index() );
     }
   }
 }
 
+void Demographics::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write( init_age );
+  checkpoint.write( birth_day_of_year );
+  checkpoint.write( birth_year );
+  checkpoint.write( deceased_sim_day );
+  checkpoint.write( conception_sim_day );
+  checkpoint.write( due_sim_day );
+  checkpoint.write( age );
+  checkpoint.write( sex );
+  checkpoint.write( pregnant );
+  checkpoint.write( deceased );
+  checkpoint.write( relationship );
+  checkpoint.write( race );
+}
+
+void Demographics::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read( init_age );
+  checkpoint.read( birth_day_of_year );
+  checkpoint.read( birth_year );
+  checkpoint.read( deceased_sim_day );
+  checkpoint.read( conception_sim_day );
+  checkpoint.read( due_sim_day );
+  checkpoint.read( age );
+  checkpoint.read( sex );
+  checkpoint.read( pregnant );
+  checkpoint.read( deceased );
+  checkpoint.read( relationship );
+  checkpoint.read( race );
+}
+
 void Demographics::birthday( Person * self, int day ) {
   FRED_STATUS( 2, "birthday entered for person %d age %d\n", self->get_id(), self->get_age());
   //The age to look up should be an integer between 0 and the MAX_AGE
@@ -195,8 +222,8 @@ void Demographics::birthday( Person * self, int day ) {
       // Yes, so set the death day (in simulation days)
       FRED_STATUS( 2, "set deceased_sim_day\n");
       this->deceased_sim_day = (day + IRAND(0,364));
-      // and flag for daily updates until death
-      Global::Pop.set_mask_by_index( fred::Update_Deaths, self->get_pop_index() );
+      // and file it for that day
+      Global::Pop.schedule_death( deceased_sim_day, self->get_pop_index() );
     }
   }
 
@@ -215,8 +242,8 @@ void Demographics::birthday( Person * self, int day ) {
         due_sim_day = conception_sim_day + (int) ( draw_normal(
               Demographics::MEAN_PREG_DAYS, Demographics::STDDEV_PREG_DAYS) + 0.5 );
         pregnant = true;
-        // flag for daily updates
-        Global::Pop.set_mask_by_index( fred::Update_Births, self->get_pop_index() );
+        // file the delivery for its day
+        Global::Pop.schedule_birth( due_sim_day, self->get_pop_index() );
         FRED_STATUS( 2, "Birth scheduled! conception day: %d, delivery day: %d\n",
             conception_sim_day, due_sim_day );
       }
@@ -20,6 +20,7 @@
 #include "Global.h"
 class Person;
 class Date;
+class Checkpoint;
 
 class Demographics {
 public:
@@ -67,6 +68,16 @@ public:
    */
   const bool is_pregnant() const { return pregnant; }
 
+  /**
+   * @return the simulation day the agent will give birth, or -1
+   */
+  int get_due_sim_day() const { return due_sim_day; }
+
+  /**
+   * @return the simulation day the agent will die (or died), or -1
+   */
+  int get_deceased_sim_day() const { return deceased_sim_day; }
+
   /**
    * @return <code>true</code> if the agent is deceased, <code>false</code> otherwise
    */
@@ -115,6 +126,10 @@ public:
   
   void terminate( Person * self ) { }
 
+  /// see Checkpoint
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
+
   /**
    * This method is only used one time during initialization to load the birth rate and mortality rate arrays from files
    */
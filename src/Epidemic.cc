@@ -16,9 +16,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include <new>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -43,6 +45,10 @@ using namespace std;
 #include "Evolution.h"
 #include "Workplace.h"
 #include "Tracker.h"
+#include "Activities.h"
+#include "Cell.h"
+#include "Travel.h"
+#include "Checkpoint.h"
 
 Epidemic::Epidemic(Disease *dis, Timestep_Map* _primary_cases_map) {
   disease = dis;
@@ -93,6 +99,9 @@ Epidemic::Epidemic(Disease *dis, Timestep_Map* _primary_cases_map) {
   daily_infections_list.clear();
 
   seeding_type = SEED_EXPOSED;
+
+  pending_transmissions = State< vector <Pending_Transmission> >( NCPU );
+  infectious_sample_count = 0;
 }
 
 void Epidemic::setup() {
@@ -189,6 +198,7 @@ void Epidemic::become_symptomatic(Person *person) {
   ++people_with_current_symptoms;
   #pragma omp atomic
   ++people_becoming_symptomatic_today;
+  Global::Pop.set_mask_by_index( fred::Symptomatic, person->get_pop_index() );
 }
 
 void Epidemic::become_removed(Person *person, bool susceptible, bool infectious, bool symptomatic) {
@@ -350,6 +360,71 @@ void Epidemic::print_stats(int day) {
   daily_infections_list.clear();
 }
 
+void Epidemic::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("epidemic");
+  checkpoint.write(N);
+  checkpoint.write(N_init);
+  checkpoint.write(primary_cases_map->get_current_value());
+  checkpoint.write(susceptible_people);
+  checkpoint.write(exposed_people);
+  checkpoint.write(infectious_people);
+  checkpoint.write(removed_people);
+  checkpoint.write(immune_people);
+  checkpoint.write(people_becoming_infected_today);
+  checkpoint.write(total_people_ever_infected);
+  checkpoint.write(people_becoming_symptomatic_today);
+  checkpoint.write(people_with_current_symptoms);
+  checkpoint.write(total_people_ever_symptomatic);
+  checkpoint.write(RR);
+  checkpoint.write(attack_ratio);
+  checkpoint.write(symptomatic_attack_ratio);
+  checkpoint.write(incidence);
+  checkpoint.write(symptomatic_incidence);
+  checkpoint.write(prevalence_count);
+  checkpoint.write(prevalence);
+  checkpoint.write_vector(vector<int>(daily_cohort_size, daily_cohort_size + Global::Days));
+  checkpoint.write_vector(vector<int>(number_infected_by_cohort,
+        number_infected_by_cohort + Global::Days));
+  checkpoint.write(infectious_sample_count);
+}
+
+void Epidemic::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("epidemic");
+  checkpoint.read(N);
+  checkpoint.read(N_init);
+  int current_primary_cases;
+  checkpoint.read(current_primary_cases);
+  primary_cases_map->set_current_value(current_primary_cases);
+  checkpoint.read(susceptible_people);
+  checkpoint.read(exposed_people);
+  checkpoint.read(infectious_people);
+  checkpoint.read(removed_people);
+  checkpoint.read(immune_people);
+  checkpoint.read(people_becoming_infected_today);
+  checkpoint.read(total_people_ever_infected);
+  checkpoint.read(people_becoming_symptomatic_today);
+  checkpoint.read(people_with_current_symptoms);
+  checkpoint.read(total_people_ever_symptomatic);
+  checkpoint.read(RR);
+  checkpoint.read(attack_ratio);
+  checkpoint.read(symptomatic_attack_ratio);
+  checkpoint.read(incidence);
+  checkpoint.read(symptomatic_incidence);
+  checkpoint.read(prevalence_count);
+  checkpoint.read(prevalence);
+  // the restarted run may go on for more (or fewer) days than the original
+  vector<int> cohort;
+  checkpoint.read_vector(cohort);
+  for (int i = 0; i < Global::Days; i++) {
+    daily_cohort_size[i] = i < (int) cohort.size() ? cohort[i] : 0;
+  }
+  checkpoint.read_vector(cohort);
+  for (int i = 0; i < Global::Days; i++) {
+    number_infected_by_cohort[i] = i < (int) cohort.size() ? cohort[i] : 0;
+  }
+  checkpoint.read(infectious_sample_count);
+}
+
 void::Epidemic::report_age_of_infection(int day) {
   int age_count[21];				// age group counts
   double mean_age = 0.0;
@@ -482,14 +557,9 @@ void Epidemic::report_presenteeism(int day) {
   int infections_at_work = 0;
 
   // company size limits
-  static int small;
-  static int medium;
-  static int large;
-  if (day == 0) {
-    small = Workplace::get_small_workplace_size();
-    medium = Workplace::get_medium_workplace_size();
-    large = Workplace::get_large_workplace_size();
-  }
+  int small = Workplace::get_small_workplace_size();
+  int medium = Workplace::get_medium_workplace_size();
+  int large = Workplace::get_large_workplace_size();
 
   for (int i = 0; i < people_becoming_infected_today; i++) {
     Person * infectee = daily_infections_list[i];
@@ -722,41 +792,71 @@ void Epidemic::transmit(int day){
   FRED_STATUS(0, "Number of infectious classrooms    => %9d\n", (int) inf_classrooms.size());
   FRED_STATUS(0, "Number of infectious workplaces    => %9d\n", (int) inf_workplaces.size());
   FRED_STATUS(0, "Number of infectious offices       => %9d\n", (int) inf_offices.size());
+
+  // the places were found by the sweeps in thread order
+  if ( RNG::counter_streams ) {
+    sort_infectious_places();
+  }
+
+  // sort the visitors staged during today's sweeps into per-place runs
+  // (households don't use staged visitors)
+  if ( Global::Enable_Lock_Free_Staging ) {
+    std::vector< std::vector< Place * > * > staged_places;
+    staged_places.push_back( &inf_schools );
+    staged_places.push_back( &inf_classrooms );
+    staged_places.push_back( &inf_workplaces );
+    staged_places.push_back( &inf_offices );
+    staged_places.push_back( &inf_neighborhoods );
+    Place::Visitor_Staging[ id ].bucket( staged_places );
+  }
   
-  #pragma omp parallel
-  {
-    // schools (and classrooms)
-    #pragma omp for schedule(dynamic,10)
-    for ( int i = 0; i < inf_schools.size(); ++i ) {
-      inf_schools[ i ]->spread_infection( day, id );
-    }
+  if ( Global::Enable_Work_Stealing ) {
+    transmit_with_work_stealing( day );
+  }
+  else {
+    #pragma omp parallel
+    {
+      // schools (and classrooms)
+      #pragma omp for schedule(dynamic,10)
+      for ( int i = 0; i < inf_schools.size(); ++i ) {
+        inf_schools[ i ]->spread_infection( day, id );
+      }
 
-    #pragma omp for schedule(dynamic,10)
-    for ( int i = 0; i < inf_classrooms.size(); ++i ) {
-      inf_classrooms[ i ]->spread_infection( day, id );
-    }
+      #pragma omp for schedule(dynamic,10)
+      for ( int i = 0; i < inf_classrooms.size(); ++i ) {
+        inf_classrooms[ i ]->spread_infection( day, id );
+      }
 
-    // workplaces (and offices)
-    #pragma omp for schedule(dynamic,10)
-    for ( int i = 0; i < inf_workplaces.size(); ++i ) {
-      inf_workplaces[ i ]->spread_infection( day, id );
-    }
-    #pragma omp for schedule(dynamic,10)
-    for ( int i = 0; i < inf_offices.size(); ++i ) {
-      inf_offices[ i ]->spread_infection( day, id );
-    }
+      // workplaces (and offices)
+      #pragma omp for schedule(dynamic,10)
+      for ( int i = 0; i < inf_workplaces.size(); ++i ) {
+        inf_workplaces[ i ]->spread_infection( day, id );
+      }
+      #pragma omp for schedule(dynamic,10)
+      for ( int i = 0; i < inf_offices.size(); ++i ) {
+        inf_offices[ i ]->spread_infection( day, id );
+      }
 
-    // neighborhoods (and households)
-    #pragma omp for schedule(dynamic,100)
-    for ( int i = 0; i < inf_neighborhoods.size(); ++i ) {
-      inf_neighborhoods[ i ]->spread_infection( day, id );
-    }
-    #pragma omp for schedule(dynamic,100)
-    for ( int i = 0; i < inf_households.size(); ++i ) {
-      inf_households[ i ]->spread_infection( day, id );
+      // neighborhoods (and households)
+      #pragma omp for schedule(dynamic,100)
+      for ( int i = 0; i < inf_neighborhoods.size(); ++i ) {
+        inf_neighborhoods[ i ]->spread_infection( day, id );
+      }
+      #pragma omp for schedule(dynamic,100)
+      for ( int i = 0; i < inf_households.size(); ++i ) {
+        inf_households[ i ]->spread_infection( day, id );
+      }
     }
   }
 
+  if ( RNG::counter_streams ) {
+    resolve_pending_transmissions( day );
+  }
+
+  if ( Global::Enable_Lock_Free_Staging ) {
+    Place::Visitor_Staging[ id ].clear();
+  }
+
   inf_households.clear();
   inf_neighborhoods.clear();
   inf_classrooms.clear();
@@ -767,6 +867,136 @@ void Epidemic::transmit(int day){
 
 
 
+static bool compare_place_id( Place * p1, Place * p2 ) {
+  return p1->get_id() < p2->get_id();
+}
+
+void Epidemic::sort_infectious_places() {
+  sort( inf_households.begin(), inf_households.end(), compare_place_id );
+  sort( inf_neighborhoods.begin(), inf_neighborhoods.end(), compare_place_id );
+  sort( inf_classrooms.begin(), inf_classrooms.end(), compare_place_id );
+  sort( inf_schools.begin(), inf_schools.end(), compare_place_id );
+  sort( inf_workplaces.begin(), inf_workplaces.end(), compare_place_id );
+  sort( inf_offices.begin(), inf_offices.end(), compare_place_id );
+}
+
+void Epidemic::add_pending_transmission(Person * infector, Person * infectee, Place * place) {
+  Pending_Transmission pending = { infector, infectee, place };
+  pending_transmissions().push_back( pending );
+}
+
+bool Epidemic::compare_pending_transmissions( const Pending_Transmission & t1,
+    const Pending_Transmission & t2 ) {
+  if ( t1.infectee != t2.infectee ) { return t1.infectee->get_id() < t2.infectee->get_id(); }
+  if ( t1.place != t2.place ) { return t1.place->get_id() < t2.place->get_id(); }
+  return t1.infector->get_id() < t2.infector->get_id();
+}
+
+// Each person who was infected today in one or more places, or by more than
+// one infector, takes one of these transmissions at random; the infections
+// are created in order of infectee id, so that they are the same for any
+// number of threads.
+void Epidemic::resolve_pending_transmissions(int day) {
+  vector <Pending_Transmission> pending;
+  for ( int t = 0; t < pending_transmissions.size(); ++t ) {
+    vector <Pending_Transmission> & thread_pending = pending_transmissions( t );
+    pending.insert( pending.end(), thread_pending.begin(), thread_pending.end() );
+    thread_pending.clear();
+  }
+  sort( pending.begin(), pending.end(), compare_pending_transmissions );
+
+  int first = 0;
+  while ( first < pending.size() ) {
+    Person * infectee = pending[ first ].infectee;
+    int last = first + 1;
+    while ( last < pending.size() && pending[ last ].infectee == infectee ) { ++last; }
+    RNG_Stream stream( RNG_Stream::TRANSMISSION, day, infectee->get_id(), id );
+    Pending_Transmission & chosen = pending[ IRAND( first, last - 1 ) ];
+    if ( infectee->is_susceptible( id ) ) {
+      Transmission transmission = Transmission( chosen.infector, chosen.place, day );
+      chosen.infector->infect( infectee, id, transmission );
+    }
+    first = last;
+  }
+}
+
+// runs one task of transmit_with_work_stealing: a range of the infectious
+// visitors of one place, or a run of households
+struct Epidemic::spread_task {
+  Epidemic & epidemic;
+  int day;
+  spread_task( Epidemic & e, int d ) : epidemic( e ), day( d ) { }
+  void operator() ( const Work_Stealing_Scheduler::Task & task ) {
+    if ( task.index < 0 ) {
+      for ( int i = task.first; i < task.last; ++i ) {
+        epidemic.inf_households[ i ]->spread_infection( day, epidemic.id );
+      }
+    }
+    else {
+      epidemic.spread_places[ task.index ]->spread_infection_range( day, epidemic.id,
+          epidemic.spread_contexts[ task.index ], task.first, task.last );
+    }
+  }
+};
+
+void Epidemic::transmit_with_work_stealing(int day) {
+  // all place types share one balanced pool of tasks; households are
+  // small and go in runs, other places are prepared first so that their
+  // infectious visitors can be counted and split
+  spread_places.clear();
+  spread_places.insert( spread_places.end(), inf_schools.begin(), inf_schools.end() );
+  spread_places.insert( spread_places.end(), inf_classrooms.begin(), inf_classrooms.end() );
+  spread_places.insert( spread_places.end(), inf_workplaces.begin(), inf_workplaces.end() );
+  spread_places.insert( spread_places.end(), inf_offices.begin(), inf_offices.end() );
+  spread_places.insert( spread_places.end(), inf_neighborhoods.begin(), inf_neighborhoods.end() );
+  int number_places = spread_places.size();
+
+  // contexts must not move once prepared
+  spread_contexts.clear();
+  spread_contexts.resize( number_places );
+  vector< char > prepared( number_places, 0 );
+
+  #pragma omp parallel for schedule(dynamic,10)
+  for ( int i = 0; i < number_places; ++i ) {
+    prepared[ i ] = spread_places[ i ]->prepare_spread_infection( day, id, spread_contexts[ i ] );
+  }
+
+  // estimated cost is infectious x susceptible visitors
+  int infectors_per_task = Global::Work_Stealing_Infectors_Per_Task;
+  transmission_scheduler.clear();
+  for ( int i = 0; i < number_places; ++i ) {
+    if ( !prepared[ i ] ) { continue; }
+    Place::Spread_Context & context = spread_contexts[ i ];
+    for ( int first = 0; first < context.number_infectious; first += infectors_per_task ) {
+      int last = first + infectors_per_task;
+      if ( last > context.number_infectious ) { last = context.number_infectious; }
+      transmission_scheduler.add_task( i, first, last,
+          (double) ( last - first ) * context.number_susceptibles );
+    }
+  }
+  for ( int first = 0; first < inf_households.size(); first += HOUSEHOLDS_PER_TASK ) {
+    int last = first + HOUSEHOLDS_PER_TASK;
+    if ( last > inf_households.size() ) { last = inf_households.size(); }
+    double cost = 0.0;
+    for ( int i = first; i < last; ++i ) {
+      cost += (double) inf_households[ i ]->get_size() * inf_households[ i ]->get_size();
+    }
+    transmission_scheduler.add_task( -1, first, last, cost );
+  }
+
+  spread_task task( *this, day );
+  transmission_scheduler.run( task );
+  spread_contexts.clear();
+}
+
+void Epidemic::end_of_run() {
+  if ( Global::Enable_Work_Stealing ) {
+    char name[ FRED_STRING_SIZE ];
+    sprintf( name, "transmission scheduler (disease %d)", id );
+    transmission_scheduler.report( Global::Statusfp, name );
+  }
+}
+
 void Epidemic::update(int day) {
   Activities::update(day);
   for (int d = 0; d < Global::Diseases; d++) {
@@ -780,32 +1010,146 @@ void Epidemic::update(int day) {
 }
 
 void Epidemic::update_infectious_activities::operator() ( Person & person ) {
+  RNG_Stream stream( RNG_Stream::SCHEDULE, day, person.get_id(), disease_id );
+  infectivity_column[ person.get_pop_index() ] = person.get_infectivity( disease_id, day );
   person.get_activities()->update_infectious_activities( & person, day, disease_id );
 }
 
 void Epidemic::find_infectious_places( int day, int disease_id ) {
   FRED_STATUS(1, "find_infectious_places entered\n", "");
 
-  update_infectious_activities update_functor( day, disease_id );
+  infectivity_column.resize( Global::Pop.get_index_limit() );
+  update_infectious_activities update_functor( day, disease_id, infectivity_column );
   Global::Pop.parallel_masked_apply( fred::Infectious, update_functor );
 
   FRED_STATUS(1, "find_infectious_places finished\n", "");
 }
 
 void Epidemic::update_susceptible_activities::operator() ( Person & person ) {
+  RNG_Stream stream( RNG_Stream::SCHEDULE, day, person.get_id(), disease_id );
+  susceptibility_column[ person.get_pop_index() ] = person.get_susceptibility( disease_id );
   person.get_activities()->update_susceptible_activities( & person, day, disease_id );
 }
 
 void Epidemic::add_susceptibles_to_infectious_places(int day, int disease_id) {
   FRED_STATUS(1, "add_susceptibles_to_infectious_places entered\n");
 
-  update_susceptible_activities update_functor( day, disease_id );
-  Global::Pop.parallel_masked_apply( fred::Susceptible, update_functor );
+  susceptibility_column.resize( Global::Pop.get_index_limit() );
+  update_susceptible_activities update_functor( day, disease_id, susceptibility_column );
+  if ( Global::Enable_Push_Susceptibles ) {
+    mark_susceptible_visitors();
+    Global::Pop.parallel_masked_apply( fred::Susceptible_Visitor, update_functor );
+  }
+  else {
+    Global::Pop.parallel_masked_apply( fred::Susceptible, update_functor );
+  }
 
   FRED_STATUS(1, "add_susceptibles_to_infectious_places finished\n");
 }
 
+// Marks (with fred::Susceptible_Visitor) every susceptible person who could
+// join an infectious place today, so that only they need their schedules
+// updated: the enrollees of the infectious schools, classrooms, workplaces
+// and offices; the residents of every cell from which an infectious
+// neighborhood can be chosen (see Activities::update_schedule); and the
+// travelers, who visit their hosts' places without enrolling in them.
+// Households are left out since susceptibles never join them.
+void Epidemic::mark_susceptible_visitors() {
+  Global::Pop.clear_mask( fred::Susceptible_Visitor );
+
+  mark_susceptible_enrollees( inf_schools );
+  mark_susceptible_enrollees( inf_classrooms );
+  mark_susceptible_enrollees( inf_workplaces );
+  mark_susceptible_enrollees( inf_offices );
+
+  if ( inf_neighborhoods.size() > 0 ) {
+    if ( neighborhood_reach.empty() ) {
+      set_neighborhood_reach();
+    }
+    int rows = Global::Cells->get_rows();
+    int cols = Global::Cells->get_cols();
+    reachable_cells.assign( rows * cols, 0 );
+    marked_cells.clear();
+    for ( int i = 0; i < inf_neighborhoods.size(); ++i ) {
+      Cell * cell = inf_neighborhoods[ i ]->get_grid_cell();
+      for ( int k = 0; k < neighborhood_reach.size(); ++k ) {
+        int row = cell->get_row() + neighborhood_reach[ k ].first;
+        int col = cell->get_col() + neighborhood_reach[ k ].second;
+        if ( row < 0 || row >= rows || col < 0 || col >= cols
+            || reachable_cells[ row * cols + col ] ) {
+          continue;
+        }
+        reachable_cells[ row * cols + col ] = 1;
+        Cell * source = Global::Cells->get_grid_cell( row, col );
+        if ( source->get_houses() > 0 ) {
+          marked_cells.push_back( source );
+        }
+      }
+    }
+
+    #pragma omp parallel for schedule(dynamic,1)
+    for ( int i = 0; i < marked_cells.size(); ++i ) {
+      Cell * cell = marked_cells[ i ];
+      for ( int h = 0; h < cell->get_houses(); ++h ) {
+        Household * house = (Household *) cell->get_household( h );
+        for ( int j = 0; j < house->get_size(); ++j ) {
+          int index = house->get_housemate( j )->get_pop_index();
+          if ( Global::Pop.check_mask_by_index( fred::Susceptible, index ) ) {
+            Global::Pop.set_mask_by_index( fred::Susceptible_Visitor, index );
+          }
+        }
+      }
+    }
+  }
+
+  vector <Person *> travelers;
+  Travel::get_travelers( travelers );
+  for ( int i = 0; i < travelers.size(); ++i ) {
+    int index = travelers[ i ]->get_pop_index();
+    if ( Global::Pop.check_mask_by_index( fred::Susceptible, index ) ) {
+      Global::Pop.set_mask_by_index( fred::Susceptible_Visitor, index );
+    }
+  }
+
+  FRED_STATUS(1, "%d susceptible visitors of %d susceptibles\n",
+      Global::Pop.size( fred::Susceptible_Visitor ), Global::Pop.size( fred::Susceptible ));
+}
+
+void Epidemic::mark_susceptible_enrollees( vector <Place *> & places ) {
+  #pragma omp parallel for schedule(dynamic,10)
+  for ( int i = 0; i < places.size(); ++i ) {
+    const vector <Person *> & enrollees = places[ i ]->get_enrollees();
+    for ( int j = 0; j < enrollees.size(); ++j ) {
+      int index = enrollees[ j ]->get_pop_index();
+      if ( Global::Pop.check_mask_by_index( fred::Susceptible, index ) ) {
+        Global::Pop.set_mask_by_index( fred::Susceptible_Visitor, index );
+      }
+    }
+  }
+}
+
+// A resident of cell S visits a neighborhood in cell T if T is S or one of
+// its eight neighbors, or if T contains a point within Community_distance of
+// the center of S, which needs the centers of S and T to be no farther apart
+// than Community_distance plus half a cell diagonal.  This depends only on
+// the (row,col) offset from S to T, so the offsets are found once.
+void Epidemic::set_neighborhood_reach() {
+  double cell_size = Global::Cells->get_grid_cell_size();
+  double reach = Activities::get_community_distance() + cell_size * M_SQRT1_2;
+  int max_offset = 1 + (int) ( reach / cell_size );
+  neighborhood_reach.clear();
+  for ( int dr = -max_offset; dr <= max_offset; ++dr ) {
+    for ( int dc = -max_offset; dc <= max_offset; ++dc ) {
+      double distance = cell_size * sqrt( (double) ( dr * dr + dc * dc ) );
+      if ( ( abs( dr ) <= 1 && abs( dc ) <= 1 ) || distance <= reach ) {
+        neighborhood_reach.push_back( pair<int,int>( dr, dc ) );
+      }
+    }
+  }
+}
+
 void Epidemic::infectious_sampler::operator() ( Person & person ) {
+  RNG_Stream stream( RNG_Stream::SAMPLE, sample, person.get_id(), disease_id );
   if ( RANDOM() < prob ) {
     #pragma omp critical(EPIDEMIC_INFECTIOUS_SAMPLER)
     samples->push_back( &person );
@@ -819,6 +1163,11 @@ void Epidemic::get_infectious_samples(vector<Person *> &samples, double prob = 1
   infectious_sampler sampler;
   sampler.samples = &samples;
   sampler.prob = prob;
+  sampler.sample = infectious_sample_count++;
+  sampler.disease_id = id;
   Global::Pop.parallel_masked_apply( fred::Infectious, sampler );
+  if ( RNG::counter_streams ) {
+    sort( samples.begin(), samples.end(), Person::compare_id );
+  }
 }
 
@@ -23,6 +23,7 @@
 
 #include "Global.h"
 #include "Place.h"
+#include "Work_Stealing_Scheduler.h"
 
 
 #define SEED_USER 'U'
@@ -34,8 +35,10 @@ using namespace std;
 
 class Disease;
 class Person;
+class Cell;
 class Timestep_Map;
 class Multistrain_Timestep_Map;
+class Checkpoint;
 template < class T >
 class Tracker;
 //class Place;
@@ -75,6 +78,18 @@ public:
 
   void transmit(int day);
 
+  /**
+   * Report per-thread load of the transmission scheduler, if used
+   */
+  void end_of_run();
+
+  /**
+   * Write the counts and cohort statistics of this Epidemic to a checkpoint,
+   * or read them back (see Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   void become_susceptible(Person *person);
   void become_unsusceptible(Person *person);
   void become_exposed(Person *person);
@@ -87,6 +102,24 @@ public:
   void find_infectious_places(int day, int dis);
   void add_susceptibles_to_infectious_places(int day, int dis);
 
+  /**
+   * Today's infectivity of a person in an infectious place's visitor list,
+   * recorded by find_infectious_places
+   * @param person_index the person's population index
+   */
+  double get_infectivity(int person_index) const {
+    return infectivity_column[ person_index ];
+  }
+
+  /**
+   * Today's susceptibility of a person in an infectious place's visitor list,
+   * recorded by add_susceptibles_to_infectious_places
+   * @param person_index the person's population index
+   */
+  double get_susceptibility(int person_index) const {
+    return susceptibility_column[ person_index ];
+  }
+
   void increment_cohort_infectee_count(int cohort_day) {
     if ( cohort_day > 0 ) {
       assert( cohort_day < Global::Days );
@@ -95,6 +128,13 @@ public:
     }
   }
 
+  /**
+   * With counter streams (see RNG_Stream), a successful transmission found
+   * while places spread infection is held here and takes effect once all the
+   * places are done (see resolve_pending_transmissions)
+   */
+  void add_pending_transmission(Person * infector, Person * infectee, Place * place);
+
   void get_infectious_samples(int num_samples, vector<Person *> &samples);
   void get_infectious_samples(vector<Person *> &samples, double prob);
 
@@ -155,6 +195,40 @@ private:
   vector <Place *> inf_workplaces;
   vector <Place *> inf_offices;
 
+  // push-based susceptible sweep (see mark_susceptible_visitors)
+  void mark_susceptible_visitors();
+  void mark_susceptible_enrollees(vector <Place *> & places);
+  void set_neighborhood_reach();
+  vector < pair<int,int> > neighborhood_reach; // (row,col) offsets of cells whose residents may visit a neighborhood
+  vector <char> reachable_cells;
+  vector <Cell *> marked_cells;
+
+  // work-stealing transmission (see transmit_with_work_stealing)
+  void transmit_with_work_stealing(int day);
+  struct spread_task;
+  static const int HOUSEHOLDS_PER_TASK = 100;
+  Work_Stealing_Scheduler transmission_scheduler;
+  vector <Place *> spread_places;
+  vector <Place::Spread_Context> spread_contexts;
+
+  // transmission inputs by population index, written by the daily sweeps
+  // so that the spread loops read them without going through Health
+  vector <double> infectivity_column;
+  vector <double> susceptibility_column;
+
+  // transmissions held by add_pending_transmission, per thread
+  struct Pending_Transmission {
+    Person * infector;
+    Person * infectee;
+    Place * place;
+  };
+  State< vector <Pending_Transmission> > pending_transmissions;
+  static bool compare_pending_transmissions(const Pending_Transmission & t1,
+      const Pending_Transmission & t2);
+  void resolve_pending_transmissions(int day);
+  void sort_infectious_places();
+  int infectious_sample_count;
+
   State< Tracker<string>* > tracker_state;
 
   // population health state counters
@@ -202,17 +276,22 @@ private:
 
   struct update_susceptible_activities {
     int day, disease_id;
-    update_susceptible_activities( int _day, int _disease_id ) : day( _day ), disease_id( _disease_id ) { };
+    vector <double> & susceptibility_column;
+    update_susceptible_activities( int _day, int _disease_id, vector <double> & _column ) :
+      day( _day ), disease_id( _disease_id ), susceptibility_column( _column ) { };
     void operator() ( Person & p );
   };
 
   struct update_infectious_activities {
     int day, disease_id;
-    update_infectious_activities( int _day, int _disease_id ) : day( _day ), disease_id( _disease_id ) { };
+    vector <double> & infectivity_column;
+    update_infectious_activities( int _day, int _disease_id, vector <double> & _column ) :
+      day( _day ), disease_id( _disease_id ), infectivity_column( _column ) { };
     void operator() ( Person & p );
   };
 
   struct infectious_sampler {
+    int sample, disease_id;
     double prob;
     vector< Person * > * samples;
     void operator() ( Person & p );
@@ -0,0 +1,79 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Event_Calendar.cc
+//
+
+#include <algorithm>
+
+#include "Event_Calendar.h"
+#include "Checkpoint.h"
+
+using namespace std;
+
+void Event_Calendar::file_staged_events() {
+  for ( int t = 0; t < staged.size(); ++t ) {
+    vector< pair< int, int > > & events = staged( t );
+    for ( int i = 0; i < (int) events.size(); ++i ) {
+      int day = events[ i ].first;
+      if ( day >= (int) bucket.size() ) {
+        bucket.resize( day + 1 );
+      }
+      bucket[ day ].push_back( events[ i ].second );
+    }
+    events.clear();
+  }
+}
+
+void Event_Calendar::cancel( int day, int key ) {
+  file_staged_events();
+  if ( day < 0 || day >= (int) bucket.size() ) {
+    return;
+  }
+  vector< int > & events = bucket[ day ];
+  vector< int >::iterator itr = find( events.begin(), events.end(), key );
+  if ( itr != events.end() ) {
+    *itr = events.back();
+    events.pop_back();
+  }
+}
+
+void Event_Calendar::get_events( int day, vector< int > & events ) {
+  file_staged_events();
+  events.clear();
+  if ( day < 0 || day >= (int) bucket.size() ) {
+    return;
+  }
+  events.swap( bucket[ day ] );
+  vector< int >().swap( bucket[ day ] );
+  sort( events.begin(), events.end() );
+}
+
+void Event_Calendar::write_checkpoint( Checkpoint & checkpoint ) {
+  file_staged_events();
+  checkpoint.write_size( bucket.size() );
+  for ( size_t day = 0; day < bucket.size(); ++day ) {
+    checkpoint.write_vector( bucket[ day ] );
+  }
+}
+
+void Event_Calendar::read_checkpoint( Checkpoint & checkpoint ) {
+  for ( int t = 0; t < staged.size(); ++t ) {
+    staged( t ).clear();
+  }
+  bucket.clear();
+  bucket.resize( checkpoint.read_size() );
+  for ( size_t day = 0; day < bucket.size(); ++day ) {
+    checkpoint.read_vector( bucket[ day ] );
+  }
+}
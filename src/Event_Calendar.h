@@ -0,0 +1,70 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Event_Calendar.h
+//
+
+#ifndef _FRED_EVENT_CALENDAR_H
+#define _FRED_EVENT_CALENDAR_H
+
+#include <vector>
+#include <utility>
+
+#include "Global.h"
+#include "State.h"
+
+class Checkpoint;
+
+/*
+ * Events keyed by an int (a person's population index, for example), filed
+ * in a bucket for the simulation day they fall on, so that each day visits
+ * only that day's events instead of sweeping everyone who has one pending.
+ *
+ * Events can be scheduled from parallel sweeps: each thread stages its own,
+ * and the stages are filed into the day buckets when a day is read or an
+ * event is cancelled, which must be done serially.  A day's events are read
+ * in increasing order of key, the order of a sweep by population index.
+ */
+class Event_Calendar {
+
+public:
+
+  Event_Calendar() : staged( NCPU ) { }
+
+  /// thread safe
+  void schedule( int day, int key ) {
+    staged().push_back( std::pair< int, int >( day, key ) );
+  }
+
+  /// removes one event for key on day, if there is one
+  void cancel( int day, int key );
+
+  /// moves the events of day into events (which is cleared), sorted by key
+  void get_events( int day, std::vector< int > & events );
+
+  /// writes every pending event to a checkpoint, or reads them back
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
+
+private:
+
+  // (day, key) of the events scheduled by each thread since the last filing
+  State< std::vector< std::pair< int, int > > > staged;
+
+  // the events of each day
+  std::vector< std::vector< int > > bucket;
+
+  void file_staged_events();
+};
+
+#endif // _FRED_EVENT_CALENDAR_H
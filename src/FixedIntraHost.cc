@@ -80,7 +80,7 @@ Trajectory * FixedIntraHost::get_trajectory( Infection * infection, Transmission
 
   vector<double> symptomaticity = sympLibrary[index];
 
-  return new Trajectory(infectivities, symptomaticity);
+  return new Trajectory(Trajectory_Table::intern(infectivities, symptomaticity));
 }
 
 int FixedIntraHost::get_days_symp() {
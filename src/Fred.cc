@@ -28,13 +28,15 @@
 #include "Date.h"
 #include "Evolution.h"
 #include "Travel.h"
+#include "Disease.h"
 #include "Epidemic.h"
 #include "Seasonality.h"
 #include "Past_Infection.h"
 #include "Activities.h"
 #include "Behavior.h"
-#include "Tracker.h"
+#include "Census_Block_Tracker.h"
 #include "Report.h"
+#include "Checkpoint.h"
 #include "json.h"
 
 using nlohmann::json;
@@ -44,9 +46,177 @@ using nlohmann::json;
 #include <cstdlib>
 #include <cxxabi.h>
 
+/*
+ * Simulate the days from first_day to the end of the run, then finish up
+ * the run
+ */
+static void run_simulation(int run, int first_day, unsigned long new_seed, char * directory) {
+
+  time_t simulation_start_time;
+  Utils::fred_start_timer( &simulation_start_time );
+
+  for (int day = first_day; day < Global::Days; day++) {
+
+    Utils::fred_start_day_timer();
+    if (day == Global::Reseed_day) {
+      fprintf(Global::Statusfp, "************** reseed day = %d\n", day);
+      fflush(Global::Statusfp);
+      INIT_RANDOM(new_seed + run - 1);
+    }
+
+    if ( Date::match_pattern( Global::Sim_Current_Date, "01-01-*" ) ) {
+      if ( Global::Track_age_distribution ) {
+        Global::Pop.print_age_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+        Global::Places.print_household_size_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+      }
+      if ( Global::Track_household_distribution ) {
+        Global::Cells->print_household_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+      }
+    }
+
+    Global::Places.update(day);
+    Utils::fred_print_lap_time("day %d update places", day);
+
+    Global::Pop.update(day);
+    Utils::fred_print_lap_time("day %d update population", day);
+
+    Epidemic::update(day);
+    Utils::fred_print_lap_time("day %d update epidemics", day);
+
+    Global::Pop.report(day);
+    Utils::fred_print_lap_time("day %d report population", day);
+
+        // If Block Output is desired, update this
+     if(Global::Report_Epidemic_Data_By_Census_Block) {
+       Global::Block_Epi_Day_Tracker->reduce();
+       Global::Block_Epi_Day_Tracker->set_column(Census_Block_Tracker::DAY,day);
+       bool printHeader = false;
+       if(day == 0) printHeader=true;
+       Global::Block_Epi_Day_Tracker->output_csv_report_format(Global::BlockDayfp,printHeader);
+       Global::Block_Epi_Day_Tracker->set_column(Census_Block_Tracker::C,0);
+       Global::Block_Epi_Day_Tracker->set_column(Census_Block_Tracker::CS,0);
+       Global::Block_Epi_Day_Tracker->set_column(Census_Block_Tracker::V,0);
+       Global::Block_Epi_Day_Tracker->set_column(Census_Block_Tracker::AV,0);
+     }
+
+    // print GAIA data if desired
+    if (Global::Print_GAIA_Data && run == 1) {
+      Global::Small_Cells->print_gaia_data(directory, run, day);
+      Utils::fred_print_lap_time("day %d print_gaia_data", day);
+    }
+
+    if ( Global::Enable_Migration
+        && Date::match_pattern( Global::Sim_Current_Date, "02-*-*" ) ) {
+      Global::Cells->population_migration( day );
+    }
+    
+    if ( Global::Enable_Aging && Global::Verbose
+        && Date::match_pattern( Global::Sim_Current_Date, "12-31-*" ) ) {
+      Global::Pop.quality_control();
+    }
+
+    if (Date::match_pattern(Global::Sim_Current_Date, "01-01-*")) {
+      if (Global::Track_age_distribution) {
+        Global::Pop.print_age_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+        Global::Places.print_household_size_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+      }
+      if (Global::Track_household_distribution) {
+        Global::Cells->print_household_distribution(directory,
+            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
+      }
+    }
+
+    // incremental trace
+    if (Global::Incremental_Trace && day && !(day%Global::Incremental_Trace))
+      Global::Pop.print(1, day);
+
+    if (Global::Track_vaccine_infection_events) {
+        if (Global::Enable_Vaccination) {
+            Global::Pop.report_vaccine_infection_events(day);
+        }
+    }
+
+    #pragma omp parallel sections
+    {
+      #pragma omp section
+      {
+        // this refreshes all RNG buffers in a new thread team
+        RNG::refresh_all_buffers();
+      }
+      #pragma omp section
+      {
+        // flush infections file buffer
+        fflush(Global::Infectionfp);
+      }
+    }
+
+    Utils::fred_print_wall_time("day %d finished", day);
+
+    Utils::fred_print_day_timer(day);
+    Utils::fred_print_resource_usage(day);
+
+    Global::Sim_Current_Date->advance();
+
+    Global::Rpt.print();
+    Global::Rpt.clear();
+
+    if (Checkpoint::is_checkpoint_date()) {
+      Checkpoint::save_simulation(day + 1, run);
+      Utils::fred_print_lap_time("day %d checkpoint", day);
+    }
+  }
+ 
+  fflush(Global::Infectionfp);
+
+  Utils::fred_print_lap_time( &simulation_start_time,
+      "\nFRED simulation complete. Excluding initialization, %d days",
+      Global::Days);
+
+  // finish up
+  Global::Pop.end_of_run();
+  Global::Places.end_of_run();
+  for (int d = 0; d < Global::Diseases; d++) {
+    Global::Pop.get_disease(d)->get_epidemic()->end_of_run();
+  }
+}
+
+/*
+ * Record the parameters of the run in the event report
+ */
+static void append_parameters() {
+  json j;
+
+  j["event"] = "parameters";
+
+  for (int i = 0; i < Params::param_count; i++) {
+    j[Params::param_name[i]] = Params::param_value[i];
+  }
+
+  Global::Rpt.append(j);
+}
+
+/*
+ * The seed for a run: each run after the first has its own, unless the
+ * runs are to share the same start and part ways on reseed_day
+ */
+static unsigned long get_run_seed(int run) {
+  if (run > 1 && Global::Reseed_day == -1) {
+    return Global::Seed * 100 + (run-1);
+  } else {
+    return Global::Seed;
+  }
+}
+
 int main(int argc, char* argv[]) {
 
   int run;          // number of current run
+  int last_run;     // number of the last run of a batch
+  bool batch;       // are the runs a batch, sharing one set up?
   unsigned long new_seed;
   char directory[FRED_STRING_SIZE];
   char paramfile[FRED_STRING_SIZE];
@@ -78,6 +248,18 @@ int main(int argc, char* argv[]) {
     strcpy(directory, "");
   }
 
+  // read optional last run number from command line (must be 4th arg); the
+  // runs from run to last_run are a batch, made in turn from one set up
+  batch = (argc > 4);
+  if (batch) {
+    sscanf(argv[4], "%d", &last_run);
+  } else {
+    last_run = run;
+  }
+  if (last_run < run) {
+    last_run = run;
+  }
+
   // get runtime parameters
   Params::read_parameters(paramfile);
   Global::get_global_parameters();
@@ -85,6 +267,9 @@ int main(int argc, char* argv[]) {
   // get runtime population parameters
   Global::Pop.get_parameters();
 
+  // get checkpoint and restart parameters
+  Checkpoint::get_parameters();
+
   // initialize masks in Global::Pop
   Global::Pop.initialize_masks();
 
@@ -107,6 +292,7 @@ int main(int argc, char* argv[]) {
   Utils::fred_open_output_files(directory, run);
 
   // initialize RNG
+  RNG::use_counter_streams(Global::Enable_Counter_RNG);
   INIT_RANDOM(Global::Seed);
 
   // Date Setup
@@ -121,11 +307,18 @@ int main(int argc, char* argv[]) {
     Global::Sim_Current_Date->advance((run-1)%7);
   }
 
-  // set random number seed based on run number
-  if (run > 1 && Global::Reseed_day == -1) {
-    new_seed = Global::Seed * 100 + (run-1);
-  } else {
+  // set random number seed based on run number; a batch is set up from
+  // the base seed, and each of its runs starts from its own seed
+  if (batch) {
+    if (Global::Rotate_start_date) {
+      Utils::fred_abort("A batch of runs can't rotate the start date\n");
+    }
+    if (Checkpoint::is_restart()) {
+      Utils::fred_abort("A batch of runs can't be restarted from a checkpoint\n");
+    }
     new_seed = Global::Seed;
+  } else {
+    new_seed = get_run_seed(run);
   }
   fprintf(Global::Statusfp, "seed = %lu\n", new_seed);
   INIT_RANDOM(new_seed);
@@ -162,7 +355,7 @@ int main(int argc, char* argv[]) {
   Utils::fred_print_lap_time("Pop.setup");
 
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Global::Block_Epi_Day_Tracker = new Tracker<string>("Census Day Block String Tracker","BlockGroup");
+    Global::Block_Epi_Day_Tracker = new Census_Block_Tracker("BlockGroup");
     Global::Pop.initialize_disease_state_counts_by_block(); 
   }
   // define FRED-specific places and have each person enroll as needed
@@ -188,6 +381,7 @@ int main(int argc, char* argv[]) {
 
   // record the favorite places for households within each grid cell
   Global::Cells->record_favorite_places();
+  Global::Cells->setup_spatial_index(Activities::get_community_distance());
   Utils::fred_print_lap_time("place prep");
 
   if (Global::Enable_Travel) {
@@ -244,141 +438,44 @@ int main(int argc, char* argv[]) {
 
   Global::Rpt.setup();
 
-  json j;
-
-  j["event"] = "parameters";
-
-  for (int i = 0; i < Params::param_count; i++) {
-    j[Params::param_name[i]] = Params::param_value[i];
+  // a restarted run picks up the state (and output) of the run that
+  // wrote the checkpoint, and goes on from the next day
+  int first_day = 0;
+  if (Checkpoint::is_restart()) {
+    first_day = Checkpoint::restore_simulation(new_seed);
+    Utils::fred_print_lap_time("restore from checkpoint");
+  }
+  else if (!batch) {
+    append_parameters();
   }
- 
-  Global::Rpt.append(j);
-
-  time_t simulation_start_time;
-  Utils::fred_start_timer( &simulation_start_time );
-
-  for (int day = 0; day < Global::Days; day++) {
-
-    Utils::fred_start_day_timer();
-    if (day == Global::Reseed_day) {
-      fprintf(Global::Statusfp, "************** reseed day = %d\n", day);
-      fflush(Global::Statusfp);
-      INIT_RANDOM(new_seed + run - 1);
-    }
-
-    if ( Date::match_pattern( Global::Sim_Current_Date, "01-01-*" ) ) {
-      if ( Global::Track_age_distribution ) {
-        Global::Pop.print_age_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-        Global::Places.print_household_size_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-      }
-      if ( Global::Track_household_distribution ) {
-        Global::Cells->print_household_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-      }
-    }
-
-    Global::Places.update(day);
-    Utils::fred_print_lap_time("day %d update places", day);
-
-    Global::Pop.update(day);
-    Utils::fred_print_lap_time("day %d update population", day);
-
-    Epidemic::update(day);
-    Utils::fred_print_lap_time("day %d update epidemics", day);
-
-    Global::Pop.report(day);
-    Utils::fred_print_lap_time("day %d report population", day);
-
-        // If Block Output is desired, update this
-     if(Global::Report_Epidemic_Data_By_Census_Block) {
-       Global::Block_Epi_Day_Tracker->set_all_index_for_key("Day",day);
-       bool printHeader = false;
-       if(day == 0) printHeader=true;
-       Global::Block_Epi_Day_Tracker->output_csv_report_format(Global::BlockDayfp,printHeader);
-       Global::Block_Epi_Day_Tracker->set_all_index_for_key("C",int(0));
-       Global::Block_Epi_Day_Tracker->set_all_index_for_key("Cs",int(0));
-       Global::Block_Epi_Day_Tracker->set_all_index_for_key("V",int(0));
-       Global::Block_Epi_Day_Tracker->set_all_index_for_key("Av",int(0));
-     }
-
-    // print GAIA data if desired
-    if (Global::Print_GAIA_Data && run == 1) {
-      Global::Small_Cells->print_gaia_data(directory, run, day);
-      Utils::fred_print_lap_time("day %d print_gaia_data", day);
-    }
-
-    if ( Global::Enable_Migration
-        && Date::match_pattern( Global::Sim_Current_Date, "02-*-*" ) ) {
-      Global::Cells->population_migration( day );
-    }
-    
-    if ( Global::Enable_Aging && Global::Verbose
-        && Date::match_pattern( Global::Sim_Current_Date, "12-31-*" ) ) {
-      Global::Pop.quality_control();
-    }
-
-    if (Date::match_pattern(Global::Sim_Current_Date, "01-01-*")) {
-      if (Global::Track_age_distribution) {
-        Global::Pop.print_age_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-        Global::Places.print_household_size_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-      }
-      if (Global::Track_household_distribution) {
-        Global::Cells->print_household_distribution(directory,
-            (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str(), run);
-      }
-    }
-
-    // incremental trace
-    if (Global::Incremental_Trace && day && !(day%Global::Incremental_Trace))
-      Global::Pop.print(1, day);
 
-    if (Global::Track_vaccine_infection_events) {
-        if (Global::Enable_Vaccination) {
-            Global::Pop.report_vaccine_infection_events(day);
-        }
-    }
+  // the state after set up, to which each later run of a batch goes back
+  Checkpoint initial_state;
+  if (batch && last_run > run) {
+    Checkpoint::write_state(initial_state, first_day);
+  }
 
-    #pragma omp parallel sections
-    {
-      #pragma omp section
-      {
-        // this refreshes all RNG buffers in a new thread team
-        RNG::refresh_all_buffers();
-      }
-      #pragma omp section
-      {
-        // flush infections file buffer
-        fflush(Global::Infectionfp);
+  for (int this_run = run; this_run <= last_run; this_run++) {
+    if (batch) {
+      if (this_run > run) {
+        Utils::fred_close_output_files();
+        Utils::fred_open_output_files(directory, this_run);
+        initial_state.rewind();
+        Checkpoint::read_state(initial_state);
+        Utils::fred_print_lap_time("reset for run %d", this_run);
       }
+      new_seed = get_run_seed(this_run);
+      fprintf(Global::Statusfp, "run %d seed = %lu\n", this_run, new_seed);
+      INIT_RANDOM(new_seed);
+      append_parameters();
     }
-
-    Utils::fred_print_wall_time("day %d finished", day);
-
-    Utils::fred_print_day_timer(day);
-    Utils::fred_print_resource_usage(day);
-
-    Global::Sim_Current_Date->advance();
-
-    Global::Rpt.print();
-    Global::Rpt.clear();
+    run_simulation(this_run, first_day, new_seed, directory);
   }
- 
-  fflush(Global::Infectionfp);
-
-  Utils::fred_print_lap_time( &simulation_start_time,
-      "\nFRED simulation complete. Excluding initialization, %d days",
-      Global::Days);
 
   Utils::fred_print_wall_time("FRED finished");
   Utils::fred_print_finish_timer();
 
-  // finish up
-  Global::Pop.end_of_run();
-  Global::Places.end_of_run();
+  Params::report_usage(Global::Statusfp);
 
   // close all open output files with global file pointers
   Utils::fred_end();
@@ -24,13 +24,14 @@
 #include "Small_Grid.h"
 #include "Seasonality.h"
 #include "Utils.h"
-#include "Tracker.h"
+#include "Census_Block_Tracker.h"
 #include "Report.h"
 
 // global runtime parameters
 char Global::Synthetic_population_directory[FRED_STRING_SIZE];
 char Global::Synthetic_population_id[FRED_STRING_SIZE];
 char Global::Synthetic_population_version[FRED_STRING_SIZE];
+char Global::Population_snapshot_file[FRED_STRING_SIZE];
 char Global::Output_directory[FRED_STRING_SIZE];
 char Global::Tracefilebase[FRED_STRING_SIZE];
 char Global::VaccineTracefilebase[FRED_STRING_SIZE];
@@ -97,6 +98,13 @@ bool Global::Report_Distance_Of_Infection = false;
 bool Global::Report_Presenteeism = false;
 bool Global::Assign_Teachers = false;
 int Global::Print_GAIA_Data = 0;
+bool Global::Enable_Lock_Free_Staging = false;
+bool Global::Enable_Skip_Ahead_Transmission = false;
+int Global::Skip_Ahead_Min_Place_Size = 0;
+bool Global::Enable_Work_Stealing = false;
+int Global::Work_Stealing_Infectors_Per_Task = 0;
+bool Global::Enable_Push_Susceptibles = false;
+bool Global::Enable_Counter_RNG = false;
 
 // per-strain immunity reporting off by default
 // will be enabled in Utils::fred_open_output_files (called from Fred.cc)
@@ -113,8 +121,9 @@ Date *Global::Sim_Start_Date = NULL;
 Date *Global::Sim_Current_Date = NULL;
 Evolution *Global::Evol = NULL;
 Seasonality * Global::Clim = NULL;
-Tracker<std::string> * Global::Block_Epi_Day_Tracker = NULL;
+Census_Block_Tracker * Global::Block_Epi_Day_Tracker = NULL;
 Report Global::Rpt;
+Population_Snapshot *Global::Pop_Snapshot = NULL;
 
 // global file pointers
 FILE *Global::Statusfp = NULL;
@@ -207,6 +216,18 @@ void Global::get_global_parameters() {
   Global::Assign_Teachers = temp_int;
   Params::get_param_from_string("report_epidemic_data_by_census_block", &temp_int);
   Global::Report_Epidemic_Data_By_Census_Block = (temp_int == 0 ? false : true);
+  Params::get_param_from_string("enable_lock_free_staging", &temp_int);
+  Global::Enable_Lock_Free_Staging = temp_int;
+  Params::get_param_from_string("enable_skip_ahead_transmission", &temp_int);
+  Global::Enable_Skip_Ahead_Transmission = temp_int;
+  Params::get_param_from_string("skip_ahead_min_place_size", &Global::Skip_Ahead_Min_Place_Size);
+  Params::get_param_from_string("enable_work_stealing", &temp_int);
+  Global::Enable_Work_Stealing = temp_int;
+  Params::get_param_from_string("work_stealing_infectors_per_task", &Global::Work_Stealing_Infectors_Per_Task);
+  Params::get_param_from_string("enable_push_susceptibles", &temp_int);
+  Global::Enable_Push_Susceptibles = temp_int;
+  Params::get_param_from_string("enable_counter_rng", &temp_int);
+  Global::Enable_Counter_RNG = temp_int;
   // GAIA params
   Params::get_param_from_string("print_gaia_data",&Global::Print_GAIA_Data);
   if (Global::Print_GAIA_Data) Global::Enable_Small_Grid = true;
@@ -226,5 +247,8 @@ void Global::get_global_parameters() {
   if ( Global::Diseases > Global::MAX_NUM_DISEASES ) {
     Utils::fred_abort("Global::Diseases > Global::MAX_NUM_DISEASES!");
   }
+  if ( Global::Enable_Work_Stealing && Global::Work_Stealing_Infectors_Per_Task < 1 ) {
+    Utils::fred_abort("work_stealing_infectors_per_task must be at least 1!");
+  }
 }
 
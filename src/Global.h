@@ -25,6 +25,12 @@
 #include <map>
 #include <string>
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include <sys/time.h>
+#endif
+
 // for unit testing, use the line in Makefile: gcc -DUNITTEST ...
 #ifdef UNITTEST
 #define UNIT_TEST_VIRTUAL virtual
@@ -55,7 +61,9 @@ class Evolution;
 class Seasonality;
 template < class T>
 class Tracker;
+class Census_Block_Tracker;
 class Report;
+class Population_Snapshot;
 
 /**
  * This class contains the static variables used by the FRED program.  The variables all have public access,
@@ -156,6 +164,7 @@ class Global {
     static char Synthetic_population_directory[];
     static char Synthetic_population_id[];
     static char Synthetic_population_version[];
+    static char Population_snapshot_file[];
     static char Population_directory[];
     static char Output_directory[];
     static char Tracefilebase[];
@@ -226,6 +235,13 @@ class Global {
     static bool Report_Presenteeism;
     static bool Assign_Teachers;
     static int Print_GAIA_Data;
+    static bool Enable_Lock_Free_Staging;
+    static bool Enable_Skip_Ahead_Transmission;
+    static int Skip_Ahead_Min_Place_Size;
+    static bool Enable_Work_Stealing;
+    static int Work_Stealing_Infectors_Per_Task;
+    static bool Enable_Push_Susceptibles;
+    static bool Enable_Counter_RNG;
 
     // global singleton objects
     static Population Pop;
@@ -238,7 +254,8 @@ class Global {
     static Evolution *Evol;
     static Seasonality *Clim;
     static Report Rpt;
-static Tracker<std::string> *Block_Epi_Day_Tracker;
+    static Population_Snapshot *Pop_Snapshot;
+static Census_Block_Tracker *Block_Epi_Day_Tracker;
 
     // global file pointers
     static FILE *Statusfp;
@@ -308,6 +325,22 @@ namespace fred {
     bool any() const { return bits > 0; }
     bool none() const { return bits == 0; }
     bool test( int pos ) const { return bits & ( (BitType) 1 << pos ); } 
+    // sets the bit atomically and returns whether it was set before, so that
+    // of several threads setting the same bit exactly one sees false
+    bool test_and_set( int pos ) {
+      BitType mask = (BitType) 1 << pos;
+      #ifdef __GNUC__
+      return __sync_fetch_and_or( &bits, mask ) & mask;
+      #else
+      BitType old;
+      #pragma omp critical(FRED_TINY_BITSET_TEST_AND_SET)
+      {
+        old = bits;
+        bits |= mask;
+      }
+      return old & mask;
+      #endif
+    }
   };
 
 
@@ -329,9 +362,15 @@ namespace fred {
   enum Pop_Masks {
     Infectious = 'I',
     Susceptible = 'S',
-    Update_Deaths = 'D',
-    Update_Births = 'B',
-    Update_Health = 'H'
+    Update_Health = 'H',
+    Susceptible_Visitor = 'V',
+    // set when a person becomes symptomatic; cleared lazily by AV_Manager
+    Symptomatic = 'Y',
+    // set at a person's first dose of a vaccine, or first course of an antiviral
+    Takes_Vaccine = 'T',
+    Takes_AV = 'A',
+    // set for each person who makes their own health decisions (see Behavior)
+    Decision_Maker = 'D'
   };
 
   ////////////////////// OpenMP Utilities
@@ -339,7 +378,11 @@ namespace fred {
 
   #ifdef _OPENMP
   
-  #include <omp.h>
+  using ::omp_get_max_threads;
+  using ::omp_get_num_threads;
+  using ::omp_get_thread_num;
+  using ::omp_get_wtime;
+
   struct Mutex {
     Mutex()   { omp_init_lock( & lock ); }
     ~Mutex()  { omp_destroy_lock( & lock ); }
@@ -370,6 +413,12 @@ namespace fred {
   static int omp_get_thread_num() {
     return 0;
   }
+
+  static double omp_get_wtime() {
+    struct timeval tv;
+    gettimeofday( & tv, NULL );
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+  }
   #endif
 
 
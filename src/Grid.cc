@@ -32,6 +32,7 @@ using namespace std;
 #include "Population.h"
 #include "Date.h"
 #include "Large_Grid.h"
+#include "Checkpoint.h"
 
 Grid::Grid(Large_Grid * lgrid) {
   large_grid = lgrid;
@@ -48,6 +49,7 @@ Grid::Grid(Large_Grid * lgrid) {
   max_y = large_grid->get_max_y();
 
   get_parameters();
+  community_distance = -1.0;
 
   // find the multiple to use in defining this grid;
   // the multiple must be an integer
@@ -133,6 +135,26 @@ Cell * Grid::select_random_grid_cell(double x0, double y0, double dist) {
 }
 
 
+Cell * Grid::select_random_grid_cell(int row, int col, double dist) {
+  if (dist != community_distance) {
+    return select_random_grid_cell(grid[row][col].get_center_x(), grid[row][col].get_center_y(), dist);
+  }
+  // each draw of an offset stands for one attempt of the polar draw
+  for (int i = 0; i < 20; i++) {
+    const pair<int,int> & offset = community_offsets[community_table.draw()];
+    int r = row + offset.first;
+    int c = col + offset.second;
+    // get_row and get_col truncate toward zero, so points less than one
+    // cell below or left of the grid fall in row or column 0
+    if (r == -1) r = 0;
+    if (c == -1) c = 0;
+    Cell * cell = get_grid_cell(r,c);
+    if (cell != NULL) return cell;
+  }
+  return NULL;
+}
+
+
 Cell * Grid::select_random_grid_cell() {
   int row = IRAND(0, rows-1);
   int col = IRAND(0, cols-1);
@@ -291,37 +313,85 @@ void Grid::record_favorite_places() {
 vector < Place * >  Grid::get_households_by_distance(fred::geo lat, fred::geo lon, double radius_in_km) {
   double px = Geo_Utils::get_x(lon);
   double py = Geo_Utils::get_y(lat);
-  //  get cells around the point, make sure their rows & cols are in bounds
-  int r1 = rows-1 - (int) ( ( py + radius_in_km ) / grid_cell_size );
-  r1 = ( r1 >= 0 ) ? r1 : 0;
-  int r2 = rows-1 - (int) ( ( py - radius_in_km ) / grid_cell_size );
-  r2 = ( r2 <= rows-1 ) ? r2 : rows-1;
-
-  int c1 = (int) ( ( px - radius_in_km ) / grid_cell_size );
-  c1 = ( c1 >= 0 ) ? c1 : 0;
-  int c2 = (int) ( ( px + radius_in_km ) / grid_cell_size );
-  c2 = ( c2 <= cols-1 ) ? c2 : cols-1;
-
-  //printf("DEBUG: r1 %d r2 %d c1 %d c2 %d\n", r1,r2,c1,c2);
-  vector <Place *> households; // store all households in cells ovelapping the radius
-
-  for (int r = r1; r <= r2; r++ ) {
-    for (int c = c1; c <= c2; c++ ) {
-      Cell * p = get_grid_cell(r,c);
-      vector <Place *> h = p->get_households();
-      for (vector <Place *>::iterator hi = h.begin(); hi != h.end(); hi++) { 
-        fred::geo hlat = (*hi)->get_latitude();
-        fred::geo hlon = (*hi)->get_longitude();
-        //printf("DEBUG: household_latitude %f, household_longitude %f\n",hlat,hlon);
-        double hx = Geo_Utils::get_x(hlon);
-        double hy = Geo_Utils::get_y(hlat);
-        if (sqrt((px-hx)*(px-hx)+(py-hy)*(py-hy)) <= radius_in_km) {
-          households.push_back((*hi));
-        }
+  vector <int> found;
+  household_index.get_within_distance(px, py, radius_in_km, found);
+  vector <Place *> households;
+  households.reserve(found.size());
+  for (int i = 0; i < (int) found.size(); i++) {
+    households.push_back(indexed_households[found[i]]);
+  }
+  return households;
+}
+
+vector < Place * >  Grid::get_nearest_households(fred::geo lat, fred::geo lon, int k) {
+  double px = Geo_Utils::get_x(lon);
+  double py = Geo_Utils::get_y(lat);
+  vector <int> found;
+  household_index.get_nearest(px, py, k, found);
+  vector <Place *> households;
+  households.reserve(found.size());
+  for (int i = 0; i < (int) found.size(); i++) {
+    households.push_back(indexed_households[found[i]]);
+  }
+  return households;
+}
+
+void Grid::setup_spatial_index(double dist) {
+  indexed_households.clear();
+  vector <double> x;
+  vector <double> y;
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      const vector <Place *> & h = grid[row][col].get_households();
+      for (int i = 0; i < (int) h.size(); i++) {
+        indexed_households.push_back(h[i]);
+        x.push_back(Geo_Utils::get_x(h[i]->get_longitude()));
+        y.push_back(Geo_Utils::get_y(h[i]->get_latitude()));
       }
     }
   }
-  return households;
+  household_index.build(rows, cols, min_x, min_y, grid_cell_size, x, y);
+  setup_community_table(dist);
+}
+
+// select_random_grid_cell(x0, y0, dist) draws a distance uniform on
+// [0,dist] and an angle uniform on [0,360), and takes the cell under the
+// point.  From a cell center, the (row,col) offset of that cell has the
+// same distribution for every cell, so it is tabulated once, by a midpoint
+// rule over distance and angle.
+void Grid::setup_community_table(double dist) {
+  const int distance_steps = 1000;
+  const int angle_steps = 3600;
+  int reach = 1 + (int) (dist / grid_cell_size);
+  int width = 2 * reach + 1;
+  vector <double> mass(width * width, 0.0);
+  vector <double> cosine(angle_steps);
+  vector <double> sine(angle_steps);
+  for (int j = 0; j < angle_steps; j++) {
+    double ang = 2.0 * M_PI * (j + 0.5) / angle_steps;
+    cosine[j] = cos(ang);
+    sine[j] = sin(ang);
+  }
+  for (int i = 0; i < distance_steps; i++) {
+    double r = dist * (i + 0.5) / distance_steps / grid_cell_size;
+    for (int j = 0; j < angle_steps; j++) {
+      int dc = (int) floor(0.5 + r * cosine[j]);
+      int dr = (int) floor(0.5 + r * sine[j]);
+      mass[(dr + reach) * width + (dc + reach)] += 1.0;
+    }
+  }
+  community_offsets.clear();
+  vector <double> pdf;
+  for (int k = 0; k < width * width; k++) {
+    if (mass[k] > 0.0) {
+      community_offsets.push_back(pair<int,int>(k / width - reach, k % width - reach));
+      pdf.push_back(mass[k]);
+    }
+  }
+  community_table.build(&pdf[0], (int) pdf.size());
+  community_distance = dist;
+  FRED_VERBOSE(1, "community table: %d cell offsets within %f km\n",
+      (int) community_offsets.size(), dist);
 }
 
 
@@ -429,3 +499,13 @@ void Grid::print_household_distribution(char * dir, char * date_string, int run)
   }
   fclose(fp);
 }
+
+void Grid::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("grid");
+  checkpoint.write_places(vacant_houses);
+}
+
+void Grid::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("grid");
+  checkpoint.read_places(vacant_houses);
+}
@@ -18,11 +18,15 @@
 #define _FRED_GRID_H
 
 #include <string.h>
+#include <utility>
 #include "Place.h"
 #include "Abstract_Grid.h"
+#include "Random.h"
+#include "Spatial_Index.h"
 class Large_Grid;
 class Cell;
 class Neighborhood;
+class Checkpoint;
 
 class Grid : public Abstract_Grid {
 public:
@@ -54,6 +58,15 @@ public:
   Cell * get_grid_cell(int row, int col);
   Cell * get_grid_cell(fred::geo lat, fred::geo lon);
   Cell * select_random_grid_cell(double x0, double y0, double dist);
+
+  /**
+   * Select a random cell within dist of the center of the cell at row and col,
+   * with the same distribution as select_random_grid_cell(x0, y0, dist).  Uses
+   * the precomputed community table when dist is the community distance.
+   *
+   * @return the selected Cell, or NULL if the draws keep falling off the grid
+   */
+  Cell * select_random_grid_cell(int row, int col, double dist);
   Cell * select_random_neighbor(int row, int col);
 
   /**
@@ -82,6 +95,22 @@ public:
    */
   vector < Place * > get_households_by_distance(fred::geo lat, fred::geo lon, double radius_in_km);
 
+  /**
+   * @param lat the latitude of the point
+   * @param lon the longitude of the point
+   * @param k the number of households wanted
+   * @return the k households nearest to the point, nearest first
+   */
+  vector < Place * > get_nearest_households(fred::geo lat, fred::geo lon, int k);
+
+  /**
+   * Index the households of all cells by location, and tabulate the cells
+   * reached by select_random_grid_cell from a cell center.
+   *
+   * @param community_distance the distance used by Cell::select_neighborhood
+   */
+  void setup_spatial_index(double community_distance);
+
   // Specific to Cell grid:
   /**
    * Make each Cell in this Grid store its favorite places, and then set target_popsize and target_households
@@ -122,6 +151,12 @@ public:
    */
   void population_migration(int day);
 
+  /**
+   * Write the vacant houses to a checkpoint, or read them back (see Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Write the household distributions to a file
    *
@@ -144,8 +179,20 @@ protected:
   int target_pop_age[100];
   vector <Place *> vacant_houses;
 
+  // households of all cells, in cell order, indexed by location
+  Spatial_Index household_index;
+  vector <Place *> indexed_households;
+
+  // (row,col) offsets of the cells hit by one polar draw within
+  // community_distance of a cell center, and a table of their probabilities
+  double community_distance;
+  vector < pair<int,int> > community_offsets;
+  Alias_Table community_table;
+
 private:
 
+  void setup_community_table(double dist);
+
   /**
    * Set the emigrants for a given day
    *
@@ -36,8 +36,9 @@
 #include "Transmission.h"
 #include "Past_Infection.h"
 #include "Utils.h"
-#include "Tracker.h"
+#include "Census_Block_Tracker.h"
 #include "Household.h"
+#include "Checkpoint.h"
 
 int Health::nantivirals = -1; 
 char dummy_label[8];
@@ -50,25 +51,26 @@ enum {
 };
 
 void Health::setup ( Person * person ) {
-  alive = true;
+  hot = Global::Pop.get_health_hot_state( person->get_pop_index() );
+  hot->alive = true;
   intervention_flags = intervention_flags_type();
   // infection pointers stored in statically allocated array (length of which
   // is determined by static constant Global::MAX_NUM_DISEASES)
-  active_infections = fred::disease_bitset();
-  susceptible = fred::disease_bitset();
-  infectious = fred::disease_bitset();
-  symptomatic = fred::disease_bitset();
-  recovered_today = fred::disease_bitset();
-  evaluate_susceptibility = fred::disease_bitset();
+  hot->active_infections = fred::disease_bitset();
+  hot->susceptible = fred::disease_bitset();
+  hot->infectious = fred::disease_bitset();
+  hot->symptomatic = fred::disease_bitset();
+  hot->recovered_today = fred::disease_bitset();
+  hot->evaluate_susceptibility = fred::disease_bitset();
   immunity = fred::disease_bitset(); 
   // Determines if the agent is at risk
   at_risk = fred::disease_bitset();
 
   for (int disease_id = 0; disease_id < Global::Diseases; disease_id++) {
-    infection[ disease_id ] = NULL;
+    hot->infection[ disease_id ] = NULL;
     infectee_count[ disease_id ] = 0;
-    susceptibility_multp[ disease_id ] = 1.0; 
-    susceptible_date[ disease_id ] = -1;
+    hot->susceptibility_multp[ disease_id ] = 1.0; 
+    hot->susceptible_date[ disease_id ] = -1;
     become_susceptible( person, disease_id );
     Disease * disease = Global::Pop.get_disease(disease_id);
     if ( !disease->get_at_risk()->is_empty() ) {
@@ -91,7 +93,8 @@ void Health::setup ( Person * person ) {
 Health::~Health() {
   // delete Infection objects pointed to
   for (size_t i = 0; i < Global::Diseases; ++i) {
-    delete infection[i];
+    delete hot->infection[i];
+    hot->infection[i] = NULL;
   }
 
   if ( vaccine_health ) {
@@ -116,12 +119,12 @@ Health::~Health() {
 }
 
 void Health::become_susceptible( Person * self, int disease_id ) {
-  if (susceptible.test( disease_id ) )
+  if (hot->susceptible.test( disease_id ) )
     return;
-  assert( !(active_infections.test( disease_id ) ) );
-  susceptibility_multp[disease_id] = 1.0;
-  susceptible.set( disease_id );
-  evaluate_susceptibility.reset( disease_id ); 
+  assert( !(hot->active_infections.test( disease_id ) ) );
+  hot->susceptibility_multp[disease_id] = 1.0;
+  hot->susceptible.set( disease_id );
+  hot->evaluate_susceptibility.reset( disease_id ); 
   Disease * disease = Global::Pop.get_disease(disease_id);
   disease->become_susceptible( self );
   FRED_STATUS( 1, "person %d is now SUSCEPTIBLE for disease %d\n", self->get_id(), disease_id );
@@ -133,18 +136,19 @@ void Health::become_susceptible( Person * self, Disease * disease ) {
 
 void Health::become_exposed( Person * self, Disease *disease, Transmission & transmission ) {
   int disease_id = disease->get_id();
-  infectious.reset( disease_id );
-  symptomatic.reset(disease_id);
+  hot->infectious.reset( disease_id );
+  hot->symptomatic.reset(disease_id);
  
-  Infection *new_infection = disease->get_evolution()->transmit(infection[disease_id], transmission, self );
+  Infection *new_infection = disease->get_evolution()->transmit(hot->infection[disease_id], transmission, self );
   if ( new_infection != NULL ) { // Transmission succeeded
-    active_infections.set( disease_id );
-    if ( infection[ disease_id ] == NULL){
+    hot->active_infections.set( disease_id );
+    if ( hot->infection[ disease_id ] == NULL){
       self->become_unsusceptible( disease );
       disease->become_exposed( self );
     }
-    infection[disease_id] = new_infection;
-    susceptible_date[disease_id] = -1;
+    hot->infection[disease_id] = new_infection;
+    hot->susceptible_date[disease_id] = -1;
+    refresh_infection_dates( disease_id );
     if (Global::Verbose > 1) {
       if ( !( transmission.get_infected_place() ) ) {
         FRED_STATUS( 1, "SEEDED person %d with disease %d\n", self->get_id(), disease->get_id() );
@@ -154,97 +158,92 @@ void Health::become_exposed( Person * self, Disease *disease, Transmission & tra
       }
     }
     if(Global::Report_Epidemic_Data_By_Census_Block) {
-      Household *house = (Household *) self->get_household();
-      string block = house->get_census_block();
-      Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"S",int(-1));
-      Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"C",int(1));
-      Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"E",int(1));
+      int block = ((Household *) self->get_household())->get_census_block_index();
+      Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::S,-1);
+      Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::C,1);
+      Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::E,1);
     }
   }
 }
 
 void Health::become_unsusceptible( Person * self, Disease * disease ) {
   int disease_id = disease->get_id();
-  if (susceptible.test( disease_id ) == false)
+  if (hot->susceptible.test( disease_id ) == false)
     return;
-  susceptible.reset( disease_id );
+  hot->susceptible.reset( disease_id );
   disease->become_unsusceptible(self);
   FRED_STATUS( 1, "person %d is now UNSUSCEPTIBLE for disease %d\n", self->get_id(), disease_id );
 }
 
 void Health::become_infectious( Person * self, Disease * disease ) {
   int disease_id = disease->get_id();
-  assert(active_infections.test( disease_id ) );
-  infectious.set( disease_id );
+  assert(hot->active_infections.test( disease_id ) );
+  hot->infectious.set( disease_id );
   disease->become_infectious(self);
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Household *house = (Household *) self->get_household();
-    string block = house->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"E",int(-1));
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"I",int(1));
+    int block = ((Household *) self->get_household())->get_census_block_index();
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::E,-1);
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::I,1);
   }
   FRED_STATUS( 1, "person %d is now INFECTIOUS for disease %d\n", self->get_id(), disease_id);
 }
 
 void Health::become_symptomatic( Person * self, Disease * disease ) {
   int disease_id = disease->get_id();
-  assert(active_infections.test( disease_id ) );
-  if (symptomatic.test( disease_id ) )
+  assert(hot->active_infections.test( disease_id ) );
+  if (hot->symptomatic.test( disease_id ) )
     return;
-  symptomatic.set( disease_id );
+  hot->symptomatic.set( disease_id );
   disease->become_symptomatic(self);
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Household *house = (Household *) self->get_household();
-    string block = house->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"Cs",int(1));
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"Is",int(1));
+    int block = ((Household *) self->get_household())->get_census_block_index();
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::CS,1);
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::IS,1);
   }
   FRED_STATUS( 1, "person %d is now SYMPTOMATIC for disease %d\n", self->get_id(), disease_id );
 }
 
 void Health::recover( Person * self, Disease * disease ) {
   int disease_id = disease->get_id();
-  assert( active_infections.test( disease_id ) );
+  assert( hot->active_infections.test( disease_id ) );
   FRED_STATUS( 1, "person %d is now RECOVERED for disease %d\n", self->get_id(), disease_id );
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Household *house = (Household *) self->get_household();
-    string block = house->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"I",int(-1));
-    if(self->is_symptomatic()) Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"Is",int(-1));
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"R",int(1));
+    int block = ((Household *) self->get_household())->get_census_block_index();
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::I,-1);
+    if(self->is_symptomatic()) Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::IS,-1);
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::R,1);
   }
   become_removed( self, disease_id );
-  recovered_today.set( disease_id );
+  hot->recovered_today.set( disease_id );
   
 }
 
 void Health::become_removed( Person * self, int disease_id ) {
   Disease * disease = Global::Pop.get_disease(disease_id);
-  disease->become_removed(self,susceptible.test( disease_id ),
-      infectious.test( disease_id ),
-      symptomatic.test( disease_id ) );
-  susceptible.reset( disease_id );
-  infectious.reset( disease_id );
-  symptomatic.reset( disease_id );
+  disease->become_removed(self,hot->susceptible.test( disease_id ),
+      hot->infectious.test( disease_id ),
+      hot->symptomatic.test( disease_id ) );
+  hot->susceptible.reset( disease_id );
+  hot->infectious.reset( disease_id );
+  hot->symptomatic.reset( disease_id );
   FRED_STATUS( 1, "person %d is now REMOVED for disease %d\n", self->get_id(), disease_id );
 }
 
 void Health::become_immune( Person * self, Disease *disease ) {
   int disease_id = disease->get_id();
-  disease->become_immune( self,susceptible.test( disease_id ),
-      infectious.test( disease_id ),
-      symptomatic.test( disease_id ) );
+  disease->become_immune( self,hot->susceptible.test( disease_id ),
+      hot->infectious.test( disease_id ),
+      hot->symptomatic.test( disease_id ) );
   if(Global::Report_Epidemic_Data_By_Census_Block && Global::Block_Tracker_Initialized) {
-    Household *house = (Household *) self->get_household();
-    string block = house->get_census_block();
-    if(susceptible.test(disease_id)) Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"S",int(-1));
-    if(infectious.test(disease_id)) Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"I",int(-1));
-    if(symptomatic.test(disease_id)) Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"Is",int(-1));
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"M",int(1));
-  }
-  susceptible.reset( disease_id );
-  infectious.reset( disease_id );
-  symptomatic.reset( disease_id );
+    int block = ((Household *) self->get_household())->get_census_block_index();
+    if(hot->susceptible.test(disease_id)) Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::S,-1);
+    if(hot->infectious.test(disease_id)) Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::I,-1);
+    if(hot->symptomatic.test(disease_id)) Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::IS,-1);
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::M,1);
+  }
+  hot->susceptible.reset( disease_id );
+  hot->infectious.reset( disease_id );
+  hot->symptomatic.reset( disease_id );
   
   FRED_STATUS( 1, "person %d is now IMMUNE for disease %d\n", self->get_id(), disease_id );
 }
@@ -252,80 +251,97 @@ void Health::become_immune( Person * self, Disease *disease ) {
 void Health::update( Person * self, int day ) {
   // if deceased, health status should have been cleared during population
   // update (by calling Person->die(), then Health->die(), which will reset (bool) alive
-  if ( !( alive ) ) { return; }
+  if ( !( hot->alive ) ) { return; }
   // set disease-specific flags in bitset to detect calls to recover()
-  recovered_today.reset();
+  hot->recovered_today.reset();
   // if any disease has an active infection, then loop through and check
   // each disease infection
-  if ( active_infections.any() ) {
+  if ( hot->active_infections.any() ) {
     for (int disease_id = 0; disease_id < Global::Diseases; ++disease_id) {
       // update the infection (if it exists)
       // the check if agent has symptoms is performed by Infection->update (or one of the
       // methods called by it).  This sets the relevant symptomatic flag used by 'is_symptomatic()'
-      if ( active_infections.test( disease_id ) ) {
-        infection[ disease_id ]->update( day );
+      if ( hot->active_infections.test( disease_id ) ) {
+        hot->infection[ disease_id ]->update( day );
         // This can only happen if the infection[disease_id] exists.
         // If the infection_update called recover(), it is now safe to
         // collect the susceptible date and delete the Infection object
-        if (recovered_today.test( disease_id ) ) {
-          susceptible_date[ disease_id ] = infection[ disease_id ]->get_susceptible_date();
-          evaluate_susceptibility.set( disease_id );
-          if ( infection[ disease_id ]->provides_immunity() ) {
+        if (hot->recovered_today.test( disease_id ) ) {
+          hot->susceptible_date[ disease_id ] = hot->infection[ disease_id ]->get_susceptible_date();
+          hot->evaluate_susceptibility.set( disease_id );
+          // file the loss of immunity for its day (see update_susceptibility)
+          if ( hot->susceptible_date[ disease_id ] >= day ) {
+            Global::Pop.schedule_susceptibility( hot->susceptible_date[ disease_id ], disease_id,
+                self->get_pop_index() );
+          }
+          if ( hot->infection[ disease_id ]->provides_immunity() ) {
             std::vector< int > strains;
-            infection[ disease_id ]->get_strains( strains );
+            hot->infection[ disease_id ]->get_strains( strains );
             std::vector< int >::iterator itr = strains.begin();
             for ( ; itr != strains.end(); ++itr ) {
               int strain = *itr;
-              int recovery_date = infection[ disease_id ]->get_recovery_date(); 
-              int age_at_exposure = infection[ disease_id ]->get_age_at_exposure(); 
+              int recovery_date = hot->infection[ disease_id ]->get_recovery_date(); 
+              int age_at_exposure = hot->infection[ disease_id ]->get_age_at_exposure(); 
               past_infections[ disease_id ].push_back(
                   Past_Infection( strain, recovery_date, age_at_exposure ) );
             }
           }
-          delete infection[ disease_id ];
-          active_infections.reset( disease_id );
-          infection[ disease_id ] = NULL;
+          delete hot->infection[ disease_id ];
+          hot->active_infections.reset( disease_id );
+          hot->infection[ disease_id ] = NULL;
         }
       }
     }
   }
-  // First check to see if we need to evaluate susceptibility
-  // for any diseases; if so check for susceptibility due to loss of immunity
-  // The evaluate_susceptibility bit for that disease will be reset in the
-  // call to become_susceptible
-  if ( evaluate_susceptibility.any() ) {
-    for (int disease_id = 0; disease_id < Global::Diseases; ++disease_id) {
-      if (day == susceptible_date[disease_id]) {
-        become_susceptible( self, disease_id );
-      }
-    }
-  }
-  else if ( active_infections.none() ) {
-    // no active infections, no need to evaluate susceptibility so we no longer
-    // need to update this Person's Health
+  // Loss of immunity is filed by day and handled by update_susceptibility,
+  // so with no active infections we no longer need to update this Person's
+  // Health
+  if ( hot->active_infections.none() ) {
     Global::Pop.clear_mask_by_index( fred::Update_Health, self->get_pop_index() );
   }
 } // end Health::update //
 
-void Health::update_interventions( Person * self, int day ) {
+bool Health::update_hot_state( Health_Hot_State & hot, int day ) {
+  // mirrors the cases in update() that need nothing but the hot state
+  return !( hot.alive );
+}
+
+void Health::update_susceptibility( Person * self, int disease_id, int day ) {
+  // the evaluate_susceptibility bit is reset by become_susceptible, and the
+  // date is cleared if the agent was infected again since it was filed
+  if ( hot->alive && hot->evaluate_susceptibility.test( disease_id )
+      && hot->susceptible_date[ disease_id ] == day ) {
+    become_susceptible( self, disease_id );
+  }
+}
+
+int Health::get_pending_susceptible_date( int disease_id ) const {
+  return hot->evaluate_susceptibility.test( disease_id ) ? hot->susceptible_date[ disease_id ] : -1;
+}
+
+void Health::update_vaccine_interventions( Person * self, int day ) {
   // if deceased, health status should have been cleared during population
   // update (by calling Person->die(), then Health->die(), which will reset (bool) alive
-  if ( !( alive ) ) { return; }
-  if ( intervention_flags.any() ) {
-    // update vaccine status
-    if (intervention_flags[ takes_vaccine ]) {
-      int size = (int) vaccine_health->size();
-      for (int i = 0; i < size; i++)
-        (*vaccine_health)[ i ]->update(day, self->get_age());
+  if ( !( hot->alive ) ) { return; }
+  if ( intervention_flags[ takes_vaccine ] ) {
+    int size = (int) vaccine_health->size();
+    for (int i = 0; i < size; i++)
+      (*vaccine_health)[ i ]->update(day, self->get_age());
+  }
+} // end Health::update_vaccine_interventions
+
+void Health::update_av_interventions( Person * self, int day ) {
+  if ( !( hot->alive ) ) { return; }
+  if ( intervention_flags[ takes_av ] ) {
+    for ( av_health_itr i = av_health->begin(); i != av_health->end(); ++i ) {
+      ( *i )->update(day);
     }
-    // update antiviral status
-    if ( intervention_flags[ takes_av ] ) {
-      for ( av_health_itr i = av_health->begin(); i != av_health->end(); ++i ) {
-        ( *i )->update(day);
-      }
+    // an antiviral may set the symptomatic flag (see modify_develops_symptoms)
+    if ( hot->symptomatic.any() ) {
+      Global::Pop.set_mask_by_index( fred::Symptomatic, self->get_pop_index() );
     }
   }
-} // end Health::update_interventions
+} // end Health::update_av_interventions
 
 void Health::declare_at_risk(Disease* disease) {
   int disease_id = disease->get_id();
@@ -333,80 +349,88 @@ void Health::declare_at_risk(Disease* disease) {
 }
 
 void Health::advance_seed_infection( int disease_id, int days_to_advance ) {
-  assert( active_infections.test( disease_id ) );
-  assert( infection[ disease_id ] != NULL );
-  infection[ disease_id ]->advance_seed_infection( days_to_advance );
+  assert( hot->active_infections.test( disease_id ) );
+  assert( hot->infection[ disease_id ] != NULL );
+  hot->infection[ disease_id ]->advance_seed_infection( days_to_advance );
+  refresh_infection_dates( disease_id );
+}
+
+void Health::refresh_infection_dates( int disease_id ) {
+  if ( hot->infection[ disease_id ] != NULL ) {
+    hot->exposure_date[ disease_id ] = hot->infection[ disease_id ]->get_exposure_date();
+    hot->recovery_date[ disease_id ] = hot->infection[ disease_id ]->get_recovery_date();
+  }
 }
 
 int Health::get_exposure_date(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return -1;
   else
-    return infection[disease_id]->get_exposure_date();
+    return hot->exposure_date[disease_id];
 }
 
 int Health::get_infectious_date(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return -1;
   else
-    return infection[disease_id]->get_infectious_date();
+    return hot->infection[disease_id]->get_infectious_date();
 }
 
 int Health::get_recovered_date(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return -1;
   else
-    return infection[disease_id]->get_recovery_date();
+    return hot->recovery_date[disease_id];
 }
 
 int Health:: get_symptomatic_date(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return -1;
   else
-    return infection[disease_id]->get_symptomatic_date();
+    return hot->infection[disease_id]->get_symptomatic_date();
 }
 
 Person * Health::get_infector(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return NULL;
   else
-    return infection[disease_id]->get_infector();
+    return hot->infection[disease_id]->get_infector();
 }
 
 Place * Health::get_infected_place(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return NULL;
   else
-    return infection[disease_id]->get_infected_place();
+    return hot->infection[disease_id]->get_infected_place();
 }
 
 int Health::get_infected_place_id(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return -1;
-  else if (infection[disease_id]->get_infected_place() == NULL)
+  else if (hot->infection[disease_id]->get_infected_place() == NULL)
     return -1;
   else
-    return infection[disease_id]->get_infected_place()->get_id();
+    return hot->infection[disease_id]->get_infected_place()->get_id();
 }
 
 char Health::get_infected_place_type(int disease_id) const {
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return 'X';
-  else if (infection[disease_id]->get_infected_place() == NULL)
+  else if (hot->infection[disease_id]->get_infected_place() == NULL)
     return 'X';
   else
-    return infection[disease_id]->get_infected_place()->get_type();
+    return hot->infection[disease_id]->get_infected_place()->get_type();
 }
 
 char * Health::get_infected_place_label(int disease_id) const {
-  if (!( active_infections.test( disease_id ) )) {
+  if (!( hot->active_infections.test( disease_id ) )) {
     strcpy(dummy_label, "-");
     return dummy_label;
-  } else if (infection[disease_id]->get_infected_place() == NULL) {
+  } else if (hot->infection[disease_id]->get_infected_place() == NULL) {
     strcpy(dummy_label, "X");
     return dummy_label;
   } else
-    return infection[disease_id]->get_infected_place()->get_label();
+    return hot->infection[disease_id]->get_infected_place()->get_label();
 }
 
 int Health::get_infectees(int disease_id) const {
@@ -414,59 +438,63 @@ int Health::get_infectees(int disease_id) const {
 }
 
 double Health::get_susceptibility(int disease_id) const {
-  double suscep_multp = susceptibility_multp[disease_id];
+  double suscep_multp = hot->susceptibility_multp[disease_id];
 
-  if (!( active_infections.test( disease_id ) ))
+  if (!( hot->active_infections.test( disease_id ) ))
     return suscep_multp;
   else
-    return infection[disease_id]->get_susceptibility() * suscep_multp;
+    return hot->infection[disease_id]->get_susceptibility() * suscep_multp;
 }
 
 double Health::get_infectivity(int disease_id, int day) const {
-  if (!( active_infections.test( disease_id ) )) {
+  if (!( hot->active_infections.test( disease_id ) )) {
     return 0.0;
   }
   else {
-    return infection[disease_id]->get_infectivity(day);
+    return hot->infection[disease_id]->get_infectivity(day);
   }
 }
 
 //Modify Operators
 void Health::modify_susceptibility(int disease_id, double multp) {
-  susceptibility_multp[disease_id] *= multp;
+  hot->susceptibility_multp[disease_id] *= multp;
 }
 
 void Health::modify_infectivity(int disease_id, double multp) {
-  if (active_infections.test( disease_id ) ) {
-    infection[disease_id]->modify_infectivity(multp);
+  if (hot->active_infections.test( disease_id ) ) {
+    hot->infection[disease_id]->modify_infectivity(multp);
   }
 }
 
 void Health::modify_infectious_period(int disease_id, double multp, int cur_day) {
-  if (active_infections.test( disease_id ) ) {
-    infection[disease_id]->modify_infectious_period(multp, cur_day);
+  if (hot->active_infections.test( disease_id ) ) {
+    hot->infection[disease_id]->modify_infectious_period(multp, cur_day);
+    refresh_infection_dates( disease_id );
   }
 }
 
 void Health::modify_asymptomatic_period(int disease_id, double multp, int cur_day) {
-  if (active_infections.test( disease_id )) {
-    infection[disease_id]->modify_asymptomatic_period(multp, cur_day);
+  if (hot->active_infections.test( disease_id )) {
+    hot->infection[disease_id]->modify_asymptomatic_period(multp, cur_day);
+    refresh_infection_dates( disease_id );
   }
 }
 
 void Health::modify_symptomatic_period(int disease_id, double multp, int cur_day) {
-  if (active_infections.test( disease_id ) ) {
-    infection[disease_id]->modify_symptomatic_period(multp, cur_day);
+  if (hot->active_infections.test( disease_id ) ) {
+    hot->infection[disease_id]->modify_symptomatic_period(multp, cur_day);
+    refresh_infection_dates( disease_id );
   }
 }
 
 void Health::modify_develops_symptoms(int disease_id, bool symptoms, int cur_day) {
-  if (active_infections.test( disease_id ) &&
-      ((infection[disease_id]->is_infectious() && !infection[disease_id]->is_symptomatic()) ||
-       !infection[disease_id]->is_infectious())) {
+  if (hot->active_infections.test( disease_id ) &&
+      ((hot->infection[disease_id]->is_infectious() && !hot->infection[disease_id]->is_symptomatic()) ||
+       !hot->infection[disease_id]->is_infectious())) {
 
-    infection[disease_id]->modify_develops_symptoms(symptoms, cur_day);
-    symptomatic.set( disease_id );
+    hot->infection[disease_id]->modify_develops_symptoms(symptoms, cur_day);
+    refresh_infection_dates( disease_id );
+    hot->symptomatic.set( disease_id );
   }
 }
 
@@ -478,9 +506,8 @@ void Health::take_vaccine( Person * self, Vaccine* vaccine, int day, Vaccine_Man
   Vaccine_Health * vaccine_health_for_dose = NULL;
 
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Household *house = (Household *) self->get_household();
-    string block = house->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"V",int(1));
+    int block = ((Household *) self->get_household())->get_census_block_index();
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::V,1);
   }
   if ( vaccine_health == NULL ) {
     vaccine_health = new vaccine_health_type();
@@ -495,6 +522,7 @@ void Health::take_vaccine( Person * self, Vaccine* vaccine, int day, Vaccine_Man
   if ( vaccine_health_for_dose == NULL ) { // This is our first dose of this vaccine
     vaccine_health->push_back( new Vaccine_Health( day, vaccine, age, self, vm ) );
     intervention_flags[ takes_vaccine ] = true;
+    Global::Pop.set_mask_by_index( fred::Takes_Vaccine, self->get_pop_index() );
   } else { // Already have a dose, need to take the next dose
     vaccine_health_for_dose->update_for_next_dose(day,age);
   }
@@ -518,12 +546,12 @@ void Health::take(Person * p, Antiviral* av, int day) {
     av_health = new av_health_type();
   }
   if(Global::Report_Epidemic_Data_By_Census_Block) {
-    Household *house = (Household *) p->get_household();
-    string block = house->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(block,"Av",int(1));
+    int block = ((Household *) p->get_household())->get_census_block_index();
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::AV,1);
   }
   av_health->push_back(new AV_Health(day,av,this));
   intervention_flags[ takes_av ] = true;
+  Global::Pop.set_mask_by_index( fred::Takes_AV, p->get_pop_index() );
   return;
 }
 
@@ -545,12 +573,12 @@ void Health::infect( Person * self, Person *infectee, int disease_id, Transmissi
   // Person::infect => Health::infect => Infection::transmit [Create transmission
   // and expose infectee]
   Disease * disease = Global::Pop.get_disease( disease_id );
-  infection[ disease_id ]->transmit( infectee, transmission );
+  hot->infection[ disease_id ]->transmit( infectee, transmission );
   
   #pragma omp atomic
   ++( infectee_count[ disease_id ] );
 
-  disease->increment_cohort_infectee_count( infection[disease_id]->get_exposure_date() );
+  disease->increment_cohort_infectee_count( hot->infection[disease_id]->get_exposure_date() );
 
   FRED_STATUS( 1, "person %d infected person %d infectees = %d\n",
         self->get_id(), infectee->get_id(), infectee_count[disease_id] );
@@ -586,3 +614,104 @@ void Health::terminate( Person * self ) {
   }
 }
 
+
+void Health::write_checkpoint( Checkpoint & checkpoint ) {
+  for ( int disease_id = 0; disease_id < Global::Diseases; ++disease_id ) {
+    checkpoint.write( hot->susceptibility_multp[ disease_id ] );
+    checkpoint.write( hot->exposure_date[ disease_id ] );
+    checkpoint.write( hot->recovery_date[ disease_id ] );
+    checkpoint.write( hot->susceptible_date[ disease_id ] );
+    checkpoint.write( infectee_count[ disease_id ] );
+    checkpoint.write_vector( past_infections[ disease_id ] );
+    Infection * infection = hot->infection[ disease_id ];
+    checkpoint.write( (char) ( infection != NULL ) );
+    if ( infection != NULL ) {
+      infection->write_checkpoint( checkpoint );
+    }
+  }
+  checkpoint.write( hot->active_infections );
+  checkpoint.write( hot->susceptible );
+  checkpoint.write( hot->infectious );
+  checkpoint.write( hot->symptomatic );
+  checkpoint.write( hot->recovered_today );
+  checkpoint.write( hot->evaluate_susceptibility );
+  checkpoint.write( hot->alive );
+  checkpoint.write( immunity );
+  checkpoint.write( at_risk );
+  checkpoint.write( intervention_flags );
+
+  checkpoint.write( (char) ( checked_for_av != NULL ) );
+  if ( checked_for_av != NULL ) {
+    checkpoint.write_size( checked_for_av->size() );
+    for ( size_t i = 0; i < checked_for_av->size(); ++i ) {
+      checkpoint.write( (char) (*checked_for_av)[ i ] );
+    }
+  }
+  checkpoint.write( (char) ( av_health != NULL ) );
+  if ( av_health != NULL ) {
+    checkpoint.write_size( av_health->size() );
+    for ( size_t i = 0; i < av_health->size(); ++i ) {
+      (*av_health)[ i ]->write_checkpoint( checkpoint );
+    }
+  }
+  checkpoint.write( (char) ( vaccine_health != NULL ) );
+  if ( vaccine_health != NULL ) {
+    checkpoint.write_size( vaccine_health->size() );
+    for ( size_t i = 0; i < vaccine_health->size(); ++i ) {
+      (*vaccine_health)[ i ]->write_checkpoint( checkpoint );
+    }
+  }
+}
+
+void Health::read_checkpoint( Person * self, Checkpoint & checkpoint ) {
+  hot = Global::Pop.get_health_hot_state( self->get_pop_index() );
+  for ( int disease_id = 0; disease_id < Global::Diseases; ++disease_id ) {
+    checkpoint.read( hot->susceptibility_multp[ disease_id ] );
+    checkpoint.read( hot->exposure_date[ disease_id ] );
+    checkpoint.read( hot->recovery_date[ disease_id ] );
+    checkpoint.read( hot->susceptible_date[ disease_id ] );
+    checkpoint.read( infectee_count[ disease_id ] );
+    checkpoint.read_vector( past_infections[ disease_id ] );
+    char has_infection;
+    checkpoint.read( has_infection );
+    hot->infection[ disease_id ] = has_infection ? Infection::read_checkpoint( checkpoint ) : NULL;
+  }
+  checkpoint.read( hot->active_infections );
+  checkpoint.read( hot->susceptible );
+  checkpoint.read( hot->infectious );
+  checkpoint.read( hot->symptomatic );
+  checkpoint.read( hot->recovered_today );
+  checkpoint.read( hot->evaluate_susceptibility );
+  checkpoint.read( hot->alive );
+  checkpoint.read( immunity );
+  checkpoint.read( at_risk );
+  checkpoint.read( intervention_flags );
+
+  char has;
+  checked_for_av = NULL;
+  checkpoint.read( has );
+  if ( has ) {
+    checked_for_av = new checked_for_av_type( checkpoint.read_size() );
+    for ( size_t i = 0; i < checked_for_av->size(); ++i ) {
+      char checked;
+      checkpoint.read( checked );
+      (*checked_for_av)[ i ] = checked;
+    }
+  }
+  av_health = NULL;
+  checkpoint.read( has );
+  if ( has ) {
+    av_health = new av_health_type( checkpoint.read_size() );
+    for ( size_t i = 0; i < av_health->size(); ++i ) {
+      (*av_health)[ i ] = AV_Health::read_checkpoint( this, checkpoint );
+    }
+  }
+  vaccine_health = NULL;
+  checkpoint.read( has );
+  if ( has ) {
+    vaccine_health = new vaccine_health_type( checkpoint.read_size() );
+    for ( size_t i = 0; i < vaccine_health->size(); ++i ) {
+      (*vaccine_health)[ i ] = Vaccine_Health::read_checkpoint( self, checkpoint );
+    }
+  }
+}
@@ -36,6 +36,37 @@ class Vaccine;
 class Vaccine_Health;
 class Vaccine_Manager;
 class Place;
+class Checkpoint;
+
+/*
+ * The part of a Person's health state that is read on every daily sweep of
+ * the population.  These records live in a bloque linked to the population
+ * bloque, so the record for a Person has the same index as the Person
+ * (Person::get_pop_index()) and consecutive records are contiguous in memory;
+ * sweeps that only need this state never touch the (much larger) Person.
+ *
+ * Each Health keeps a pointer to its own record.  The exposure and recovery
+ * dates are copies of those held by the active Infection, refreshed by Health
+ * whenever the Infection may have changed them.
+ */
+struct Health_Hot_State {
+  Infection * infection[ Global::MAX_NUM_DISEASES ];
+  double susceptibility_multp[ Global::MAX_NUM_DISEASES ];
+  int exposure_date[ Global::MAX_NUM_DISEASES ];
+  int recovery_date[ Global::MAX_NUM_DISEASES ];
+  int susceptible_date[ Global::MAX_NUM_DISEASES ];
+  // bitset removes need to check each infection in above array to
+  // find out if any are not NULL
+  fred::disease_bitset active_infections;
+  // Per-disease health status flags
+  fred::disease_bitset susceptible;
+  fred::disease_bitset infectious;
+  fred::disease_bitset symptomatic;
+  fred::disease_bitset recovered_today;
+  fred::disease_bitset evaluate_susceptibility;
+  // The alive bool could probably be eliminated
+  bool alive;
+};
 
 class Health {
 
@@ -63,11 +94,41 @@ public:
    */
   void update( Person * self, int day );
 
+  /**
+   * Perform the daily update using only the hot state, if nothing else is
+   * needed today (the agent has died).  Recovered agents leave the sweep,
+   * since their loss of immunity is filed by day (see update_susceptibility).
+   *
+   * @param hot the agent's hot state
+   * @param day the simulation day
+   * @return <code>true</code> if the update is complete, <code>false</code> if
+   * update() must be called
+   */
+  static bool update_hot_state( Health_Hot_State & hot, int day );
+
+  /**
+   * Loss of immunity to a disease, on the day filed at recovery (see
+   * Population::update_susceptibility)
+   *
+   * @param disease_id the disease
+   * @param day the simulation day
+   */
+  void update_susceptibility( Person * self, int disease_id, int day );
+
+  /**
+   * @param disease_id the disease
+   * @return the day filed for the loss of immunity to the disease, or -1
+   */
+  int get_pending_susceptible_date( int disease_id ) const;
+
   /*
    * Separating the updates for vaccine & antivirals from the
-   * infection update gives improvement for the base.  
+   * infection update gives improvement for the base.  Each is run
+   * over the people with its mask set (fred::Takes_Vaccine and
+   * fred::Takes_AV), which are set on the first dose or course.
    */
-  void update_interventions( Person * self, int day );
+  void update_vaccine_interventions( Person * self, int day );
+  void update_av_interventions( Person * self, int day );
 
   /**
    * Agent is susceptible to the disease
@@ -134,7 +195,7 @@ public:
    * @param disease which disease
    * @return <code>true</code> if the agent is susceptible, <code>false</code> otherwise
    */
-  bool is_susceptible (int disease_id) const {return susceptible.test( disease_id );}
+  bool is_susceptible (int disease_id) const {return hot->susceptible.test( disease_id );}
 
   /**
    * Is the agent infectious for a given disease
@@ -142,9 +203,9 @@ public:
    * @param disease which disease
    * @return <code>true</code> if the agent is infectious, <code>false</code> otherwise
    */
-  bool is_infectious(int disease_id) const { return (infectious.test( disease_id ) ); }
+  bool is_infectious(int disease_id) const { return (hot->infectious.test( disease_id ) ); }
 
-  bool is_infected(int disease_id) const { return active_infections.test( disease_id ); }
+  bool is_infected(int disease_id) const { return hot->active_infections.test( disease_id ); }
   /**
    * Is the agent recovered for a given disease
    *
@@ -153,7 +214,7 @@ public:
    */
   
   bool is_recovered(int disease_id) const {
-    return this->recovered_today.test(disease_id);
+    return hot->recovered_today.test(disease_id);
   }
 
 /**
@@ -161,8 +222,8 @@ public:
    *
    * @return <code>true</code> if the agent is symptomatic, <code>false</code> otherwise
    */
-  bool is_symptomatic() const { return symptomatic.any(); }
-  bool is_symptomatic(int disease_id) { return symptomatic.test( disease_id ); }
+  bool is_symptomatic() const { return hot->symptomatic.any(); }
+  bool is_symptomatic(int disease_id) { return hot->symptomatic.test( disease_id ); }
 
   /**
    * Is the agent immune to a given disease
@@ -278,7 +339,7 @@ public:
    * @return a pointer to the Infection object
    */
   Infection* get_infection(int disease_id) const {
-    return infection[disease_id];
+    return hot->infection[disease_id];
   }
 
   /**
@@ -486,35 +547,26 @@ public:
   bool is_newly_symptomatic(int day, int disease_id) { return day == get_symptomatic_date(disease_id); }
 
 
-  void die() { printf("Killing Agent"); alive = false; }
+  void die() { printf("Killing Agent"); hot->alive = false; }
+
+  /**
+   * Write the health state, including the hot state record, infections and
+   * interventions, to a checkpoint, or read it back for the Person self (see
+   * Checkpoint)
+   */
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Person * self, Checkpoint & checkpoint );
 
 private:
   
   // The index of the person in the Population
   //int person_index;
 
-  // The alive bool could probably be eliminated
-  bool alive;
-  
-  // TODO (JVD): The infection vector & bitset should be combined into a little 
-  // helper class to make sure that they're always synched up.
-  // There would be just a little overhead in doing this but probably well worth it.
-  // Until then make sure that they're always changed together.
-  Infection * infection[ Global::MAX_NUM_DISEASES ];
-  // bitset removes need to check each infection in above array to
-  // find out if any are not NULL
-  fred::disease_bitset active_infections;
+  // hot state record in Population's linked bloque (see Health_Hot_State)
+  Health_Hot_State * hot;
+
   fred::disease_bitset immunity;
   fred::disease_bitset at_risk;  // Agent is/isn't at risk for severe complications
-  // Per-disease health status flags
-  fred::disease_bitset susceptible;
-  fred::disease_bitset infectious;
-  fred::disease_bitset symptomatic;
-  fred::disease_bitset recovered_today;
-  fred::disease_bitset evaluate_susceptibility;
-
-  // per-disease susceptibility multiplier
-  double susceptibility_multp[ Global::MAX_NUM_DISEASES ];
  
   // Antivirals.  These are all dynamically allocated to save space
   // when not in use
@@ -540,7 +592,9 @@ private:
   vector < Past_Infection > past_infections[ Global::MAX_NUM_DISEASES ];
   
   int infectee_count[ Global::MAX_NUM_DISEASES ];
-  int susceptible_date[ Global::MAX_NUM_DISEASES ];
+
+  // copy the active infection's exposure and recovery dates to the hot state
+  void refresh_infection_dates( int disease_id );
 
 protected:
   
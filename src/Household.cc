@@ -29,6 +29,7 @@
 #include "Cell.h"
 #include "Small_Grid.h"
 #include "Small_Cell.h"
+#include "Checkpoint.h"
 
 
 //Private static variables that will be set by parameter lookups
@@ -47,6 +48,7 @@ Household::Household( const  char *lab, fred::geo lon,
   adults = children = 0;
   N = 0;
   //census_block = "";
+  census_block_index = -1;
   group_quarters = false;
 }
 
@@ -183,6 +185,8 @@ void Household::spread_infection(int day, int disease_id) {
 
   double contact_prob = get_contact_rate( day, disease_id );
 
+  RNG_Stream stream( RNG_Stream::PLACE_SPREAD, day, id, disease_id );
+
   // randomize the order of the infectious list
   if ( !is_group_quarters() ) { // <--------------------------------------------------------------- TODO temporary support for group quarters 
     FYShuffle<Person *>( housemate );
@@ -191,6 +195,9 @@ void Household::spread_infection(int day, int disease_id) {
   for ( int infector_pos = 0; infector_pos < housemate.size(); ++infector_pos ) {
     Person * infector = housemate[ infector_pos ];      // infectious individual
     if ( ! infector->get_health()->is_infectious( disease_id ) ) { continue; }
+    // housemates are not visitors from the daily sweeps, so their
+    // infectivity and susceptibility come from their health directly
+    double infectivity = infector->get_infectivity( disease_id, day );
 
     for (int pos = 0; pos < housemate.size(); ++pos) {
       if ( pos == infector_pos ) { continue; }
@@ -206,10 +213,10 @@ void Household::spread_infection(int day, int disease_id) {
       if ( infectee->is_susceptible( disease_id ) ) {
         // get the transmission probs for this infector/infectee pair
         double transmission_prob = get_transmission_prob( disease_id, infector, infectee );
-        double infectivity = infector->get_infectivity( disease_id, day );
         // scale transmission prob by infectivity and contact prob
         transmission_prob *= infectivity * contact_prob;     
-        attempt_transmission( transmission_prob, infector, infectee, disease_id, day );
+        attempt_transmission( transmission_prob, infectee->get_susceptibility( disease_id ),
+            infector, infectee, disease_id, day );
       }
     } // end contact loop
   } // end infectious list loop
@@ -219,10 +226,11 @@ void Household::add_infectious(int disease_id, Person * per) {
 
   //place_state[ disease_id ]().add_infectious( per );
   
-  if ( !( infectious_bitset.test( disease_id ) ) ) {
+  // test and set at once, so that the place is listed only once however
+  // many threads add infectious visitors to it
+  if ( !( infectious_bitset.test_and_set( disease_id ) ) ) {
     Disease * dis = population->get_disease( disease_id );
     dis->add_infectious_place( this, type );
-    infectious_bitset.set( disease_id );
   }
 
   add_infectious_visitor(disease_id);
@@ -240,3 +248,20 @@ int Household::gq_get_room_number( int housemate_index ) {
   return housemate_index / gq_get_room_size();
 }
 
+void Household::write_checkpoint(Checkpoint & checkpoint) {
+  Place::write_checkpoint(checkpoint);
+  checkpoint.write(children);
+  checkpoint.write(adults);
+  checkpoint.write_people(housemate);
+  checkpoint.write_vector(ages);
+  checkpoint.write_vector(ids);
+}
+
+void Household::read_checkpoint(Checkpoint & checkpoint) {
+  Place::read_checkpoint(checkpoint);
+  checkpoint.read(children);
+  checkpoint.read(adults);
+  checkpoint.read_people(housemate);
+  checkpoint.read_vector(ages);
+  checkpoint.read_vector(ids);
+}
@@ -98,6 +98,12 @@ public:
    */
   void unenroll(Person * per);
 
+  /**
+   * @see Place::write_checkpoint(Checkpoint & checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Get a person from the household.
    *
@@ -199,6 +205,15 @@ public:
   void set_census_block(string _census_block) {
     census_block = _census_block;
   }
+
+  // index of the census block in Global::Block_Epi_Day_Tracker
+  int get_census_block_index() const {
+    return this->census_block_index;
+  }
+
+  void set_census_block_index(int _census_block_index) {
+    census_block_index = _census_block_index;
+  }
   
 
 private:
@@ -213,6 +228,7 @@ private:
   unsigned char deme_id;	      // deme == synthetic population id
   bool group_quarters;
   string census_block;
+  int census_block_index;
 
   std::vector <Person *> housemate;		// list of housemates
 
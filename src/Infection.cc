@@ -36,6 +36,7 @@
 #include "Utils.h"
 #include "Report.h"
 #include "json.h"
+#include "Checkpoint.h"
 
 using std::out_of_range;
 using nlohmann::json;
@@ -387,3 +388,74 @@ Past_Infection *Infection::get_past_infection(int i)
 }
 
 
+
+void Infection::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write( disease->get_id() );
+  checkpoint.write( trajectory_infectivity_threshold );
+  checkpoint.write( trajectory_symptomaticity_threshold );
+  checkpoint.write( is_susceptible );
+  checkpoint.write( immune_response );
+  checkpoint.write( will_be_symptomatic );
+  checkpoint.write( latent_period );
+  checkpoint.write( asymptomatic_period );
+  checkpoint.write( symptomatic_period );
+  checkpoint.write( recovery_period );
+  checkpoint.write( susceptibility_period );
+  checkpoint.write( incubation_period );
+  checkpoint.write( age_at_exposure );
+  checkpoint.write_person( infector );
+  checkpoint.write_person( host );
+  checkpoint.write_place( place );
+  checkpoint.write( infectee_count );
+  checkpoint.write( susceptibility );
+  checkpoint.write( infectivity );
+  checkpoint.write( infectivity_multp );
+  checkpoint.write( symptoms );
+  checkpoint.write( exposure_date );
+  checkpoint.write( infectious_date );
+  checkpoint.write( symptomatic_date );
+  checkpoint.write( asymptomatic_date );
+  checkpoint.write( recovery_date );
+  checkpoint.write( susceptible_date );
+  checkpoint.write( (char) ( trajectory != NULL ) );
+  if ( trajectory != NULL ) {
+    trajectory->write_checkpoint( checkpoint );
+  }
+}
+
+Infection * Infection::read_checkpoint( Checkpoint & checkpoint ) {
+  Infection * infection = new Infection();
+  int disease_id;
+  checkpoint.read( disease_id );
+  infection->disease = Global::Pop.get_disease( disease_id );
+  checkpoint.read( infection->trajectory_infectivity_threshold );
+  checkpoint.read( infection->trajectory_symptomaticity_threshold );
+  checkpoint.read( infection->is_susceptible );
+  checkpoint.read( infection->immune_response );
+  checkpoint.read( infection->will_be_symptomatic );
+  checkpoint.read( infection->latent_period );
+  checkpoint.read( infection->asymptomatic_period );
+  checkpoint.read( infection->symptomatic_period );
+  checkpoint.read( infection->recovery_period );
+  checkpoint.read( infection->susceptibility_period );
+  checkpoint.read( infection->incubation_period );
+  checkpoint.read( infection->age_at_exposure );
+  infection->infector = checkpoint.read_person();
+  infection->host = checkpoint.read_person();
+  infection->place = checkpoint.read_place();
+  checkpoint.read( infection->infectee_count );
+  checkpoint.read( infection->susceptibility );
+  checkpoint.read( infection->infectivity );
+  checkpoint.read( infection->infectivity_multp );
+  checkpoint.read( infection->symptoms );
+  checkpoint.read( infection->exposure_date );
+  checkpoint.read( infection->infectious_date );
+  checkpoint.read( infection->symptomatic_date );
+  checkpoint.read( infection->asymptomatic_date );
+  checkpoint.read( infection->recovery_date );
+  checkpoint.read( infection->susceptible_date );
+  char has_trajectory;
+  checkpoint.read( has_trajectory );
+  infection->trajectory = has_trajectory ? Trajectory::read_checkpoint( checkpoint ) : NULL;
+  return infection;
+}
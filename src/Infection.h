@@ -31,6 +31,7 @@ class Health;
 class IntraHost;
 class Transmission;
 class Past_Infection;
+class Checkpoint;
 
 #define BIFURCATING 0
 #define SEQUENTIAL 1
@@ -207,9 +208,7 @@ public:
    * @return the infectivity of this infection for a given day
    */
   double get_infectivity(int day) const {
-    day = day - exposure_date;
-    Trajectory::point point = trajectory->get_data_point(day);
-    return point.infectivity * infectivity_multp;
+    return trajectory->get_infectivity(day - exposure_date) * infectivity_multp;
   }
 
   /**
@@ -251,6 +250,10 @@ public:
 
   void mutate(int old_strain, int new_strain, int day) { trajectory->mutate(old_strain, new_strain, day); }
 
+  /// see Checkpoint
+  void write_checkpoint( Checkpoint & checkpoint );
+  static Infection * read_checkpoint( Checkpoint & checkpoint );
+
 private:
   // associated disease
   Disease *disease;
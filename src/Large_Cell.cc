@@ -21,6 +21,7 @@
 #include "Geo_Utils.h"
 #include "Random.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 
 int Large_Cell::next_cell_id = 0;
 
@@ -196,3 +197,24 @@ unsigned char Large_Cell::get_deme_id() {
   return deme_id;
 }
 
+void Large_Cell::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write(popsize);
+  checkpoint.write_people(person);
+  checkpoint.write_size(demes.size());
+  for (std::map< unsigned char, int >::iterator itr = demes.begin(); itr != demes.end(); ++itr) {
+    checkpoint.write(itr->first);
+    checkpoint.write(itr->second);
+  }
+}
+
+void Large_Cell::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read(popsize);
+  checkpoint.read_people(person);
+  demes.clear();
+  size_t number_of_demes = checkpoint.read_size();
+  for (size_t i = 0; i < number_of_demes; ++i) {
+    unsigned char deme_id;
+    checkpoint.read(deme_id);
+    checkpoint.read(demes[deme_id]);
+  }
+}
@@ -25,6 +25,7 @@
 #include "Utils.h"
 
 class Large_Grid;
+class Checkpoint;
 
 
 
@@ -57,6 +58,10 @@ public:
 
   unsigned char get_deme_id();
 
+  /// writes the residents of the cell to a checkpoint, or reads them back
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
 protected:
   fred::Mutex mutex;
   Large_Grid * grid;
@@ -31,6 +31,7 @@ using namespace std;
 #include "Household.h"
 #include "Population.h"
 #include "Date.h"
+#include "Checkpoint.h"
 
 Large_Grid::Large_Grid(fred::geo minlon, fred::geo minlat, fred::geo maxlon, fred::geo maxlat) {
   min_lon  = minlon;
@@ -270,4 +271,20 @@ Place *Large_Grid::get_nearby_workplace(int row, int col, double x, double y, in
   return nearby_workplace;
 }
 
+void Large_Grid::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("large grid");
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      grid[row][col].write_checkpoint(checkpoint);
+    }
+  }
+}
 
+void Large_Grid::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("large grid");
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      grid[row][col].read_checkpoint(checkpoint);
+    }
+  }
+}
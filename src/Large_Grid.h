@@ -25,6 +25,7 @@
 #include "Global.h"
 
 class Large_Cell;
+class Checkpoint;
 
 class Large_Grid : public Abstract_Grid {
 public:
@@ -42,6 +43,13 @@ public:
   void quality_control(char * directory);
   void read_max_popsize();
 
+  /**
+   * Write the residents of each cell to a checkpoint, or read them back
+   * (see Checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
 protected:
   Large_Cell ** grid;            // Rectangular array of grid_cells
 };
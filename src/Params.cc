@@ -27,69 +27,44 @@ using namespace std;
 char Params::param_name[MAX_PARAMS][MAX_PARAM_SIZE];
 char Params::param_value[MAX_PARAMS][MAX_PARAM_SIZE];
 int Params::param_count;
+Params::Param_Entry Params::param_entry[MAX_PARAMS];
+int Params::param_index[PARAM_INDEX_SIZE];
 
 int Params::read_parameters(char *paramfile) {
-  FILE *fp;
   char name[MAX_PARAM_SIZE];
   Params::param_count = 0;
+  for (int i = 0; i < PARAM_INDEX_SIZE; i++) {
+    Params::param_index[i] = -1;
+  }
   
   strcpy(name, "$FRED_HOME/input_files/params.default");
-  fp = Utils::fred_open_file(name);
-  if (fp != NULL) {
-    while (fscanf(fp, "%s", name) == 1) {
-      if (name[0] == '#') {
-        int ch = 1;
-        while (ch != '\n')
-          ch = fgetc(fp);
-        continue;
-      } else {
-        if (fscanf(fp, " = %[^\n]", Params::param_value[Params::param_count]) == 1) {
-          
-          //Remove end of line comments if they are there
-          string temp_str(Params::param_value[Params::param_count]);
-          size_t pos;
-          string whitespaces(" \t\f\v\n\r");
-          
-          pos = temp_str.find("#");
-          if (pos != string::npos)
-            temp_str = temp_str.substr(0, pos);
-          
-          //trim trailing whitespace
-          pos = temp_str.find_last_not_of(whitespaces);
-          if (pos != string::npos) {
-            if(pos != (temp_str.length() - 1))
-              temp_str.erase(pos + 1);
-          }
-          else
-            temp_str.clear(); //str is all whitespace
-          
-          strcpy(Params::param_value[Params::param_count], temp_str.c_str());
-          
-          strcpy(Params::param_name[Params::param_count], name);
-          if (Global::Debug > 2) {
-            printf("READ_PARAMS: %s = %s\n", Params::param_name[Params::param_count],
-                Params::param_value[Params::param_count]);
-          }
-          Params::param_count++;
-        } else {
-          Utils::fred_abort("Bad format in params.default file on line starting with %s\n",name);
-        }
-      }
+  Params::read_parameter_file(name, 0);
+  Params::read_parameter_file(paramfile, 1);
+  
+  if (Global::Debug > 1) {
+    for (int i = 0; i < Params::param_count; i++) {
+      printf("READ_PARAMS: %s = %s\n", Params::param_name[i], Params::param_value[i]);
     }
-  } else {
-    Utils::fred_abort("Help!  Can't read paramfile %s\n", "params.default");
   }
-  fclose(fp);
   
+  return Params::param_count;
+}
+
+int Params::read_parameter_file(char *paramfile, int file) {
+  FILE *fp;
+  char name[MAX_PARAM_SIZE];
   fp = Utils::fred_open_file(paramfile);
   if (fp != NULL) {
     while (fscanf(fp, "%s", name) == 1) {
       if (name[0] == '#') {
         int ch = 1;
-        while (ch != '\n')
+        while (ch != '\n' && ch != EOF)
           ch = fgetc(fp);
         continue;
       } else {
+        if (Params::param_count == MAX_PARAMS) {
+          Utils::fred_abort("Help! More than %d parameters in %s\n", MAX_PARAMS, paramfile);
+        }
         if (fscanf(fp, " = %[^\n]", Params::param_value[Params::param_count]) == 1) {
           
           //Remove end of line comments if they are there
@@ -117,9 +92,10 @@ int Params::read_parameters(char *paramfile) {
             printf("READ_PARAMS: %s = %s\n", Params::param_name[Params::param_count],
                 Params::param_value[Params::param_count]);
           }
+          Params::add_parameter(Params::param_count, file);
           Params::param_count++;
         } else {
-    Utils::fred_abort("Help! Bad format in file %s on line starting with %s\n",paramfile, name);
+          Utils::fred_abort("Help! Bad format in file %s on line starting with %s\n", paramfile, name);
         }
       }
     }
@@ -127,22 +103,111 @@ int Params::read_parameters(char *paramfile) {
     Utils::fred_abort("Help!  Can't read paramfile %s\n", paramfile);
   }
   fclose(fp);
-  
-  if (Global::Debug > 1) {
-    for (int i = 0; i < Params::param_count; i++) {
-      printf("READ_PARAMS: %s = %s\n", Params::param_name[i], Params::param_value[i]);
+  return Params::param_count;
+}
+
+// parse the value of parameter i and enter its name in the index
+void Params::add_parameter(int i, int file) {
+  Param_Entry & e = Params::param_entry[i];
+  const char * value = Params::param_value[i];
+  e.file = file;
+  e.uses = 0;
+  e.int_value = 0;
+  e.ulong_value = 0;
+  e.double_value = 0.0;
+  e.float_value = 0.0;
+  e.int_status = sscanf(value, "%d", &e.int_value);
+  e.ulong_status = sscanf(value, "%lu", &e.ulong_value);
+  e.double_status = sscanf(value, "%lf", &e.double_value);
+  e.float_status = sscanf(value, "%f", &e.float_value);
+
+  e.int_vector.clear();
+  e.double_vector.clear();
+  e.vector_status = -1;
+  char str[MAX_PARAM_SIZE];
+  strcpy(str, value);
+  char *pch = strtok(str, " ");
+  int n;
+  if (pch != NULL && sscanf(pch, "%d", &n) == 1) {
+    e.vector_status = 1;
+    int iv = 0;
+    double dv = 0.0;
+    for (int k = 0; k < n; k++) {
+      pch = strtok(NULL, " ");
+      if (pch == NULL) {
+        e.vector_status = 0;
+        break;
+      }
+      sscanf(pch, "%d", &iv);
+      sscanf(pch, "%lf", &dv);
+      e.int_vector.push_back(iv);
+      e.double_vector.push_back(dv);
     }
   }
-  
-  return Params::param_count;
+
+  unsigned int slot = Params::hash(Params::param_name[i]) & (PARAM_INDEX_SIZE - 1);
+  e.previous = -1;
+  while (Params::param_index[slot] != -1) {
+    if (strcmp(Params::param_name[Params::param_index[slot]], Params::param_name[i]) == 0) {
+      e.previous = Params::param_index[slot];
+      break;
+    }
+    slot = (slot + 1) & (PARAM_INDEX_SIZE - 1);
+  }
+  Params::param_index[slot] = i;
+}
+
+// FNV-1a
+unsigned int Params::hash(const char *s) {
+  unsigned int h = 2166136261u;
+  for (; *s; ++s) {
+    h ^= (unsigned char) *s;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// index of the last definition of s, or -1
+int Params::find_param(const char *s) {
+  unsigned int slot = Params::hash(s) & (PARAM_INDEX_SIZE - 1);
+  while (Params::param_index[slot] != -1) {
+    if (strcmp(Params::param_name[Params::param_index[slot]], s) == 0) {
+      return Params::param_index[slot];
+    }
+    slot = (slot + 1) & (PARAM_INDEX_SIZE - 1);
+  }
+  return -1;
 }
 
+// as find_param, and count the lookup for report_usage
+int Params::use_param(const char *s) {
+  int i = Params::find_param(s);
+  if (i >= 0) {
+    #pragma omp atomic
+    Params::param_entry[i].uses++;
+  }
+  return i;
+}
+
+void Params::not_found(char *s) {
+  if (Global::Debug > 0) {
+    printf("PARAMS: %s not found\n", s);
+    fflush(stdout);
+  }
+  Utils::fred_abort("PARAMS: %s not found\n", s); 
+}
+
+// The typed lookups below use the last definition that parses, as a sequential
+// scan over all definitions would.
+
 int Params::get_param(char *s, int *p) {
   int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      if (sscanf(Params::param_value[i], "%d", p)) {
-        found = 1;
+  for (int i = Params::use_param(s); i >= 0; i = Params::param_entry[i].previous) {
+    if (Params::param_entry[i].int_status) {
+      found = 1;
+      if (Params::param_entry[i].int_status == 1) {
+        *p = Params::param_entry[i].int_value;
+        break;
       }
     }
   }
@@ -153,21 +218,19 @@ int Params::get_param(char *s, int *p) {
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush(stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+    Params::not_found(s);
   }
   return 0;
 }
 
 int Params::get_param(char *s, unsigned long *p) {
   int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      if (sscanf(Params::param_value[i], "%lu", p)) {
-        found = 1;
+  for (int i = Params::use_param(s); i >= 0; i = Params::param_entry[i].previous) {
+    if (Params::param_entry[i].ulong_status) {
+      found = 1;
+      if (Params::param_entry[i].ulong_status == 1) {
+        *p = Params::param_entry[i].ulong_value;
+        break;
       }
     }
   }
@@ -178,21 +241,19 @@ int Params::get_param(char *s, unsigned long *p) {
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush( stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+    Params::not_found(s);
   }
   return 0;
 }
 
 int Params::get_param(char *s, double *p) {
   int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      if (sscanf(Params::param_value[i], "%lf", p)) {
-        found = 1;
+  for (int i = Params::use_param(s); i >= 0; i = Params::param_entry[i].previous) {
+    if (Params::param_entry[i].double_status) {
+      found = 1;
+      if (Params::param_entry[i].double_status == 1) {
+        *p = Params::param_entry[i].double_value;
+        break;
       }
     }
   }
@@ -203,21 +264,19 @@ int Params::get_param(char *s, double *p) {
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush( stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+    Params::not_found(s);
   }
   return 0;
 }
 
 int Params::get_param(char *s, float *p) {
   int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      if (sscanf(Params::param_value[i], "%f", p)) {
-        found = 1;
+  for (int i = Params::use_param(s); i >= 0; i = Params::param_entry[i].previous) {
+    if (Params::param_entry[i].float_status) {
+      found = 1;
+      if (Params::param_entry[i].float_status == 1) {
+        *p = Params::param_entry[i].float_value;
+        break;
       }
     }
   }
@@ -228,25 +287,19 @@ int Params::get_param(char *s, float *p) {
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush( stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s);
+    Params::not_found(s);
   }
   return 0;
 }
 
 int Params::get_param(char *s, string &p){
   int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      stringstream ss;
-      ss << Params::param_value[i];
-      if(ss.str().size() > 0){
-        p = ss.str();
-        found = 1;
-      }
+  // the last non-empty definition
+  for (int i = Params::use_param(s); i >= 0; i = Params::param_entry[i].previous) {
+    if (Params::param_value[i][0] != '\0') {
+      p = Params::param_value[i];
+      found = 1;
+      break;
     }
   }
   if (found) {
@@ -256,124 +309,71 @@ int Params::get_param(char *s, string &p){
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush(stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+    Params::not_found(s);
   }
   return 0;
 }
 
 int Params::get_param(char *s, char *p) {
-  int found = 0;
-  for (int i = 0; i < Params::param_count; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      if (strcpy(p, Params::param_value[i])) {
-        found = 1;
-      }
-    }
-  }
-  if (found) {
+  int i = Params::use_param(s);
+  if (i >= 0) {
+    strcpy(p, Params::param_value[i]);
     if (Global::Debug > 0) {
       printf("PARAMS: %s = %s\n", s, p);
       fflush( stdout);
     }
     return 1;
   } else {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", s);
-      fflush( stdout);
-    }
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+    Params::not_found(s);
   }
   return 0;
 }
 
-int Params::get_param_vector(char *s, vector < int > &p){
-  char str[MAX_PARAM_SIZE];
-  int n;
-  char *pch;
-  int v;
-  Params::get_param(s,str);
-  pch = strtok(str," ");
-  if(sscanf(pch,"%d",&n) == 1){
-    for (int i=0;i<n;i++){
-      pch = strtok(NULL," ");
-      if(pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s); 
-      }
-      sscanf(pch,"%d",&v);
-      p.push_back(v);
-    }
+// the last definition of s, which must be a well-formed vector
+int Params::get_vector_entry(char *s) {
+  int i = Params::use_param(s);
+  if (i < 0) {
+    Params::not_found(s);
+  }
+  if (Global::Debug > 0) {
+    printf("PARAMS: %s = %s\n", s, Params::param_value[i]);
+    fflush( stdout);
   }
-  else {
+  if (Params::param_entry[i].vector_status < 0) {
     Utils::fred_abort("Incorrect format for vector %s\n", s); 
   }
-  return n;
+  if (Params::param_entry[i].vector_status == 0) {
+    Utils::fred_abort("Help! bad param vector: %s\n", s); 
+  }
+  return i;
+}
+
+int Params::get_param_vector(char *s, vector < int > &p){
+  const Param_Entry & e = Params::param_entry[Params::get_vector_entry(s)];
+  p.insert(p.end(), e.int_vector.begin(), e.int_vector.end());
+  return e.int_vector.size();
 }
 
 int Params::get_param_vector(char *s, vector < double > &p){
-  char str[MAX_PARAM_SIZE];
-  int n;
-  char *pch;
-  double v;
-  Params::get_param(s, str);
-  pch = strtok(str," ");
-  if (sscanf(pch, "%d", &n) == 1) {
-    for (int i = 0; i < n; i++) {
-      pch = strtok (NULL, " ");
-      if (pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s); 
-      }
-      sscanf(pch, "%lf", &v);
-      p.push_back(v);
-    }
-  }
-  else {
-    Utils::fred_abort("Incorrect format for vector %s\n", s); 
-  }
-  return n;
+  const Param_Entry & e = Params::param_entry[Params::get_vector_entry(s)];
+  p.insert(p.end(), e.double_vector.begin(), e.double_vector.end());
+  return e.double_vector.size();
 }
 
 int Params::get_param_vector(char *s, double *p) {
-  char str[MAX_PARAM_SIZE];
-  int n;
-  char *pch;
-  Params::get_param(s, str);
-  pch = strtok(str, " ");
-  if (sscanf(pch, "%d", &n) == 1) {
-    for (int i = 0; i < n; i++) {
-      pch = strtok(NULL, " ");
-      if (pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s);
-      }
-      sscanf(pch, "%lf", &p[i]);
-    }
-  } else {
-    Utils::fred_abort("PARAMS: %s not found\n", s); 
+  const Param_Entry & e = Params::param_entry[Params::get_vector_entry(s)];
+  for (int k = 0; k < e.double_vector.size(); k++) {
+    p[k] = e.double_vector[k];
   }
-  return n;
+  return e.double_vector.size();
 }
 
 int Params::get_param_vector(char *s, int *p) {
-  char str[MAX_PARAM_SIZE];
-  int n;
-  char *pch;
-  Params::get_param(s, str);
-  pch = strtok(str, " ");
-  if (sscanf(pch, "%d", &n) == 1) {
-    for (int i = 0; i < n; i++) {
-      pch = strtok(NULL, " ");
-      if (pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s);
-      }
-      sscanf(pch, "%d", &p[i]);
-    }
-  } else {
-    Utils::fred_abort(""); 
+  const Param_Entry & e = Params::param_entry[Params::get_vector_entry(s)];
+  for (int k = 0; k < e.int_vector.size(); k++) {
+    p[k] = e.int_vector[k];
   }
-  return n;
+  return e.int_vector.size();
 }
 
 
@@ -381,9 +381,7 @@ int Params::get_param_matrix(char *s, double ***p) {
   int n = 0;
   Params::get_param((char *) s, &n);
   if (n) {
-    double *tmp;
-    tmp = new double[n];
-    Params::get_param_vector((char *) s, tmp);
+    const double *tmp = &(Params::param_entry[Params::get_vector_entry(s)].double_vector[0]);
     int temp_n = (int) sqrt((double) n);
     if (n != temp_n * temp_n) {
       Utils::fred_abort("Improper matrix dimensions: matricies must be square found dimension %i\n", n); 
@@ -397,7 +395,6 @@ int Params::get_param_matrix(char *s, double ***p) {
         (*p)[i][j] = tmp[i * n + j];
       }
     }
-    delete[] tmp;
     return n;
   }
   return -1;
@@ -472,15 +469,7 @@ int Params::get_double_indexed_param_map(string s, int index_i, int index_j, map
 }
 
 bool Params::does_param_exist(char *s) {
-  
-  bool found = false;
-  for (int i = 0; i < Params::param_count && !found; i++) {
-    if (strcmp(Params::param_name[i], s) == 0) {
-      found = true;
-    }
-  }
-  
-  return found;
+  return Params::find_param(s) >= 0;
 }
 
 bool Params::does_param_exist(string s) {
@@ -488,3 +477,28 @@ bool Params::does_param_exist(string s) {
   sprintf(st,"%s",s.c_str());
   return Params::does_param_exist(st);
 }
+
+void Params::report_usage(FILE *fp) {
+  int unused = 0;
+  int duplicates = 0;
+  for (int i = 0; i < Params::param_count; i++) {
+    const Param_Entry & e = Params::param_entry[i];
+    // only the last definition of a name is looked up
+    if (Params::find_param(Params::param_name[i]) == i && e.uses == 0) {
+      unused++;
+      if (Global::Verbose > 0) {
+        fprintf(fp, "PARAMS: %s is never used\n", Params::param_name[i]);
+      }
+    }
+    if (e.previous >= 0 && Params::param_entry[e.previous].file == e.file) {
+      duplicates++;
+      if (Global::Verbose > 0) {
+        fprintf(fp, "PARAMS: %s is defined more than once in %s\n", Params::param_name[i],
+            e.file == 0 ? "params.default" : "the params file");
+      }
+    }
+  }
+  fprintf(fp, "PARAMS: %d parameters, %d never used, %d defined more than once in the same file\n",
+      Params::param_count, unused, duplicates);
+  fflush(fp);
+}
@@ -18,6 +18,8 @@
 
 #define MAX_PARAMS 1000
 #define MAX_PARAM_SIZE 1024
+// size of the hash index over parameter names; a power of two, at least twice MAX_PARAMS
+#define PARAM_INDEX_SIZE 2048
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -34,6 +36,10 @@ using namespace std;
  * <code>Params::method_name()</code>, which in turn makes it clear for code maintenance where the actual
  * method resides.
  *
+ * Parameter names are hashed into an open-addressing index when the parameters are read, and each value
+ * is parsed once, as a number and as a vector, at the same time; lookups cost one hash probe sequence and
+ * a copy, independent of the number of parameters.  If a parameter is defined more than once, the last
+ * definition is used (so the params file overrides params.default).
  */
 class Params {
 
@@ -131,6 +137,13 @@ class Params {
      */
     static bool does_param_exist(string s);
 
+    /**
+     * Print the number of parameters that were never looked up (often misspelled names) and the number
+     * defined more than once in the same file, and list them if verbose.
+     * @param fp the file to print to
+     */
+    static void report_usage(FILE *fp);
+
     template <typename T>
     static int get_param_from_string(string s, T *p){
       char st[80];
@@ -176,6 +189,39 @@ class Params {
     static char param_value[][MAX_PARAM_SIZE];
     static int param_count;
 
+  private:
+    struct Param_Entry {
+      int previous;       // earlier definition of the same name, or -1
+      int file;           // 0 for params.default, 1 for the params file
+      int uses;
+      // pre-parsed values; a status is the sscanf result: 1 parsed, 0 no match, EOF if empty
+      int int_status;
+      int ulong_status;
+      int double_status;
+      int float_status;
+      int int_value;
+      unsigned long ulong_value;
+      double double_value;
+      float float_value;
+      // values of the form "n v_1 ... v_n": vector_status is 1 if well formed, 0 if there are fewer
+      // than n values, -1 if the value does not start with n
+      int vector_status;
+      vector < int > int_vector;
+      vector < double > double_vector;
+    };
+
+    static Param_Entry param_entry[MAX_PARAMS];
+    // last definition of the names hashed to each slot, or -1
+    static int param_index[PARAM_INDEX_SIZE];
+
+    static int read_parameter_file(char *paramfile, int file);
+    static void add_parameter(int i, int file);
+    static unsigned int hash(const char *s);
+    static int find_param(const char *s);
+    static int use_param(const char *s);
+    static int get_vector_entry(char *s);
+    static void not_found(char *s);
+
 };
 
 #endif // _FRED_PARAMS_H
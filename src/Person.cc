@@ -26,6 +26,7 @@
 #include "Population.h"
 #include "Age_Map.h"
 #include "Transmission.h"
+#include "Checkpoint.h"
 
 #include <cstdio>
 #include <vector>
@@ -144,6 +145,24 @@ string Person::to_string() {
   return tmp_string_stream.str();
 }
 
+void Person::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write( id );
+  checkpoint.write( index );
+  demographics.write_checkpoint( checkpoint );
+  health.write_checkpoint( checkpoint );
+  activities.write_checkpoint( checkpoint );
+  behavior.write_checkpoint( checkpoint );
+}
+
+void Person::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read( id );
+  checkpoint.read( index );
+  demographics.read_checkpoint( checkpoint );
+  health.read_checkpoint( this, checkpoint );
+  activities.read_checkpoint( checkpoint );
+  behavior.read_checkpoint( checkpoint );
+}
+
 void Person::terminate() {
   FRED_VERBOSE(1, "terminating person %d\n", id);
   behavior.terminate( this );
@@ -25,6 +25,7 @@ class Disease;
 class Infection;
 class Population;
 class Transmission;
+class Checkpoint;
 
 #include "Demographics.h"
 #include "Health.h"
@@ -102,8 +103,13 @@ public:
    * @see Health::update(int day)
    */
   void update_health(int day) { health.update( this, day ); }
+
+  void update_susceptibility( int disease_id, int day ) {
+    health.update_susceptibility( this, disease_id, day );
+  }
   
-  void update_health_interventions(int day) { health.update_interventions( this, day ); }
+  void update_vaccine_interventions(int day) { health.update_vaccine_interventions( this, day ); }
+  void update_av_interventions(int day) { health.update_av_interventions( this, day ); }
 
   /**
    * @param day the simulation day
@@ -191,6 +197,17 @@ public:
    */
   int get_id() const { return id; }
 
+  /**
+   * Orders people by id, to put lists built by several threads in an order
+   * that does not depend on the threads (see RNG_Stream)
+   */
+  static bool compare_id( const Person * p1, const Person * p2 ) { return p1->id < p2->id; }
+
+  /**
+   * Orders people by population index, the order of a serial sweep
+   */
+  static bool compare_pop_index( const Person * p1, const Person * p2 ) { return p1->index < p2->index; }
+
   /**
    * @return a pointer to this Person's Demographics
    */
@@ -471,8 +488,8 @@ public:
   void setup_behavior() { behavior.setup( this ); }
   bool is_health_decision_maker() { return behavior.is_health_decision_maker(); }
   Person * get_health_decision_maker() { return behavior.get_health_decision_maker(); }
-  void set_health_decision_maker(Person * p) { behavior.set_health_decision_maker(p); }
-  void become_health_decision_maker() { behavior.become_health_decision_maker(); }
+  void set_health_decision_maker(Person * p) { behavior.set_health_decision_maker( this, p ); }
+  void become_health_decision_maker() { behavior.become_health_decision_maker( this ); }
   bool adult_is_staying_home() { return behavior.adult_is_staying_home(); }
   bool child_is_staying_home() { return behavior.child_is_staying_home(); }
   bool acceptance_of_vaccine() { return behavior.acceptance_of_vaccine(); }
@@ -531,6 +548,13 @@ protected:
   void setup(int index, int id, int age, char sex, int race, int rel, Place *house,
    Place *school, Place *work, int day, bool today_is_birthday);
 
+  /**
+   * Write the Person's state to a checkpoint, or read it back into a newly
+   * constructed Person in the same slot of the population (see Checkpoint)
+   */
+  void write_checkpoint( Checkpoint & checkpoint );
+  void read_checkpoint( Checkpoint & checkpoint );
+
 
 };
 
@@ -14,11 +14,14 @@
 // File: Place.cc
 //
 
+#include <algorithm>
+
 #include "Place.h"
 #include "Global.h"
 #include "Params.h"
 #include "Person.h"
 #include "Disease.h"
+#include "Epidemic.h"
 #include "Infection.h"
 #include "Transmission.h"
 #include "Date.h"
@@ -28,7 +31,11 @@
 #include "Cell.h"
 #include "Small_Grid.h"
 #include "Small_Cell.h"
+#include "Checkpoint.h"
+
 
+Place_Staging Place::Visitor_Staging[ Global::MAX_NUM_DISEASES ];
+State< Contact_Sampler > Place::Contact_Samplers;
 
 void Place::setup( const char *lab, fred::geo lon, fred::geo lat, Place* cont, Population *pop ) {
   population = pop;
@@ -117,25 +124,47 @@ void Place::print(int disease_id) {
 }
 
 void Place::enroll(Person * per) {
-  enrollees.push_back(per);
+  add_enrollee(per);
   N++;
 }
 
 void Place::unenroll(Person * per) {
+  remove_enrollee(per);
   N--;
 }
 
+void Place::remove_enrollee(Person * per) {
+  for (int i = (int) enrollees.size() - 1; i >= 0; i--) {
+    if (enrollees[i] == per) {
+      enrollees[i] = enrollees.back();
+      enrollees.pop_back();
+      return;
+    }
+  }
+}
+
 void Place::add_susceptible(int disease_id, Person * per) {
-  place_state[ disease_id ]().add_susceptible( per );
+  if ( Global::Enable_Lock_Free_Staging ) {
+    Visitor_Staging[ disease_id ].add_susceptible( id, per );
+  }
+  else {
+    place_state[ disease_id ]().add_susceptible( per );
+  }
 }
 
 void Place::add_infectious(int disease_id, Person * per) {
-  place_state[ disease_id ]().add_infectious( per );
+  if ( Global::Enable_Lock_Free_Staging ) {
+    Visitor_Staging[ disease_id ].add_infectious( id, per );
+  }
+  else {
+    place_state[ disease_id ]().add_infectious( per );
+  }
   
-  if ( !( infectious_bitset.test( disease_id ) ) ) {
+  // test and set at once, so that the place is listed only once however
+  // many threads add infectious visitors to it
+  if ( !( infectious_bitset.test_and_set( disease_id ) ) ) {
     Disease * dis = population->get_disease( disease_id );
     dis->add_infectious_place( this, type );
-    infectious_bitset.set( disease_id );
   }
 
   #pragma omp atomic
@@ -209,9 +238,8 @@ double Place::get_contact_rate(int day, int disease_id) {
   return contacts;
 }
 
-int Place::get_contact_count(Person * infector, int disease_id, int day, double contact_rate) {
+int Place::get_contact_count(double infectivity, double contact_rate) {
   // reduce number of infective contacts by infector's infectivity
-  double infectivity = infector->get_infectivity(disease_id, day);
   double infector_contacts = contact_rate * infectivity;
 
   FRED_VERBOSE( 1, "infectivity = %f, so ", infectivity );
@@ -227,13 +255,12 @@ int Place::get_contact_count(Person * infector, int disease_id, int day, double
   return contact_count;
 }
 
-void Place::attempt_transmission(double transmission_prob, Person * infector, 
-                                        Person * infectee, int disease_id, int day) {
+void Place::attempt_transmission(double transmission_prob, double susceptibility,
+    Person * infector, Person * infectee, int disease_id, int day) {
 
   assert( infectee->is_susceptible( disease_id ) );
   FRED_STATUS(1,"infectee is susceptible\n","");
   
-  double susceptibility = infectee->get_susceptibility(disease_id);
   FRED_VERBOSE( 2, "susceptibility = %f\n", susceptibility );
 
   double r = RANDOM();
@@ -242,6 +269,11 @@ void Place::attempt_transmission(double transmission_prob, Person * infector,
       "transmission failed: r = %f  prob = %f\n", r, infection_prob );
 
   if (r < infection_prob) {
+    if ( RNG::counter_streams ) {
+      // takes effect when all places have spread infection today
+      population->get_disease( disease_id )->get_epidemic()->add_pending_transmission( infector, infectee, this );
+      return;
+    }
     // successful transmission; create a new infection in infectee
     Transmission transmission = Transmission(infector, this, day);
     infector->infect( infectee, disease_id, transmission );
@@ -258,75 +290,154 @@ void Place::attempt_transmission(double transmission_prob, Person * infector,
 
 void Place::spread_infection(int day, int disease_id) {
   // Place::spread_infection is used for all derived places except for Households
+  Spread_Context context;
+  if ( prepare_spread_infection( day, disease_id, context ) ) {
+    spread_infection_range( day, disease_id, context, 0, context.number_infectious );
+  }
+}
 
-  if ( is_open( day ) == false ) return;
-  if ( should_be_open( day, disease_id ) == false ) return;
+bool Place::prepare_spread_infection(int day, int disease_id, Spread_Context & context) {
+  if ( is_open( day ) == false ) return false;
+  if ( should_be_open( day, disease_id ) == false ) return false;
 
   if (first_day_infectious == -1) first_day_infectious = day;
   last_day_infectious = day;
 
-  Place_State_Merge place_state_merge = Place_State_Merge();
-  place_state[ disease_id ].apply( place_state_merge );
-  std::vector< Person * > & susceptibles = place_state_merge.get_susceptible_vector();
-  std::vector< Person * > & infectious = place_state_merge.get_infectious_vector();
+  if ( Global::Enable_Lock_Free_Staging ) {
+    // visitors were bucketed by Epidemic::transmit
+    context.susceptibles = Visitor_Staging[ disease_id ].get_susceptibles( id, & context.number_susceptibles );
+    context.infectious = Visitor_Staging[ disease_id ].get_infectious( id, & context.number_infectious );
+  }
+  else {
+    place_state[ disease_id ].apply( context.place_state_merge );
+    std::vector< Person * > & s = context.place_state_merge.get_susceptible_vector();
+    std::vector< Person * > & i = context.place_state_merge.get_infectious_vector();
+    context.number_susceptibles = s.size();
+    context.number_infectious = i.size();
+    context.susceptibles = context.number_susceptibles > 0 ? &( s[ 0 ] ) : NULL;
+    context.infectious = context.number_infectious > 0 ? &( i[ 0 ] ) : NULL;
+  }
   // need at least one susceptible
-  if ( susceptibles.size() == 0 ) { return; }
+  if ( context.number_susceptibles == 0 ) { return false; }
   // the number of possible infectees per infector is max of (N-1) and S[s]
   // where N is the capacity of this place and S[s] is the number of current susceptibles
   // visiting this place. S[s] might exceed N if we have some ad hoc visitors,
   // since N is estimated only at startup.
-  int number_targets = ( N - 1 > susceptibles.size() ? N - 1 : susceptibles.size() );
+  context.number_targets = ( N - 1 > context.number_susceptibles ? N - 1 : context.number_susceptibles );
 
   // contact_rate is contacts_per_day with weeked and seasonality modulation (if applicable)
-  double contact_rate = get_contact_rate(day,disease_id);
+  context.contact_rate = get_contact_rate(day,disease_id);
+  context.epidemic = population->get_disease( disease_id )->get_epidemic();
+
+  RNG_Stream stream( RNG_Stream::PLACE_SPREAD, day, id, disease_id );
+  if ( RNG::counter_streams ) {
+    // the visitors were added in thread order
+    sort( context.infectious, context.infectious + context.number_infectious, Person::compare_id );
+    sort( context.susceptibles, context.susceptibles + context.number_susceptibles, Person::compare_id );
+  }
 
   // randomize the order of the infectious list
-  FYShuffle<Person *>( infectious );
+  FYShuffle<Person *>( context.infectious, context.number_infectious );
+
+  // on busy days in large places, draw only the contacts that can transmit
+  // (see Contact_Sampler::sample_skip_ahead); this needs the most susceptible
+  // member of each contact group
+  context.number_groups = 0;
+  context.skip_ahead = Global::Enable_Skip_Ahead_Transmission
+    && context.number_targets >= Global::Skip_Ahead_Min_Place_Size
+    && context.number_infectious * context.contact_rate >= context.number_susceptibles
+    && get_susceptible_groups( disease_id, context.susceptibles, context.number_susceptibles,
+        context.group_member, context.group_max_susceptibility, & context.number_groups );
+  return true;
+}
+
+void Place::spread_infection_range(int day, int disease_id, Spread_Context & context,
+    int first_infector, int last_infector) {
+  Person ** susceptibles = context.susceptibles;
+  int number_susceptibles = context.number_susceptibles;
+  int number_targets = context.number_targets;
+  Epidemic * epidemic = context.epidemic;
 
-  for ( int infector_pos = 0; infector_pos < infectious.size(); ++infector_pos ) {
+  for ( int infector_pos = first_infector; infector_pos < last_infector; ++infector_pos ) {
     // infectious visitor
-    Person * infector = infectious[ infector_pos ];
+    Person * infector = context.infectious[ infector_pos ];
     assert( infector->get_health()->is_infectious( disease_id ) );
+    RNG_Stream stream( RNG_Stream::INFECTOR_SPREAD, day, id,
+        infector_pos * Global::MAX_NUM_DISEASES + disease_id );
     
     // get the actual number of contacts to attempt to infect
-    int contact_count = get_contact_count( infector, disease_id, day, contact_rate );
+    int contact_count = get_contact_count( epidemic->get_infectivity( infector->get_pop_index() ),
+        context.contact_rate );
     
-    std::map< int, int > sampling_map;
     // get a susceptible target for each contact resulting in infection
-    for (int c = 0; c < contact_count; ++c) {
-      // select a target infectee from among susceptibles with replacement
-      int pos = IRAND( 0, number_targets - 1 );
-      if ( pos < susceptibles.size() ) {
-        if ( infector == susceptibles[ pos ] ) {
-          if ( susceptibles.size() > 1 ) {
-            --( c ); // redo
-            continue;
-          }
-          else {
-            break; // give up
-          }
-        }
-        sampling_map[ pos ]++;
+    Contact_Sampler & sampler = Contact_Samplers();
+    double max_prob = 1.0;
+    bool infector_skips_ahead = false;
+    if ( context.skip_ahead && !( infector->is_susceptible( disease_id ) ) ) {
+      max_prob = 0.0;
+      for ( int g = 0; g < context.number_groups; ++g ) {
+        double prob = get_transmission_prob( disease_id, infector, context.group_member[ g ] )
+          * context.group_max_susceptibility[ g ];
+        if ( prob > max_prob ) { max_prob = prob; }
       }
+      infector_skips_ahead = ( max_prob <= 1.0 );
+    }
+    if ( infector_skips_ahead ) {
+      sampler.sample_skip_ahead( contact_count, number_targets, number_susceptibles, max_prob );
+    }
+    else {
+      max_prob = 1.0;
+      sampler.sample( contact_count, number_targets, susceptibles, number_susceptibles, infector );
     }
 
-    std::map< int, int >::iterator i;
-    for ( i = sampling_map.begin(); i != sampling_map.end(); ++i ) {
-      int pos = (*i).first;
-      int times_drawn = (*i).second;
+    for ( int i = 0; i < sampler.size(); ++i ) {
+      int pos = sampler.get_position( i );
+      int times_drawn = sampler.get_times_drawn( i );
       Person * infectee = susceptibles[ pos ];
-      // get the transmission probs for this infector/infectee pair
-      double transmission_prob = get_transmission_prob(disease_id, infector, infectee);
+      // get the transmission probs for this infector/infectee pair; skip-ahead
+      // candidates are accepted in proportion to it
+      double transmission_prob = get_transmission_prob(disease_id, infector, infectee) / max_prob;
+      double susceptibility = epidemic->get_susceptibility( infectee->get_pop_index() );
       for ( int draw = 0; draw < times_drawn; ++draw ) {
         // only proceed if person is susceptible
         if ( infectee->is_susceptible( disease_id ) ) {
-          attempt_transmission( transmission_prob, infector, infectee, disease_id, day );
+          attempt_transmission( transmission_prob, susceptibility, infector, infectee, disease_id, day );
         }
       }
     } // end contact loop
   } // end infectious list loop
 }
 
+bool Place::get_susceptible_groups( int disease_id, Person ** susceptibles, int number_susceptibles,
+    Person ** group_member, double * group_max_susceptibility, int * number_groups ) {
+  *number_groups = 0;
+  for ( int i = 0; i < number_susceptibles; ++i ) {
+    int g = get_group( disease_id, susceptibles[ i ] );
+    if ( g < 0 || g >= SKIP_AHEAD_MAX_GROUPS ) { return false; }
+    while ( *number_groups <= g ) {
+      group_member[ *number_groups ] = NULL;
+      group_max_susceptibility[ *number_groups ] = 0.0;
+      ++( *number_groups );
+    }
+    double susceptibility = susceptibles[ i ]->get_susceptibility( disease_id );
+    if ( group_member[ g ] == NULL || susceptibility > group_max_susceptibility[ g ] ) {
+      group_member[ g ] = susceptibles[ i ];
+      group_max_susceptibility[ g ] = susceptibility;
+    }
+  }
+  // drop groups with no susceptibles present
+  int n = 0;
+  for ( int g = 0; g < *number_groups; ++g ) {
+    if ( group_member[ g ] != NULL ) {
+      group_member[ n ] = group_member[ g ];
+      group_max_susceptibility[ n ] = group_max_susceptibility[ g ];
+      ++n;
+    }
+  }
+  *number_groups = n;
+  return true;
+}
+
 Place * Place::select_neighborhood(double community_prob, double community_distance, double local_prob) {
   return grid_cell->select_neighborhood(community_prob, community_distance, local_prob);
 }
@@ -337,10 +448,12 @@ Place * Place::select_new_neighborhood(double community_prob, double community_d
 
 void Place::turn_workers_into_teachers(Place *school) {
   int new_teachers = 0;
-  for (int i = 0; i < (int) enrollees.size(); i++) {
-    if (enrollees[i]->become_a_teacher(school)) new_teachers++;
+  // becoming a teacher unenrolls from this workplace, so work from a copy
+  vector<Person *> workers = enrollees;
+  for (int i = 0; i < (int) workers.size(); i++) {
+    if (workers[i]->become_a_teacher(school)) new_teachers++;
     // printf("new teacher %d age %d moving from workplace %s to school %s\n",
-    // enrollees[i]->get_id(), enrollees[i]->get_age(), label, school->get_label());
+    // workers[i]->get_id(), workers[i]->get_age(), label, school->get_label());
   }
   FRED_VERBOSE(0, "%d new teachers reassigned from workplace %s to school %s\n",
 	 new_teachers, label, school->get_label());
@@ -381,3 +494,39 @@ Small_Cell * Place::get_small_grid_cell() {
   return Global::Small_Cells->get_grid_cell(latitude, longitude);
 }
  
+
+void Place::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write(infectious_bitset);
+  checkpoint.write_people(enrollees);
+  checkpoint.write(close_date);
+  checkpoint.write(open_date);
+  checkpoint.write(N);
+  checkpoint.write(new_infections);
+  checkpoint.write(current_infections);
+  checkpoint.write(total_infections);
+  checkpoint.write(new_symptomatic_infections);
+  checkpoint.write(current_symptomatic_infections);
+  checkpoint.write(total_symptomatic_infections);
+  checkpoint.write(current_infectious_visitors);
+  checkpoint.write(current_symptomatic_visitors);
+  checkpoint.write(first_day_infectious);
+  checkpoint.write(last_day_infectious);
+}
+
+void Place::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read(infectious_bitset);
+  checkpoint.read_people(enrollees);
+  checkpoint.read(close_date);
+  checkpoint.read(open_date);
+  checkpoint.read(N);
+  checkpoint.read(new_infections);
+  checkpoint.read(current_infections);
+  checkpoint.read(total_infections);
+  checkpoint.read(new_symptomatic_infections);
+  checkpoint.read(current_symptomatic_infections);
+  checkpoint.read(total_symptomatic_infections);
+  checkpoint.read(current_infectious_visitors);
+  checkpoint.read(current_symptomatic_visitors);
+  checkpoint.read(first_day_infectious);
+  checkpoint.read(last_day_infectious);
+}
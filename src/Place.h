@@ -37,11 +37,15 @@ using namespace std;
 #include "Random.h"
 #include "Global.h"
 #include "State.h"
+#include "Place_Staging.h"
+#include "Contact_Sampler.h"
 #include "Geo_Utils.h"
 
 class Cell;
 class Small_Cell;
 class Person;
+class Epidemic;
+class Checkpoint;
 
 
 struct Place_State {
@@ -168,6 +172,14 @@ public:
    */
   virtual void unenroll(Person * per);
 
+  /**
+   * Write the state of the place that changes during a run -- its enrollees,
+   * open and close dates and infection counts -- to a checkpoint, or read it
+   * back (see Checkpoint).  Subclasses with state of their own extend these.
+   */
+  virtual void write_checkpoint(Checkpoint & checkpoint);
+  virtual void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Add a susceptible person to the place. This method adds the person to the susceptibles vector.
    *
@@ -206,6 +218,48 @@ public:
    */
   virtual void spread_infection(int day, int disease_id);
 
+  // contact groups (see get_group) supported by skip-ahead transmission
+  static const int SKIP_AHEAD_MAX_GROUPS = 8;
+
+  /**
+   * Today's visitors and contact parameters for spread_infection, gathered once
+   * so that the infectious visitors of a large place can be divided among
+   * several tasks (see Epidemic::transmit).
+   */
+  struct Spread_Context {
+    Person ** susceptibles;
+    Person ** infectious;
+    int number_susceptibles;
+    int number_infectious;
+    int number_targets;
+    double contact_rate;
+    // today's infectivities and susceptibilities for this disease
+    Epidemic * epidemic;
+    bool skip_ahead;
+    Person * group_member[ SKIP_AHEAD_MAX_GROUPS ];
+    double group_max_susceptibility[ SKIP_AHEAD_MAX_GROUPS ];
+    int number_groups;
+    // owns the visitor lists when lock-free staging is not used
+    Place_State_Merge place_state_merge;
+  };
+
+  /**
+   * First half of spread_infection: collect and shuffle today's visitors.
+   *
+   * @param day the simulation day
+   * @param disease_id an integer representation of the disease
+   * @param context filled in for spread_infection_range
+   * @return <code>false</code> if there is nothing to spread today
+   */
+  bool prepare_spread_infection(int day, int disease_id, Spread_Context & context);
+
+  /**
+   * Second half of spread_infection: spread from the infectious visitors in
+   * positions [first_infector, last_infector) of a prepared context.
+   */
+  void spread_infection_range(int day, int disease_id, Spread_Context & context,
+      int first_infector, int last_infector);
+
   /**
    * Is the place open on a given day?
    *
@@ -312,6 +366,14 @@ public:
    */
   int get_size() { return N; }
 
+  /**
+   * Get the people enrolled in this place (see enroll and unenroll); in no
+   * particular order.
+   *
+   * @return the enrolled people
+   */
+  const vector<Person *> & get_enrollees() { return enrollees; }
+
   /**
    * Get the simulation day (an integer value of days from the start of the simulation) when the place will close.
    *
@@ -410,26 +472,26 @@ public:
   double get_x() { return Geo_Utils::get_x(longitude); }
   double get_y() { return Geo_Utils::get_y(latitude); }
 
-  int add_new_infection(int disease_id) { 
+  void add_new_infection(int disease_id) { 
     #pragma omp atomic
     new_infections[disease_id]++; 
     #pragma omp atomic
     total_infections[disease_id]++;
   }
 
-  int add_current_infection(int disease_id) {
+  void add_current_infection(int disease_id) {
     #pragma omp atomic
     current_infections[disease_id]++; 
   }
 
-  int add_new_symptomatic_infection(int disease_id) { 
+  void add_new_symptomatic_infection(int disease_id) { 
     #pragma omp atomic
     new_symptomatic_infections[disease_id]++; 
     #pragma omp atomic
     total_symptomatic_infections[disease_id]++;
   }
 
-  int add_current_symptomatic_infection(int disease_id) { 
+  void add_current_symptomatic_infection(int disease_id) { 
     #pragma omp atomic
     current_symptomatic_infections[disease_id]++; 
   }
@@ -517,7 +579,23 @@ public:
   int get_first_day_infectious() { return first_day_infectious; }
   int get_last_day_infectious() { return last_day_infectious; }
 
+  /**
+   * Lock-free per-thread visitor staging, one per disease; used in place of
+   * place_state when Global::Enable_Lock_Free_Staging is set.
+   */
+  static Place_Staging Visitor_Staging[ Global::MAX_NUM_DISEASES ];
+
+  /**
+   * Per-thread reusable contact buffers for spread_infection; set up
+   * by Place_List::prepare.
+   */
+  static State< Contact_Sampler > Contact_Samplers;
+
 protected:
+  // keep the enrollees list; used by the enroll and unenroll overrides
+  void add_enrollee(Person * per) { enrollees.push_back(per); }
+  void remove_enrollee(Person * per);
+
   // state array contains:
   //  - list of susceptible visitors (per disease); size of which gives the susceptibles count
   //  - list of infectious visitors (per disease); size of which gives the infectious count
@@ -560,8 +638,18 @@ protected:
   int last_day_infectious;
 
   double get_contact_rate(int day, int disease_id);
-  int get_contact_count(Person * infector, int disease_id, int day, double contact_rate);
-  void attempt_transmission(double transmission_prob, Person * infector, Person * infectee, int disease_id, int day);
+  int get_contact_count(double infectivity, double contact_rate);
+  void attempt_transmission(double transmission_prob, double susceptibility,
+      Person * infector, Person * infectee, int disease_id, int day);
+
+  /**
+   * For each contact group present among the susceptibles, find the member
+   * with the largest susceptibility.  Empty groups are omitted.
+   *
+   * @return false if a group number is outside [0, SKIP_AHEAD_MAX_GROUPS)
+   */
+  bool get_susceptible_groups(int disease_id, Person ** susceptibles, int number_susceptibles,
+      Person ** group_member, double * group_max_susceptibility, int * number_groups);
 
   // Place_List, Grid and Cell are friends so that they can access
   // the Place Allocator.  
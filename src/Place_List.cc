@@ -44,6 +44,8 @@
 #include "Seasonality.h"
 #include "Random.h"
 #include "Utils.h"
+#include "Population_Snapshot.h"
+#include "Checkpoint.h"
 
 // Place_List::quality_control implementation is very large,
 // include from separate .cc file:
@@ -57,6 +59,7 @@ void Place_List::get_parameters() {
   Params::get_param_from_string("synthetic_population_directory", Global::Synthetic_population_directory);
   Params::get_param_from_string("synthetic_population_id", Global::Synthetic_population_id);
   Params::get_param_from_string("synthetic_population_version", Global::Synthetic_population_version);
+  Params::get_param_from_string("population_snapshot_file", Global::Population_snapshot_file);
   Params::get_param_from_string("city", Global::City);
   Params::get_param_from_string("county", Global::County);
   Params::get_param_from_string("state", Global::US_state);
@@ -296,8 +299,10 @@ void Place_List::read_all_places( const std::vector< Utils::Tokens > & Demes ) {
   place_type_counts[ OFFICE ] = 0;          // 'O'
   place_type_counts[ COMMUNITY ] = 0;       // 'X'
   
-  // vector to hold init data
+  // set to hold init data
   InitSetT pids;
+  // init data in the order in which places are created
+  std::vector< Place_Init_Data > place_init_data;
   
   // only one population directory allowed at this point
   const char * pop_dir = Global::Synthetic_population_directory;
@@ -306,15 +311,34 @@ void Place_List::read_all_places( const std::vector< Utils::Tokens > & Demes ) {
   assert( Demes.size() > 0 );
   assert( Demes.size() <= std::numeric_limits< unsigned char >::max() );
 
-  // and each deme must contain at least one synthetic population id
-  for ( int d = 0; d < Demes.size(); ++d ) { 
-    FRED_STATUS( 0, "Reading Places for Deme %d:\n", d );
-    assert( Demes[ d ].size() > 0 );
-    for ( int i = 0; i < Demes[ d ].size(); ++i ) {
-      // o---------------------------------------- Call read_places to actually
-      // |                                         read the population files
-      // V
-      read_places( pop_dir, Demes[ d ][ i ], d, pids );
+  if ( strcmp( Global::Population_snapshot_file, "none" ) != 0 ) {
+    Global::Pop_Snapshot = new Population_Snapshot( Global::Population_snapshot_file,
+        get_population_fingerprint( Demes ) );
+    Global::Pop_Snapshot->load();
+  }
+
+  if ( Global::Pop_Snapshot != NULL && Global::Pop_Snapshot->is_loaded() ) {
+    Global::Pop_Snapshot->get_place_init_data( place_init_data );
+    for ( int i = 0; i < place_init_data.size(); ++i ) {
+      ++( place_type_counts[ place_init_data[ i ].place_type ] );
+    }
+  }
+  else {
+    // and each deme must contain at least one synthetic population id
+    for ( int d = 0; d < Demes.size(); ++d ) { 
+      FRED_STATUS( 0, "Reading Places for Deme %d:\n", d );
+      assert( Demes[ d ].size() > 0 );
+      for ( int i = 0; i < Demes[ d ].size(); ++i ) {
+        // o---------------------------------------- Call read_places to actually
+        // |                                         read the population files
+        // V
+        read_places( pop_dir, Demes[ d ][ i ], d, pids );
+      }
+    }
+    place_init_data.assign( pids.begin(), pids.end() );
+    pids.clear();
+    if ( Global::Pop_Snapshot != NULL ) {
+      Global::Pop_Snapshot->record_places( place_init_data );
     }
   }
 
@@ -341,8 +365,8 @@ void Place_List::read_all_places( const std::vector< Utils::Tokens > & Demes ) {
   std::vector< Household * > households;
 
   // loop through sorted init data and create objects using Place_Allocator
-  InitSetT::iterator itr = pids.begin();
-  for ( int i = 0; itr != pids.end(); ++itr, ++i ) {
+  std::vector< Place_Init_Data >::iterator itr = place_init_data.begin();
+  for ( int i = 0; itr != place_init_data.end(); ++itr, ++i ) {
     char s[80];
     strcpy( s, (*itr).s );
     char place_type = (*itr).place_type;
@@ -484,6 +508,21 @@ void Place_List::read_all_places( const std::vector< Utils::Tokens > & Demes ) {
 }
 
 
+std::string Place_List::get_population_fingerprint( const std::vector< Utils::Tokens > & Demes ) {
+  // everything that determines which places and people are read
+  std::stringstream ss;
+  ss << "population_directory " << Global::Synthetic_population_directory;
+  for ( int d = 0; d < Demes.size(); ++d ) {
+    ss << " deme " << d << ":";
+    for ( int i = 0; i < Demes[ d ].size(); ++i ) {
+      ss << " " << Demes[ d ][ i ];
+    }
+  }
+  ss << " group_quarters " << Global::Enable_Group_Quarters;
+  ss << " local_workplace_assignment " << Global::Enable_Local_Workplace_Assignment;
+  return ss.str();
+}
+
 void Place_List::read_places( const char * pop_dir, const char * pop_id,
     unsigned char deme_id, InitSetT & pids ) {
 
@@ -692,6 +731,14 @@ void Place_List::prepare() {
     places[p]->prepare();
   }
 
+  Place::Contact_Samplers = State< Contact_Sampler >( fred::omp_get_max_threads() );
+
+  if (Global::Enable_Lock_Free_Staging) {
+    for (int d = 0; d < Global::Diseases; d++) {
+      Place::Visitor_Staging[d].setup(number_places);
+    }
+  }
+
   FRED_STATUS( 0, "deleting place_label_map\n","" );
   delete_place_label_map();
 
@@ -715,6 +762,30 @@ void Place_List::update(int day) {
   FRED_STATUS(1, "update places finished\n", "");
 }
 
+void Place_List::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("places");
+  School::write_static_checkpoint(checkpoint);
+  int number_places = places.size();
+  checkpoint.write(number_places);
+  for ( int p = 0; p < number_places; ++p ) {
+    places[ p ]->write_checkpoint(checkpoint);
+  }
+}
+
+void Place_List::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("places");
+  School::read_static_checkpoint(checkpoint);
+  int number_places;
+  checkpoint.read(number_places);
+  if ( number_places != (int) places.size() ) {
+    Utils::fred_abort("Checkpoint has %d places, but the population has %d\n",
+        number_places, (int) places.size());
+  }
+  for ( int p = 0; p < number_places; ++p ) {
+    places[ p ]->read_checkpoint(checkpoint);
+  }
+}
+
 Place * Place_List::get_place_from_label(char *s) const {
   if (strcmp(s, "-1") == 0) return NULL;
   string str;
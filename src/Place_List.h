@@ -67,9 +67,14 @@ public:
   void read_all_places( const std::vector< Utils::Tokens > & Demes );
   void read_places( const char * pop_dir, const char * pop_id,
       unsigned char deme_id, InitSetT & pids );
+  std::string get_population_fingerprint( const std::vector< Utils::Tokens > & Demes );
 
   void prepare();
   void update(int day);
+
+  /// writes the state of every place to a checkpoint, or reads it back
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
   void quality_control(char * directory);
   void get_parameters();
   Place * get_place_from_label(char *s) const;
@@ -208,6 +213,7 @@ struct Place_Init_Data {
 	      bool _is_group_quarters) {
     place_type = _place_type;
     strcpy( s, _s );
+    deme_id = _deme_id;
     sscanf( _lat, "%f", &lat);
     sscanf( _lon, "%f", &lon);
     sscanf( _income, "%d", & income );
@@ -230,6 +236,20 @@ struct Place_Init_Data {
     setup( _s, _place_type, _lat, _lon, _deme_id, _census_block, _income, _is_group_quarters);
   }
 
+  // already-parsed values (see Population_Snapshot)
+  Place_Init_Data( const char * _s, char _place_type, fred::geo _lat, fred::geo _lon,
+		   unsigned char _deme_id, string _census_block, int _income,
+		   bool _is_group_quarters ) {
+    place_type = _place_type;
+    strcpy( s, _s );
+    deme_id = _deme_id;
+    lat = _lat;
+    lon = _lon;
+    income = _income;
+    census_block = _census_block;
+    is_group_quarters = _is_group_quarters;
+  }
+
   bool operator< ( const Place_Init_Data & other ) const {
 
     if ( place_type != other.place_type ) {
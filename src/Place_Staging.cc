@@ -0,0 +1,97 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Place_Staging.cc
+//
+
+#include "Place_Staging.h"
+#include "Place.h"
+
+void Place_Staging::setup( int _number_of_places ) {
+  number_of_places = _number_of_places;
+  thread_buffers = State< Buffer >( fred::omp_get_max_threads() );
+  thread_buffers.reset();
+  susceptible_runs.resize( number_of_places );
+  infectious_runs.resize( number_of_places );
+  is_bucketed.assign( number_of_places, 0 );
+  bucketed_places.clear();
+}
+
+void Place_Staging::bucket( std::vector< std::vector< Place * > * > & place_lists ) {
+  // collect the distinct places that may have staged visitors
+  for ( int l = 0; l < place_lists.size(); ++l ) {
+    std::vector< Place * > & places = *( place_lists[ l ] );
+    for ( int i = 0; i < places.size(); ++i ) {
+      int place_index = places[ i ]->get_id();
+      if ( !( is_bucketed[ place_index ] ) ) {
+        is_bucketed[ place_index ] = 1;
+        bucketed_places.push_back( place_index );
+      }
+    }
+  }
+
+  #pragma omp parallel sections
+  {
+    #pragma omp section
+    bucket_list( susceptible_runs, &Buffer::susceptibles );
+    #pragma omp section
+    bucket_list( infectious_runs, &Buffer::infectious );
+  }
+}
+
+void Place_Staging::bucket_list( Runs & runs, std::vector< Entry > Buffer::* list ) {
+  // count the visitors for each place; end[] doubles as the counter
+  for ( int i = 0; i < bucketed_places.size(); ++i ) {
+    runs.end[ bucketed_places[ i ] ] = 0;
+  }
+  for ( int t = 0; t < thread_buffers.size(); ++t ) {
+    std::vector< Entry > & entries = thread_buffers( t ).*list;
+    for ( int e = 0; e < entries.size(); ++e ) {
+      assert( is_bucketed[ entries[ e ].place_index ] );
+      ++( runs.end[ entries[ e ].place_index ] );
+    }
+  }
+
+  // assign each place its run; end[] now becomes the insertion cursor
+  int total = 0;
+  for ( int i = 0; i < bucketed_places.size(); ++i ) {
+    int place_index = bucketed_places[ i ];
+    runs.begin[ place_index ] = total;
+    total += runs.end[ place_index ];
+    runs.end[ place_index ] = runs.begin[ place_index ];
+  }
+  if ( runs.people.size() < total ) {
+    runs.people.resize( total );
+  }
+
+  // scatter, preserving thread order and insertion order within each thread
+  for ( int t = 0; t < thread_buffers.size(); ++t ) {
+    std::vector< Entry > & entries = thread_buffers( t ).*list;
+    for ( int e = 0; e < entries.size(); ++e ) {
+      runs.people[ ( runs.end[ entries[ e ].place_index ] )++ ] = entries[ e ].person;
+    }
+  }
+}
+
+void Place_Staging::clear() {
+  for ( int i = 0; i < bucketed_places.size(); ++i ) {
+    int place_index = bucketed_places[ i ];
+    susceptible_runs.begin[ place_index ] = -1;
+    susceptible_runs.end[ place_index ] = 0;
+    infectious_runs.begin[ place_index ] = -1;
+    infectious_runs.end[ place_index ] = 0;
+    is_bucketed[ place_index ] = 0;
+  }
+  bucketed_places.clear();
+  thread_buffers.clear();
+}
@@ -0,0 +1,161 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Place_Staging.h
+//
+
+#ifndef _FRED_PLACE_STAGING_H
+#define _FRED_PLACE_STAGING_H
+
+/*
+ * Lock-free alternative to the per-place State< Place_State > visitor lists.
+ *
+ * During the daily population sweeps each thread appends (place index, person)
+ * pairs to its own append-only buffers; no locks are taken.  Once the sweeps
+ * are finished, bucket() performs a stable counting sort of all thread buffers
+ * into one flat array per list, so that the visitors of each infectious place
+ * occupy a contiguous run.  Buffers and arrays keep their capacity from day to
+ * day, so after the first few days no memory is allocated.
+ *
+ * Because thread buffers are concatenated in thread order, single-threaded
+ * runs see exactly the same visitor order as with Place_State.
+ *
+ * Enabled with the parameter enable_lock_free_staging (see Global.h)
+ */
+
+#include <vector>
+
+#include "Global.h"
+#include "State.h"
+
+class Place;
+class Person;
+
+class Place_Staging {
+
+  struct Entry {
+    int place_index;
+    Person * person;
+    Entry( int _place_index, Person * _person ) :
+      place_index( _place_index ), person( _person ) { }
+  };
+
+  // one buffer per thread; padded to keep threads off each other's cache lines
+  struct Buffer {
+    std::vector< Entry > susceptibles;
+    std::vector< Entry > infectious;
+    char padding[ 64 ];
+
+    void clear() {
+      susceptibles.clear();
+      infectious.clear();
+    }
+
+    void reset() {
+      susceptibles = std::vector< Entry >();
+      infectious = std::vector< Entry >();
+    }
+  };
+
+  // the runs for one list (susceptibles or infectious) after bucketing;
+  // begin/end are indexed by place id
+  struct Runs {
+    std::vector< int > begin;
+    std::vector< int > end;
+    std::vector< Person * > people;
+
+    void resize( int number_of_places ) {
+      begin.assign( number_of_places, -1 );
+      end.assign( number_of_places, 0 );
+    }
+  };
+
+public:
+
+  Place_Staging() : number_of_places( 0 ) { }
+
+  /**
+   * Allocate the per-thread buffers and the per-place run offsets.
+   * Must be called after all places have been added to the Place_List.
+   *
+   * @param _number_of_places the number of places (place ids are dense)
+   */
+  void setup( int _number_of_places );
+
+  bool is_setup() { return number_of_places > 0; }
+
+  void add_susceptible( int place_index, Person * per ) {
+    buffers().susceptibles.push_back( Entry( place_index, per ) );
+  }
+
+  void add_infectious( int place_index, Person * per ) {
+    buffers().infectious.push_back( Entry( place_index, per ) );
+  }
+
+  /**
+   * Sort all staged visitors into contiguous runs, one per place.  Every staged
+   * place must appear in one of the supplied lists (the Epidemic's list of
+   * infectious places); a place may appear more than once.
+   *
+   * @param place_lists the lists of places that may have staged visitors
+   */
+  void bucket( std::vector< std::vector< Place * > * > & place_lists );
+
+  /**
+   * Discard all staged visitors; capacity is retained for the next day.
+   */
+  void clear();
+
+  /**
+   * @param place_index the place id
+   * @param count set to the number of susceptibles staged for this place
+   * @return pointer to the first susceptible visitor (only valid after bucket())
+   */
+  Person ** get_susceptibles( int place_index, int * count ) {
+    return get_run( susceptible_runs, place_index, count );
+  }
+
+  /**
+   * @param place_index the place id
+   * @param count set to the number of infectious visitors staged for this place
+   * @return pointer to the first infectious visitor (only valid after bucket())
+   */
+  Person ** get_infectious( int place_index, int * count ) {
+    return get_run( infectious_runs, place_index, count );
+  }
+
+private:
+
+  int number_of_places;
+  State< Buffer > thread_buffers;
+  Runs susceptible_runs;
+  Runs infectious_runs;
+  // places given a run by the last call to bucket()
+  std::vector< int > bucketed_places;
+  std::vector< char > is_bucketed;
+
+  Buffer & buffers() { return thread_buffers(); }
+
+  Person ** get_run( Runs & runs, int place_index, int * count ) {
+    if ( runs.begin[ place_index ] < 0 ) {
+      *count = 0;
+      return NULL;
+    }
+    *count = runs.end[ place_index ] - runs.begin[ place_index ];
+    return *count > 0 ? &( runs.people[ runs.begin[ place_index ] ] ) : NULL;
+  }
+
+  void bucket_list( Runs & runs, std::vector< Entry > Buffer::* list );
+
+};
+
+#endif // _FRED_PLACE_STAGING_H
@@ -21,6 +21,7 @@
 #include <fstream>
 #include <limits>
 #include <set>
+#include <algorithm>
 
 
 #include "Population.h"
@@ -43,9 +44,12 @@
 #include "Evolution.h"
 #include "Activities.h"
 #include "Behavior.h"
-#include "Tracker.h"
+#include "Census_Block_Tracker.h"
 #include "Vaccine_Health.h"
 #include "AV_Health.h"
+#include "Population_Snapshot.h"
+#include "Population_Dump.h"
+#include "Checkpoint.h"
 
 
 #include <snappy.h>
@@ -61,6 +65,7 @@ int death_count_female[Demographics::MAX_AGE + 1];
 char Population::pop_outfile[FRED_STRING_SIZE];
 char Population::output_population_date_match[FRED_STRING_SIZE];
 int  Population::output_population = 0;
+int  Population::output_population_compress = 0;
 bool Population::is_initialized = false;
 int  Population::next_id = 0;
 
@@ -73,10 +78,14 @@ Population::Population() {
   av_manager = NULL;
   vacc_manager = NULL;
   mutation_prob = NULL;
+  population_dump = NULL;
 
   for ( int i = 0; i < 367; ++i ) {
     birthday_vecs[ i ].clear();
   }
+
+  // blq allocates a block in health_blq whenever it adds one of its own
+  blq.link_bloque( &health_blq );
 }
 
 void Population::initialize_masks() {
@@ -84,9 +93,12 @@ void Population::initialize_masks() {
   // available when the Global::Pop is defined
   blq.add_mask( fred::Infectious );
   blq.add_mask( fred::Susceptible );
-  blq.add_mask( fred::Update_Deaths );
-  blq.add_mask( fred::Update_Births );
   blq.add_mask( fred::Update_Health );
+  blq.add_mask( fred::Susceptible_Visitor );
+  blq.add_mask( fred::Symptomatic );
+  blq.add_mask( fred::Takes_Vaccine );
+  blq.add_mask( fred::Takes_AV );
+  blq.add_mask( fred::Decision_Maker );
 }
 
 
@@ -96,6 +108,14 @@ Person * Population::get_person_by_index( int _index ) {
   return blq.get_item_pointer_by_index( _index );
 }
 
+Person * Population::get_person_slot( int _index ) {
+  return blq.get_free_pointer( _index );
+}
+
+Health_Hot_State * Population::get_health_hot_state( int _index ) {
+  return health_blq.get_free_pointer( _index );
+}
+
 //Person * Population::get_person_by_id( int _id ) {
 //  return blq.get_item_pointer_by_index( id_to_index[ _id ] ); 
 //}
@@ -136,6 +156,7 @@ void Population::get_parameters() {
     if(Population::output_population > 0) {
       Params::get_param_from_string("pop_outfile", Population::pop_outfile);
       Params::get_param_from_string("output_population_date_match", Population::output_population_date_match);
+      Params::get_param_from_string("output_population_compress", &Population::output_population_compress);
     }
     Population::is_initialized = true;
   }
@@ -215,6 +236,21 @@ void Population::delete_person(Person * person) {
 
   int idx = person->get_pop_index();
   assert( get_person_by_index( idx ) == person );
+
+  // drop the person's pending events, since the index will be reused
+  Demographics * demographics = person->get_demographics();
+  if ( demographics->is_pregnant() ) {
+    birth_events.cancel( demographics->get_due_sim_day(), idx );
+  }
+  if ( demographics->get_deceased_sim_day() >= 0 ) {
+    death_events.cancel( demographics->get_deceased_sim_day(), idx );
+  }
+  for ( int d = 0; d < Global::Diseases; d++ ) {
+    int susceptible_date = person->get_health()->get_pending_susceptible_date( d );
+    if ( susceptible_date >= 0 ) {
+      susceptibility_events.cancel( susceptible_date, idx * Global::MAX_NUM_DISEASES + d );
+    }
+  }
   // call Person's destructor directly!!!
   get_person_by_index( idx ) -> ~Person();
   blq.mark_invalid_by_index( person->get_pop_index() );
@@ -228,6 +264,17 @@ void Population::delete_person(Person * person) {
   assert( (unsigned) pop_size == blq.size() );
 }
 
+void Population::update_susceptibility( int day ) {
+  susceptibility_events.get_events( day, todays_events );
+  for ( size_t i = 0; i < todays_events.size(); i++ ) {
+    int person_index = todays_events[ i ] / Global::MAX_NUM_DISEASES;
+    int disease_id = todays_events[ i ] % Global::MAX_NUM_DISEASES;
+    if ( blq.is_valid_index( person_index ) ) {
+      get_person_by_index( person_index )->update_susceptibility( disease_id, day );
+    }
+  }
+}
+
 void Population::prepare_to_die( int day, int person_index ) {
   Person * per = get_person_by_index( person_index );
   fred::Scoped_Lock lock( mutex );
@@ -359,15 +406,8 @@ Person_Init_Data Population::get_person_init_data( char * line,
   if ( strcmp( pid.work_label, "-1" ) != 0 && pid.work == NULL ) {
     FRED_VERBOSE( 2, "WARNING: person %s -- no workplace found for label = %s\n",
         pid.label, pid.work_label );
-    if ( Global::Enable_Local_Workplace_Assignment ) {
-      pid.work = Global::Places.get_random_workplace();
-      FRED_CONDITIONAL_VERBOSE( 0, pid.work != NULL,
-          "WARNING: person %s assigned to workplace %s\n",
-          pid.label, pid.work->get_label() );
-      FRED_CONDITIONAL_VERBOSE( 0, pid.work == NULL,
-          "WARNING: no workplace available for person %s\n",
-          pid.label );
-    }
+    // the workplace is drawn by add_persons, in file order
+    pid.random_work = Global::Enable_Local_Workplace_Assignment;
   }
   // warn if we can't find school.  No school for gq_people
   FRED_CONDITIONAL_VERBOSE( 0,
@@ -387,51 +427,150 @@ void Population::parse_lines_from_stream( std::istream & stream,
   while ( stream.good() ) {
     char line[FRED_STRING_SIZE];
     stream.getline( line, FRED_STRING_SIZE );
-    // skip empty lines...
-    if ( ( line[ 0 ] == '\0' ) || strncmp( line, "p_id", 4 ) == 0 ) continue;
-    //printf("line: |%s|\n", line); fflush(stdout); // exit(0);
-    const Person_Init_Data & pid = get_person_init_data( line, Global::Places,
-        is_group_quarters_pop ); 
-    // verbose printing of all person initialization data
-    FRED_VERBOSE( 1, "%s\n", pid.to_string().c_str() );
-    //skip header line
-    if (strcmp(pid.label,"p_id")==0) continue;
-    /*
-    printf("|%s %d %c %d %s %s %s %d|\n", label, age, sex, race
-        house_label, work_label, school_label, relationship);
-    fflush(stdout);
-    
-    if (strcmp(work_label,"-1") && strcmp(school_label,"-1")) {
-      printf("STUDENT-WORKER: %s %d %c %s %s\n", label, age, sex, work_label, school_label);
-      fflush(stdout);
-    }
-    */
-    if ( pid.house != NULL ) {
-      // create a Person_Init_Data object
-      pidv.push_back( pid );
+    parse_line( line, is_group_quarters_pop, pidv );
+  } // <----- end while loop over stream
+
+  // Protect with mutex so that we do this sequentially and avoid thrashing
+  // the scoped mutex in add_person.
+  fred::Scoped_Lock lock( batch_add_person_mutex );
+  add_persons( pidv );
+}
+
+void Population::parse_lines_from_buffer( char * begin, char * end,
+    bool is_group_quarters_pop, std::vector< Person_Init_Data > & pidv ) {
+
+  // lines are terminated in place; no copies are made of the buffer
+  char * line = begin;
+  while ( line < end ) {
+    char * eol = (char *) memchr( line, '\n', end - line );
+    if ( eol == NULL ) {
+      eol = end;
     }
-    else {
-      // we need at least a household (homeless people not yet supported), so
-      // skip this person
-      FRED_VERBOSE( 0, "WARNING: skipping person %s -- %s %s\n",
-          pid.label, "no household found for label =", pid.house_label );
+    *eol = '\0';
+    if ( eol > line && eol[ -1 ] == '\r' ) {
+      eol[ -1 ] = '\0';
     }
-  } // <----- end while loop over stream
+    parse_line( line, is_group_quarters_pop, pidv );
+    line = eol + 1;
+  }
+}
 
+void Population::parse_line( char * line, bool is_group_quarters_pop,
+    std::vector< Person_Init_Data > & pidv ) {
+
+  // skip empty lines...
+  if ( ( line[ 0 ] == '\0' ) || strncmp( line, "p_id", 4 ) == 0 ) return;
+  //printf("line: |%s|\n", line); fflush(stdout); // exit(0);
+  const Person_Init_Data & pid = get_person_init_data( line, Global::Places,
+      is_group_quarters_pop ); 
+  // verbose printing of all person initialization data
+  FRED_VERBOSE( 1, "%s\n", pid.to_string().c_str() );
+  //skip header line
+  if (strcmp(pid.label,"p_id")==0) return;
+  /*
+  printf("|%s %d %c %d %s %s %s %d|\n", label, age, sex, race
+      house_label, work_label, school_label, relationship);
+  fflush(stdout);
+  
+  if (strcmp(work_label,"-1") && strcmp(school_label,"-1")) {
+    printf("STUDENT-WORKER: %s %d %c %s %s\n", label, age, sex, work_label, school_label);
+    fflush(stdout);
+  }
+  */
+  if ( pid.house != NULL ) {
+    // create a Person_Init_Data object
+    pidv.push_back( pid );
+  }
+  else {
+    // we need at least a household (homeless people not yet supported), so
+    // skip this person
+    FRED_VERBOSE( 0, "WARNING: skipping person %s -- %s %s\n",
+        pid.label, "no household found for label =", pid.house_label );
+  }
+}
+
+void Population::add_persons( std::vector< Person_Init_Data > & pidv ) {
   // Iterate through vector of already parsed initialization data and
   // add to population bloque.  More efficient to do this in batches; also
-  // preserves the (fine-grained) order in the population file.  Protect
-  // with mutex so that we do this sequentially and avoid thrashing the 
-  // scoped mutex in add_person.
-  fred::Scoped_Lock lock( batch_add_person_mutex );
+  // preserves the (fine-grained) order in the population file.
   std::vector< Person_Init_Data >::iterator it = pidv.begin();
   for ( ; it != pidv.end(); ++it ) {
     Person_Init_Data & pid = *it;
+    if ( pid.random_work ) {
+      pid.work = Global::Places.get_random_workplace();
+      FRED_CONDITIONAL_VERBOSE( 0, pid.work != NULL,
+          "WARNING: person %s assigned to workplace %s\n",
+          pid.label, pid.work->get_label() );
+      FRED_CONDITIONAL_VERBOSE( 0, pid.work == NULL,
+          "WARNING: no workplace available for person %s\n",
+          pid.label );
+    }
     // here the person is actually created and added to the population
     // The person's unique id is automatically assigned
-    add_person( pid.age, pid.sex, pid.race, pid.relationship,
+    Person * person = add_person( pid.age, pid.sex, pid.race, pid.relationship,
         pid.house, pid.school, pid.work, pid.day, pid.today_is_birthday);
+    if ( Global::Pop_Snapshot != NULL ) {
+      Global::Pop_Snapshot->record_person( person->get_id(), pid.age, pid.sex, pid.race,
+          pid.relationship, get_snapshot_place_index( pid.house ),
+          pid.random_work ? Population_Snapshot::RANDOM_WORKPLACE : get_snapshot_place_index( pid.work ),
+          get_snapshot_place_index( pid.school ) );
+    }
+  }
+}
+
+void Population::read_compressed_population( SnappyFileCompression & compressor,
+    bool is_group_quarters_pop ) {
+
+  int number_of_blocks = compressor.build_block_index();
+  FRED_STATUS( 0, "reading %d compressed blocks\n", number_of_blocks );
+  // Each thread uncompresses and parses whole blocks into its own buffer,
+  // reused from block to block; the mapped file is paged in by whichever
+  // thread needs it, so reading overlaps with parsing.  Blocks are handed
+  // out in file order and their people are added in file order (the ordered
+  // section).  Parsing makes no random draws; adding people does (their
+  // random workplaces, and the set up of each person), and takes them from
+  // thread 0's generator, so the population is the same for any number of
+  // threads.
+  #pragma omp parallel
+  {
+    std::vector< char > buffer;
+    std::vector< Person_Init_Data > pidv;
+    #pragma omp for ordered schedule( dynamic, 1 )
+    for ( int i = 0; i < number_of_blocks; ++i ) {
+      size_t size = compressor.uncompress_block( i, buffer );
+      pidv.clear();
+      parse_lines_from_buffer( &buffer[ 0 ], &buffer[ 0 ] + size,
+          is_group_quarters_pop, pidv );
+      #pragma omp ordered
+      {
+        RNG_Serial_Section serial;
+        add_persons( pidv );
+      }
+    }
+  }
+}
+
+int Population::get_snapshot_place_index( Place * place ) {
+  return place == NULL ? Population_Snapshot::NO_PLACE : place->get_id();
+}
+
+Place * Population::get_snapshot_place( int place_index ) {
+  if ( place_index == Population_Snapshot::RANDOM_WORKPLACE ) {
+    return Global::Places.get_random_workplace();
+  }
+  return place_index == Population_Snapshot::NO_PLACE ? NULL
+    : Global::Places.get_place_at_position( place_index );
+}
+
+void Population::read_population_snapshot() {
+  Population_Snapshot * snapshot = Global::Pop_Snapshot;
+  for ( int i = 0; i < snapshot->get_number_of_persons(); ++i ) {
+    const Population_Snapshot::Snapshot_Person & p = snapshot->get_person( i );
+    Population::next_id = p.id;
+    add_person( p.age, p.sex, p.race, p.relationship, get_snapshot_place( p.house ),
+        get_snapshot_place( p.school ), get_snapshot_place( p.work ), 0, false );
   }
+  FRED_VERBOSE(0, "finished reading population snapshot, pop_size = %d\n", pop_size);
 }
 
 void Population::split_synthetic_populations_by_deme() {
@@ -504,7 +643,10 @@ void Population::read_all_populations() {
   using namespace Utils;
   const char * pop_dir = Global::Synthetic_population_directory;
   assert( Demes.size() > 0 );
-  for ( int d = 0; d < Demes.size(); ++d ) { 
+  if ( Global::Pop_Snapshot != NULL && Global::Pop_Snapshot->is_loaded() ) {
+    read_population_snapshot();
+  }
+  else for ( int d = 0; d < Demes.size(); ++d ) { 
     FRED_STATUS( 0, "Loading population for Deme %d:\n", d );
     assert( Demes[ d ].size() > 0 );
     for ( int i = 0; i < Demes[ d ].size(); ++i ) {
@@ -524,6 +666,13 @@ void Population::read_all_populations() {
       }
     }
   }
+  if ( Global::Pop_Snapshot != NULL ) {
+    if ( !( Global::Pop_Snapshot->is_loaded() ) ) {
+      Global::Pop_Snapshot->write();
+    }
+    delete Global::Pop_Snapshot;
+    Global::Pop_Snapshot = NULL;
+  }
   // select adult to make health decisions
   Setup_Population_Behavior setup_population_behavior;
   blq.apply( setup_population_behavior );
@@ -557,15 +706,7 @@ void Population::read_population( const char * pop_dir, const char * pop_id,
     compressor.init_compressed_block_reader();
     // if we have the magic, then it must be fsz block compressed
     if ( compressor.check_magic_bytes() ) {
-      // limit to two threads to prevent locking and I/O overhead; also
-      // helps to preserve population order in bloque assignment
-      #pragma omp parallel
-      {
-        std::stringstream stream;
-        while ( compressor.load_next_block_stream( stream ) ) {
-          parse_lines_from_stream( stream, is_group_quarters_pop );
-        }
-      }
+      read_compressed_population( compressor, is_group_quarters_pop );
     }
   }
   else {
@@ -629,9 +770,12 @@ void Population::update(int day) {
   }
 
   if ( Global::Enable_Births ) {
-    // populate the maternity list (Demographics::update_births)
-    Update_Population_Births update_population_births( day );
-    blq.parallel_masked_apply( fred::Update_Births, update_population_births ); 
+    // populate the maternity list from today's due dates (Demographics::update_births),
+    // in index order whatever the number of threads
+    birth_events.get_events( day, todays_events );
+    for ( size_t i = 0; i < todays_events.size(); i++ ) {
+      get_person_by_index( todays_events[ i ] )->update_births( day );
+    }
     // add the births to the population
     size_t births = maternity_list.size();
     for ( size_t i = 0; i < births; i++ ) {
@@ -662,9 +806,12 @@ void Population::update(int day) {
   }
 
   if ( Global::Enable_Deaths ) {
-    // populate the death list (Demographics::update_deaths)
-    Update_Population_Deaths update_population_deaths( day );
-    blq.parallel_masked_apply( fred::Update_Deaths, update_population_deaths ); 
+    // populate the death list from today's death dates (Demographics::update_deaths),
+    // in index order whatever the number of threads
+    death_events.get_events( day, todays_events );
+    for ( size_t i = 0; i < todays_events.size(); i++ ) {
+      get_person_by_index( todays_events[ i ] )->update_deaths( day );
+    }
 
     // remove the dead from the population
     size_t deaths = death_list.size();
@@ -713,17 +860,31 @@ void Population::update(int day) {
     FRED_STATUS( 0, "deaths = %d\n", (int) deaths );
   }
 
-  // first update everyone's health intervention status
-  if ( Global::Enable_Vaccination || Global::Enable_Antivirals ) {
-    Update_Health_Interventions update_health_interventions( day );
-    blq.apply( update_health_interventions );
+  // first update the health intervention status of everyone who has had
+  // a vaccine or antiviral; those due another dose are queued after the sweep
+  if ( Global::Enable_Vaccination ) {
+    Update_Vaccine_Interventions update_vaccine_interventions( day );
+    parallel_masked_apply( fred::Takes_Vaccine, update_vaccine_interventions );
+    vacc_manager->queue_next_doses();
+  }
+  if ( Global::Enable_Antivirals ) {
+    Update_AV_Interventions update_av_interventions( day );
+    parallel_masked_apply( fred::Takes_AV, update_av_interventions );
   }
 
   FRED_VERBOSE(1, "population::update health  day = %d\n", day);
 
   // update everyone's health status
+  // (sweeps the health hot state; see Health::update_hot_state)
   Update_Population_Health update_population_health( day );
-  blq.parallel_masked_apply( fred::Update_Health, update_population_health );
+  if ( Global::Enable_Work_Stealing ) {
+    blq.scheduled_linked_masked_apply( 0, fred::Update_Health, update_population_health,
+        sweep_scheduler );
+  }
+  else {
+    blq.parallel_linked_masked_apply( 0, fred::Update_Health, update_population_health );
+  }
+  update_susceptibility( day );
   // Utils::fred_print_wall_time("day %d update_health", day);
 
   FRED_VERBOSE(1, "population::update household_mobility day = %d\n", day);
@@ -761,9 +922,11 @@ void Population::update(int day) {
 
   FRED_VERBOSE(1, "population::update_behavior day = %d\n", day);
 
-  // update decisions about behaviors
-  Update_Population_Behaviors update_population_behaviors( day );
-  blq.apply( update_population_behaviors );
+  // update decisions about behaviors (of those who make their own)
+  if ( Global::Enable_Behaviors ) {
+    Update_Population_Behaviors update_population_behaviors( day );
+    parallel_masked_apply( fred::Decision_Maker, update_population_behaviors );
+  }
   // Utils::fred_print_wall_time("day %d update_behavior", day);
 
   FRED_VERBOSE(1, "population::update vacc_manager day = %d\n", day);
@@ -781,20 +944,21 @@ void Population::update(int day) {
   FRED_STATUS( 1, "population begin_day finished\n");
 }
 
-void Population::Update_Population_Births::operator() ( Person & p ) {
-  p.update_births( day );
-}
-
-void Population::Update_Population_Deaths::operator() ( Person & p ) {
-  p.update_deaths( day );
+void Population::Update_Vaccine_Interventions::operator() ( Person & p ) {
+  RNG_Stream stream( RNG_Stream::INTERVENTION, day, p.get_id() );
+  p.update_vaccine_interventions( day );
 }
 
-void Population::Update_Health_Interventions::operator() ( Person & p ) {
-  p.update_health_interventions( day );
+void Population::Update_AV_Interventions::operator() ( Person & p ) {
+  RNG_Stream stream( RNG_Stream::INTERVENTION, day, p.get_id(), 1 );
+  p.update_av_interventions( day );
 }
 
-void Population::Update_Population_Health::operator() ( Person & p ) {
-  p.update_health( day );
+void Population::Update_Population_Health::operator() ( Health_Hot_State & hot, int person_index ) {
+  if ( Health::update_hot_state( hot, day ) ) { return; }
+  Person * person = Global::Pop.get_person_by_index( person_index );
+  RNG_Stream stream( RNG_Stream::HEALTH, day, person->get_id() );
+  person->update_health( day );
 }
 
 void Population::Update_Population_Household_Mobility::operator() ( Person & p ) {
@@ -810,46 +974,54 @@ void Population::Update_Population_Activities::operator() ( Person & p ) {
 }
 
 void Population::Update_Population_Behaviors::operator() ( Person & p ) {
+  RNG_Stream stream( RNG_Stream::BEHAVIOR, day, p.get_id() );
   p.update_behavior( day );
 }
 
-void Population::report(int day) {
-
-  // update infection counters for places
+void Population::Update_Place_Counts::operator() ( Person & p ) {
   for (int d = 0; d < Global::Diseases; d++) {
-    for (int i = 0; i < pop_size; ++i) {
-      if ( !blq.is_valid_index( i ) ) { continue; }
-      Person & pop_i = blq.get_item_reference_by_index( i );
-      if (pop_i.is_infected(d)) {
-
-	// Update the infection counters for households, if needed for GAIA vis data.
-	if (Global::Print_GAIA_Data) {
-	  pop_i.update_household_counts(day, d);
-	}
-
-	// Update the infection counters for schools
-	if (pop_i.get_school() != NULL)
-	  pop_i.update_school_counts(day, d);
+    if (p.is_infected(d)) {
+      // Update the infection counters for households, if needed for GAIA vis data.
+      if (Global::Print_GAIA_Data) {
+        p.update_household_counts(day, d);
+      }
+      // Update the infection counters for schools
+      if (p.get_school() != NULL) {
+        p.update_school_counts(day, d);
       }
     }
   }
+}
+
+void Population::Count_Ages::operator() ( Person & p ) {
+  int age_lookup = p.get_age();
+  if (age_lookup > Demographics::MAX_AGE)
+    age_lookup = Demographics::MAX_AGE;
+  if (p.get_sex() != 'F')
+    age_lookup += Demographics::MAX_AGE + 1;
+  counts()[age_lookup]++;
+}
+
+void Population::report(int day) {
+
+  // update infection counters for places; the counters are atomic, so
+  // the people can be visited in any order
+  Update_Place_Counts update_place_counts( day );
+  parallel_masked_apply( fred::Update_Health, update_place_counts );
 
   // give out anti-virals (after today's infections)
   av_manager->disseminate(day);
 
   if (Global::Verbose > 0 && Date::match_pattern(Global::Sim_Current_Date, "12-31-*")) {
     // print the statistics on December 31 of each year
-    for (int i = 0; i < pop_size; ++i) {
-      if ( !blq.is_valid_index( i ) ) { continue; }
-      Person & pop_i = blq.get_item_reference_by_index( i );
-      int age_lookup = pop_i.get_age();
-
-      if (age_lookup > Demographics::MAX_AGE)
-        age_lookup = Demographics::MAX_AGE;
-      if (pop_i.get_sex() == 'F')
-        age_count_female[age_lookup]++;
-      else
-        age_count_male[age_lookup]++;
+    Count_Ages count_ages;
+    parallel_apply( count_ages );
+    for (int t = 0; t < count_ages.counts.size(); ++t) {
+      std::vector< int > & counts = count_ages.counts( t );
+      for (int i = 0; i <= Demographics::MAX_AGE; ++i) {
+        age_count_female[i] += counts[i];
+        age_count_male[i] += counts[Demographics::MAX_AGE + 1 + i];
+      }
     }
     for (int i = 0; i <= Demographics::MAX_AGE; ++i) {
       int count, num_deaths, num_births;
@@ -886,7 +1058,7 @@ void Population::report(int day) {
   // the last day of the simulation
   if(Population::output_population > 0) {
     if((day == 0) || (Date::match_pattern(Global::Sim_Current_Date, Population::output_population_date_match))) {
-      this->write_population_output_file(day);
+      this->write_population_dump(day);
     }
   }
 }
@@ -959,7 +1131,19 @@ void Population::end_of_run() {
   //  * Will write only on the first day of the simulation, days matching the date pattern in the parameter file,
   //    and the last day of the simulation *
   if(Population::output_population > 0) {
-    this->write_population_output_file(Global::Days);
+    this->write_population_dump(Global::Days);
+    if ( !population_dump->finish() ) {
+      Utils::fred_abort( "%s\n", population_dump->get_error().c_str() );
+    }
+    FRED_STATUS( 0, "population dumps: %llu bytes\n",
+        (unsigned long long) population_dump->get_bytes_written() );
+    // the next run of a batch starts a writer of its own
+    delete population_dump;
+    population_dump = NULL;
+  }
+
+  if ( Global::Enable_Work_Stealing ) {
+    sweep_scheduler.report( Global::Statusfp, "population sweep scheduler" );
   }
 }
 
@@ -1187,27 +1371,98 @@ Person * Population::select_random_person_by_age(int min_age, int max_age) {
   return blq.get_item_pointer_by_index(i);
 }
 
-void Population::write_population_output_file(int day) {
-
-  //Loop over the whole population and write the output of each Person's to_string to the file
+void Population::write_population_dump(int day) {
+  if ( population_dump == NULL ) {
+    population_dump = new Population_Dump( Population::output_population_compress > 0 );
+  }
+  // waits only if the last two dumps are still being written
+  Population_Dump::Frame * frame = population_dump->begin_frame();
+  if ( frame == NULL ) {
+    Utils::fred_abort( "%s\n", population_dump->get_error().c_str() );
+  }
   char population_output_file[FRED_STRING_SIZE];
-  sprintf(population_output_file, "%s/%s_%s.txt", Global::Output_directory, Population::pop_outfile,
+  sprintf(population_output_file, "%s/%s_%s.bin", Global::Output_directory, Population::pop_outfile,
       (char *) Global::Sim_Current_Date->get_YYYYMMDD().c_str());
-  FILE *fp = fopen(population_output_file, "w");
-  if (fp == NULL) {
-    Utils::fred_abort("Help! population_output_file %s not found\n", population_output_file);
+  frame->filename = population_output_file;
+  frame->day = day;
+  frame->date = Global::Sim_Current_Date->get_YYYYMMDD();
+  frame->number_of_diseases = Global::Diseases;
+
+  // the people, in index order
+  vector< int > rows;
+  rows.reserve( pop_size );
+  for ( size_t p = 0; p < blq.get_end_index(); ++p ) {
+    if ( blq.is_valid_index( p ) ) {
+      rows.push_back( p );
+    }
+  }
+  int n = rows.size();
+  int32_t * id = frame->add_column< int32_t >( "id", n );
+  int16_t * age = frame->add_column< int16_t >( "age", n );
+  char * sex = frame->add_column< char >( "sex", n );
+  int16_t * race = frame->add_column< int16_t >( "race", n );
+  int16_t * relationship = frame->add_column< int16_t >( "relationship", n );
+  int32_t * household = frame->add_column< int32_t >( "household", n );
+  int32_t * school = frame->add_column< int32_t >( "school", n );
+  int32_t * classroom = frame->add_column< int32_t >( "classroom", n );
+  int32_t * workplace = frame->add_column< int32_t >( "workplace", n );
+  int32_t * office = frame->add_column< int32_t >( "office", n );
+  uint8_t * vaccines = frame->add_column< uint8_t >( "vaccines", n );
+  uint8_t * antivirals = frame->add_column< uint8_t >( "antivirals", n );
+  // for each disease: the health status bits, and the dates of the active
+  // infection (-1 if none)
+  uint8_t * status[ Global::MAX_NUM_DISEASES ];
+  int32_t * exposure_date[ Global::MAX_NUM_DISEASES ];
+  int32_t * recovered_date[ Global::MAX_NUM_DISEASES ];
+  for ( int d = 0; d < Global::Diseases; ++d ) {
+    char name[ 32 ];
+    sprintf( name, "status[%d]", d );
+    status[ d ] = frame->add_column< uint8_t >( name, n );
+    sprintf( name, "exposure_date[%d]", d );
+    exposure_date[ d ] = frame->add_column< int32_t >( name, n );
+    sprintf( name, "recovered_date[%d]", d );
+    recovered_date[ d ] = frame->add_column< int32_t >( name, n );
   }
 
-  //  fprintf(fp, "Population for day %d\n", day);
-  //  fprintf(fp, "------------------------------------------------------------------\n");
-  for (int p = 0; p < pop_size; ++p) {
-    if ( blq.is_valid_index( p ) ) {
-      Person & pop_i = blq.get_item_reference_by_index( p );
-      fprintf(fp, "%s\n", pop_i.to_string().c_str());
+  #pragma omp parallel for
+  for ( int r = 0; r < n; ++r ) {
+    Person & person = blq.get_item_reference_by_index( rows[ r ] );
+    Health * health = person.get_health();
+    id[ r ] = person.get_id();
+    age[ r ] = person.get_age();
+    sex[ r ] = person.get_sex();
+    race[ r ] = person.get_race();
+    relationship[ r ] = person.get_relationship();
+    household[ r ] = person.get_household() ? person.get_household()->get_id() : -1;
+    school[ r ] = person.get_school() ? person.get_school()->get_id() : -1;
+    classroom[ r ] = person.get_classroom() ? person.get_classroom()->get_id() : -1;
+    workplace[ r ] = person.get_workplace() ? person.get_workplace()->get_id() : -1;
+    office[ r ] = person.get_office() ? person.get_office()->get_id() : -1;
+    vaccines[ r ] = health->get_number_vaccines_taken();
+    antivirals[ r ] = health->get_number_av_taken();
+    for ( int d = 0; d < Global::Diseases; ++d ) {
+      status[ d ][ r ] = ( health->is_susceptible( d ) ? 1 : 0 )
+        | ( health->is_infected( d ) ? 2 : 0 )
+        | ( health->is_infectious( d ) ? 4 : 0 )
+        | ( health->is_symptomatic( d ) ? 8 : 0 )
+        | ( health->is_immune( d ) ? 16 : 0 );
+      exposure_date[ d ][ r ] = health->get_exposure_date( d );
+      recovered_date[ d ][ r ] = health->get_recovered_date( d );
     }
   }
-  fflush(fp);
-  fclose(fp);
+
+  // the labels of the places, by place id
+  int number_places = Global::Places.get_number_of_places();
+  char * label = (char *) frame->add_column( "place_label", 32, number_places );
+  #pragma omp parallel for
+  for ( int p = 0; p < number_places; ++p ) {
+    strncpy( label + 32 * p, Global::Places.get_place_at_position( p )->get_label(), 32 );
+  }
+  frame->number_persons = n;
+  frame->number_places = number_places;
+
+  population_dump->write_frame( frame );
+  FRED_VERBOSE( 0, "population dump %s queued on day %d\n", population_output_file, day );
 }
 
 void Population::Update_Vaccine_Infection_Counts::operator() (Person & p) {
@@ -1255,38 +1510,135 @@ void Population::initialize_disease_state_counts_by_block(){
     block_set.insert(census_block);
   }
 	 
+  // intern the blocks; households keep their block's index
   for(std::set<string>::iterator census_block_itr = block_set.begin();
       census_block_itr != block_set.end(); ++census_block_itr) {
-    Global::Block_Epi_Day_Tracker->add_index(*census_block_itr);
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"N",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"E",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"S",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"I",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"Is",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"R",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"C",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"Cs",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"Is",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"V",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"Av",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"M",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"N",int(0));
-    Global::Block_Epi_Day_Tracker->set_index_key_pair(*census_block_itr,"Day",int(0));
-	    
+    Global::Block_Epi_Day_Tracker->add_block(*census_block_itr);
   }
 
   for(int p=0;p<this->pop_size;p++){
     Person & pop_i = this->blq.get_item_reference_by_index(p);
-    string census_block = ((Household*)pop_i.get_household())->get_census_block();
-    Global::Block_Epi_Day_Tracker->increment_index_key_pair(census_block,"N",int(1));
+    Household * house = (Household*)pop_i.get_household();
+    int block = Global::Block_Epi_Day_Tracker->get_block_index(house->get_census_block());
+    house->set_census_block_index(block);
+    Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::N,1);
     // Must handle residual immunity here because it is not initialized yet
     if(pop_i.get_health()->is_immune(0)){
-	Global::Block_Epi_Day_Tracker->increment_index_key_pair(census_block,"M",int(1));
+	Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::M,1);
     }
     else{
-        Global::Block_Epi_Day_Tracker->increment_index_key_pair(census_block,"S",int(1));
+        Global::Block_Epi_Day_Tracker->increment(block,Census_Block_Tracker::S,1);
     }
   }
   Global::Block_Tracker_Initialized = true;
 }
 
+typedef bloque< Person, fred::Pop_Masks, Health_Hot_State, char >::Layout Population_Layout;
+
+void Population::write_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.write_tag( "population" );
+  checkpoint.write( pop_size );
+  checkpoint.write( Population::next_id );
+
+  // which slots of the bloque are in use, and by which masks
+  Population_Layout layout;
+  blq.get_layout( layout );
+  checkpoint.write_size( layout.number_of_blocks );
+  checkpoint.write_vector( layout.default_mask );
+  checkpoint.write_size( layout.user_masks.size() );
+  for ( std::map< fred::Pop_Masks, vector< BitType > >::iterator itr =
+      layout.user_masks.begin(); itr != layout.user_masks.end(); ++itr ) {
+    checkpoint.write( (int) itr->first );
+    checkpoint.write_vector( itr->second );
+  }
+  checkpoint.write_vector( layout.free_slots );
+  checkpoint.write_size( layout.first_item_index );
+  checkpoint.write_size( layout.last_item_index );
+
+  // the people, in order of index
+  int index_limit = blq.get_end_index();
+  for ( int p = 0; p < index_limit; ++p ) {
+    Person * person = get_person_by_index( p );
+    if ( person != NULL ) {
+      person->write_checkpoint( checkpoint );
+    }
+  }
+
+  for ( int i = 0; i < 367; ++i ) {
+    checkpoint.write_people( birthday_vecs[ i ] );
+  }
+  birth_events.write_checkpoint( checkpoint );
+  death_events.write_checkpoint( checkpoint );
+  susceptibility_events.write_checkpoint( checkpoint );
+
+  checkpoint.write( age_count_male );
+  checkpoint.write( age_count_female );
+  checkpoint.write( birth_count );
+  checkpoint.write( death_count_male );
+  checkpoint.write( death_count_female );
+
+  vacc_manager->write_checkpoint( checkpoint );
+  av_manager->write_checkpoint( checkpoint );
+}
+
+void Population::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read_tag( "population" );
+  checkpoint.read( pop_size );
+  checkpoint.read( Population::next_id );
+
+  // the people made at setup give way to those in the checkpoint
+  int index_limit = blq.get_end_index();
+  for ( int p = 0; p < index_limit; ++p ) {
+    Person * person = get_person_by_index( p );
+    if ( person != NULL ) {
+      person->~Person();
+    }
+  }
+
+  Population_Layout layout;
+  layout.number_of_blocks = checkpoint.read_size();
+  checkpoint.read_vector( layout.default_mask );
+  size_t number_of_masks = checkpoint.read_size();
+  for ( size_t i = 0; i < number_of_masks; ++i ) {
+    int mask;
+    checkpoint.read( mask );
+    checkpoint.read_vector( layout.user_masks[ (fred::Pop_Masks) mask ] );
+  }
+  checkpoint.read_vector( layout.free_slots );
+  layout.first_item_index = checkpoint.read_size();
+  layout.last_item_index = checkpoint.read_size();
+  blq.set_layout( layout );
+
+  index_limit = blq.get_end_index();
+  for ( int p = 0; p < index_limit; ++p ) {
+    Person * person = get_person_by_index( p );
+    if ( person != NULL ) {
+      new( person ) Person();
+      person->read_checkpoint( checkpoint );
+    }
+  }
+  if ( (unsigned) pop_size != blq.size() ) {
+    Utils::fred_abort( "Checkpoint population has %d people, but %d slots in use\n",
+        pop_size, (int) blq.size() );
+  }
+
+  birthday_map.clear();
+  for ( int i = 0; i < 367; ++i ) {
+    checkpoint.read_people( birthday_vecs[ i ] );
+    for ( int pos = 0; pos < (int) birthday_vecs[ i ].size(); ++pos ) {
+      birthday_map[ birthday_vecs[ i ][ pos ] ] = pos;
+    }
+  }
+  birth_events.read_checkpoint( checkpoint );
+  death_events.read_checkpoint( checkpoint );
+  susceptibility_events.read_checkpoint( checkpoint );
+
+  checkpoint.read( age_count_male );
+  checkpoint.read( age_count_female );
+  checkpoint.read( birth_count );
+  checkpoint.read( death_count_male );
+  checkpoint.read( death_count_female );
+
+  vacc_manager->read_checkpoint( checkpoint );
+  av_manager->read_checkpoint( checkpoint );
+}
@@ -28,19 +28,24 @@
 #include "Bloque.h"
 #include "Compression.h"
 #include "Utils.h"
+#include "State.h"
+#include "Event_Calendar.h"
 
 class Person;
+struct Health_Hot_State;
 class Disease;
 class Antivirals;
 class AV_Manager;
 class Vaccine_Manager;
 class Place;
+class Checkpoint;
 
 using namespace std;
 
 typedef map <Person*, bool> ChangeMap;  
 
 class Person_Init_Data;
+class Population_Dump;
 
 class Population {
 
@@ -106,6 +111,11 @@ class Population {
      */
     int get_pop_size() { return pop_size; }
 
+    /**
+     * @return one past the largest population index in use
+     */
+    int get_index_limit() { return blq.get_end_index(); }
+
     //Mitigation Managers
     /**
      * @return a pointer to this Population's AV_Manager
@@ -145,12 +155,65 @@ class Population {
      */
     void prepare_to_give_birth( int day, int person_index );
 
+    /**
+     * File a person's birth, death or loss of immunity to a disease under
+     * the simulation day it falls on; see Population::update and
+     * Population::update_susceptibility.  Thread safe.  Events after the
+     * last day of the run are dropped.
+     *
+     * @param day the simulation day of the event
+     * @param person_index the population index of the agent
+     */
+    void schedule_birth( int day, int person_index ) {
+      if ( day < Global::Days ) {
+        birth_events.schedule( day, person_index );
+      }
+    }
+    void schedule_death( int day, int person_index ) {
+      if ( day < Global::Days ) {
+        death_events.schedule( day, person_index );
+      }
+    }
+    void schedule_susceptibility( int day, int disease_id, int person_index ) {
+      if ( day < Global::Days ) {
+        susceptibility_events.schedule( day, person_index * Global::MAX_NUM_DISEASES + disease_id );
+      }
+    }
+
+    /**
+     * Loss of immunity for today's scheduled agents (after the health
+     * update, which schedules those who recover today)
+     * @param day the simulation day
+     */
+    void update_susceptibility( int day );
+
     /**
      * @param index the index of the Person
      * Return a pointer to the Person object at this index
      */
     Person * get_person_by_index( int index );
 
+    /**
+     * @param index the index of the Person
+     * Return a pointer to the slot for this index, whether or not a Person
+     * lives there now (see Checkpoint)
+     */
+    Person * get_person_slot( int index );
+
+    /**
+     * Write everyone's state, the population's calendars and counts, and the
+     * vaccine and antiviral managers to a checkpoint; read_checkpoint replaces
+     * the people made at setup with those in the checkpoint (see Checkpoint)
+     */
+    void write_checkpoint( Checkpoint & checkpoint );
+    void read_checkpoint( Checkpoint & checkpoint );
+
+    /**
+     * @param index the index of the Person
+     * Return a pointer to the Person's health hot state (see Health.h)
+     */
+    Health_Hot_State * get_health_hot_state( int index );
+
     /**
      * @param n the id of the Person
      * Return a pointer to the Person object with this id
@@ -244,12 +307,16 @@ class Population {
       return blq.mask_is_set( mask, person_index );
     }
 
+    void clear_mask( fred::Pop_Masks mask ) {
+      blq.clear_mask( mask );
+    }
+
     int size() {
       assert( blq.size() == pop_size );
       return blq.size();
     }
 
-    int size( fred::Pop_Masks mask ) { return blq.size( mask ); }
+    int size( fred::Pop_Masks mask ) { return blq.mask_count( mask ); }
 
     template< typename Functor >
       void apply( Functor & f ) { blq.apply( f ); }
@@ -261,7 +328,18 @@ class Population {
       void parallel_apply( Functor & f ) { blq.parallel_apply( f ); }
 
     template< typename Functor >
-      void parallel_masked_apply( fred::Pop_Masks m, Functor & f ) { blq.parallel_masked_apply( m, f ); }
+      void parallel_masked_apply( fred::Pop_Masks m, Functor & f ) {
+        if ( Global::Enable_Work_Stealing ) {
+          blq.scheduled_masked_apply( m, f, sweep_scheduler );
+        }
+        else {
+          blq.parallel_masked_apply( m, f );
+        }
+      }
+
+    // serial, in index order
+    template< typename Functor >
+      void masked_apply( fred::Pop_Masks m, Functor & f ) { blq.masked_apply( m, f ); }
 
     template< typename Functor >
       void parallel_not_masked_apply( fred::Pop_Masks m, Functor & f ) { blq.parallel_not_masked_apply( m, f ); }
@@ -339,14 +417,37 @@ class Population {
     std::vector< Utils::Tokens > Demes;
 
     void parse_lines_from_stream( std::istream & stream, bool is_group_quarters_pop );
+    void parse_lines_from_buffer( char * begin, char * end, bool is_group_quarters_pop,
+        std::vector< Person_Init_Data > & pidv );
+    void parse_line( char * line, bool is_group_quarters_pop,
+        std::vector< Person_Init_Data > & pidv );
+    void add_persons( std::vector< Person_Init_Data > & pidv );
+    void read_compressed_population( SnappyFileCompression & compressor,
+        bool is_group_quarters_pop );
 
     Person_Init_Data get_person_init_data( char * line,
         const Place_List & places, bool is_group_quarters_population );
 
+    // see Population_Snapshot
+    void read_population_snapshot();
+    int get_snapshot_place_index( Place * place );
+    Place * get_snapshot_place( int place_index );
 
-    bloque< Person, fred::Pop_Masks > blq;   // all Persons in the population
+
+    bloque< Person, fred::Pop_Masks, Health_Hot_State, char > blq;   // all Persons in the population
+    // health hot state for each Person, linked to blq (same indices)
+    bloque< Health_Hot_State, char, Person, fred::Pop_Masks > health_blq;
+    // balances parallel sweeps when Global::Enable_Work_Stealing is set
+    Work_Stealing_Scheduler sweep_scheduler;
     vector <Person * > death_list;     // list agents to die today
     vector <Person * > maternity_list; // list agents to give birth today
+
+    // births, deaths and losses of immunity by day, keyed by population
+    // index (times MAX_NUM_DISEASES, plus the disease, for immunity)
+    Event_Calendar birth_events;
+    Event_Calendar death_events;
+    Event_Calendar susceptibility_events;
+    vector <int> todays_events;
     int pop_size;
     Disease *disease;
 
@@ -363,6 +464,7 @@ class Population {
     static char pop_outfile[FRED_STRING_SIZE];
     static char output_population_date_match[FRED_STRING_SIZE];
     static int output_population;
+    static int output_population_compress;
     static bool is_initialized;
     static int next_id;
 
@@ -378,33 +480,31 @@ class Population {
     void clear_static_arrays();
 
     /**
-     * Write out the population in a format similar to the population input files (with additional runtime information)
+     * Capture the people, their places and their health in a binary dump (see
+     * Population_Dump), written in the background; popdump converts a dump to
+     * the format of the population input files
      * @param day the simulation day
      */
-    void write_population_output_file(int day);
+    void write_population_dump(int day);
+    Population_Dump * population_dump;
 
     // functor for behavior setup
     struct Setup_Population_Behavior {
       void operator() ( Person & p );
     };
 
-    // functors for demographics updates 
-    struct Update_Population_Births {
-      int day;
-      Update_Population_Births( int _day ) : day( _day ) { }
-      void operator() ( Person & p );
-    };
 
-    struct Update_Population_Deaths {
+    // functors for health interventions (vaccination & antivirals) updates;
+    // run over fred::Takes_Vaccine and fred::Takes_AV
+    struct Update_Vaccine_Interventions {
       int day;
-      Update_Population_Deaths( int _day ) : day( _day ) { }
+      Update_Vaccine_Interventions( int d ) : day( d ) { }
       void operator() ( Person & p );
     };
 
-    // functor for health interventions (vaccination & antivirals) updates
-    struct Update_Health_Interventions {
+    struct Update_AV_Interventions {
       int day;
-      Update_Health_Interventions( int d ) : day( d ) { }
+      Update_AV_Interventions( int d ) : day( d ) { }
       void operator() ( Person & p );
     };
     
@@ -412,7 +512,7 @@ class Population {
     struct Update_Population_Health {
       int day;
       Update_Population_Health( int d ) : day( d ) { }
-      void operator() ( Person & p );
+      void operator() ( Health_Hot_State & hot, int person_index );
     };
 
     // functor for household mobility
@@ -436,13 +536,34 @@ class Population {
       void operator() ( Person & p );
     };
 
-    // functor for behavior updates
+    // functor for behavior updates; run over fred::Decision_Maker
     struct Update_Population_Behaviors {
       int day;
       Update_Population_Behaviors( int d ) : day( d ) { }
       void operator() ( Person & p );
     };
 
+    // functor for the infection counters of schools (and households, for
+    // GAIA); run over fred::Update_Health, which every person with an active
+    // infection has set
+    struct Update_Place_Counts {
+      int day;
+      Update_Place_Counts( int d ) : day( d ) { }
+      void operator() ( Person & p );
+    };
+
+    // functor for the yearly age tables; each thread counts into its own
+    // array (females in [0,MAX_AGE], males in [MAX_AGE+1,2*MAX_AGE+1])
+    struct Count_Ages {
+      State< std::vector< int > > counts;
+      Count_Ages() : counts( NCPU ) {
+        for ( int t = 0; t < NCPU; ++t ) {
+          counts( t ).assign( 2 * ( Demographics::MAX_AGE + 1 ), 0 );
+        }
+      }
+      void operator() ( Person & p );
+    };
+
     // functor for vaccine infection tracking
     struct Update_Vaccine_Infection_Counts {
         int day;
@@ -472,6 +593,7 @@ struct Person_Init_Data {
   Place * school;
   bool in_grp_qrtrs;
   char gq_type;
+  bool random_work;
 
   Person_Init_Data() {
     default_initialization();
@@ -505,6 +627,7 @@ struct Person_Init_Data {
     today_is_birthday = false;
     in_grp_qrtrs = false;
     gq_type = ' ';
+    random_work = false;
   }
 
   const std::string to_string() const {
@@ -0,0 +1,255 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Population_Dump.cc
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <snappy.h>
+
+#include "Population_Dump.h"
+
+using namespace std;
+
+const char Population_Dump::MAGIC[ 8 ] = { 'F', 'R', 'E', 'D', 'D', 'M', 'P', '\0' };
+
+void * Population_Dump::Frame::add_column( const char * name, size_t element_size, size_t n ) {
+  if ( number_columns == (int) columns.size() ) {
+    columns.push_back( Column() );
+  }
+  Column & column = columns[ number_columns ];
+  if ( column.name != name ) {
+    column.name = name;
+  }
+  column.element_size = element_size;
+  column.data.resize( element_size * n );
+  ++number_columns;
+  return column.data.empty() ? NULL : &( column.data[ 0 ] );
+}
+
+const Population_Dump::Column * Population_Dump::Frame::find_column( const char * name ) const {
+  for ( int i = 0; i < number_columns; ++i ) {
+    if ( columns[ i ].name == name ) {
+      return &( columns[ i ] );
+    }
+  }
+  return NULL;
+}
+
+Population_Dump::Population_Dump( bool _compress ) {
+  compress = _compress;
+  state[ 0 ] = state[ 1 ] = FREE;
+  stopping = false;
+  bytes_written = 0;
+}
+
+Population_Dump::~Population_Dump() {
+  finish();
+}
+
+Population_Dump::Frame * Population_Dump::begin_frame() {
+  unique_lock< mutex > guard( lock );
+  while ( error.empty() && state[ 0 ] != FREE && state[ 1 ] != FREE ) {
+    changed.wait( guard );
+  }
+  if ( !error.empty() ) {
+    return NULL;
+  }
+  int f = state[ 0 ] == FREE ? 0 : 1;
+  state[ f ] = FILLING;
+  frames[ f ].clear();
+  return &( frames[ f ] );
+}
+
+void Population_Dump::write_frame( Frame * frame ) {
+  int f = frame == &( frames[ 0 ] ) ? 0 : 1;
+  unique_lock< mutex > guard( lock );
+  state[ f ] = QUEUED;
+  queue.push_back( f );
+  if ( !writer.joinable() ) {
+    stopping = false;
+    writer = thread( &Population_Dump::run_writer, this );
+  }
+  changed.notify_all();
+}
+
+bool Population_Dump::finish() {
+  {
+    unique_lock< mutex > guard( lock );
+    stopping = true;
+    changed.notify_all();
+  }
+  if ( writer.joinable() ) {
+    writer.join();
+  }
+  unique_lock< mutex > guard( lock );
+  return error.empty();
+}
+
+uint64_t Population_Dump::get_bytes_written() {
+  unique_lock< mutex > guard( lock );
+  return bytes_written;
+}
+
+// the background thread: writes queued frames in order until stopped and
+// the queue is empty
+void Population_Dump::run_writer() {
+  unique_lock< mutex > guard( lock );
+  for ( ;; ) {
+    while ( queue.empty() && !stopping ) {
+      changed.wait( guard );
+    }
+    if ( queue.empty() ) {
+      return;
+    }
+    int f = queue.front();
+    queue.pop_front();
+    guard.unlock();
+    string message;
+    bool ok = write_file( frames[ f ], message );
+    guard.lock();
+    if ( !ok && error.empty() ) {
+      error = message;
+    }
+    state[ f ] = FREE;
+    changed.notify_all();
+  }
+}
+
+bool Population_Dump::write_file( const Frame & frame, string & message ) {
+  char temporary[ 4096 ];
+  snprintf( temporary, sizeof( temporary ), "%s.%d.tmp", frame.filename.c_str(), (int) getpid() );
+  FILE * fp = fopen( temporary, "wb" );
+  if ( fp == NULL ) {
+    message = "unable to write population dump " + string( temporary );
+    return false;
+  }
+
+  Dump_Header header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+  header.byte_order = BYTE_ORDER_MARK;
+  header.version = VERSION;
+  header.header_size = sizeof( Dump_Header );
+  header.column_header_size = sizeof( Column_Header );
+  header.number_columns = frame.number_columns;
+  header.day = frame.day;
+  strncpy( header.date, frame.date.c_str(), sizeof( header.date ) - 1 );
+  header.number_of_diseases = frame.number_of_diseases;
+  header.number_persons = frame.number_persons;
+  header.number_places = frame.number_places;
+
+  static const char zeros[ 8 ] = { 0 };
+  bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+  uint64_t total = sizeof( header );
+  string compressed;
+  for ( int i = 0; ok && i < frame.number_columns; ++i ) {
+    const Column & column = frame.columns[ i ];
+    const char * data = column.data.empty() ? NULL : &( column.data[ 0 ] );
+    Column_Header column_header;
+    memset( &column_header, 0, sizeof( column_header ) );
+    strncpy( column_header.name, column.name.c_str(), NAME_SIZE - 1 );
+    column_header.element_size = column.element_size;
+    column_header.size = column.data.size();
+    column_header.stored_size = column.data.size();
+    if ( compress && data != NULL ) {
+      snappy::Compress( data, column.data.size(), &compressed );
+      if ( compressed.size() < column.data.size() ) {
+        column_header.compressed = 1;
+        column_header.stored_size = compressed.size();
+        data = compressed.data();
+      }
+    }
+    size_t padding = align( column_header.stored_size ) - column_header.stored_size;
+    ok = fwrite( &column_header, sizeof( column_header ), 1, fp ) == 1
+      && ( column_header.stored_size == 0
+          || fwrite( data, column_header.stored_size, 1, fp ) == 1 )
+      && ( padding == 0 || fwrite( zeros, padding, 1, fp ) == 1 );
+    total += sizeof( column_header ) + column_header.stored_size + padding;
+  }
+
+  if ( fclose( fp ) != 0 || !ok || rename( temporary, frame.filename.c_str() ) != 0 ) {
+    message = "error writing population dump " + frame.filename;
+    return false;
+  }
+  unique_lock< mutex > guard( lock );
+  bytes_written += total;
+  return true;
+}
+
+bool Population_Dump::read( const char * filename, Frame & frame, string & error ) {
+  frame.clear();
+  FILE * fp = fopen( filename, "rb" );
+  if ( fp == NULL ) {
+    error = "unable to open " + string( filename );
+    return false;
+  }
+  Dump_Header header;
+  if ( fread( &header, sizeof( header ), 1, fp ) != 1
+      || memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) != 0 ) {
+    fclose( fp );
+    error = string( filename ) + " is not a population dump";
+    return false;
+  }
+  if ( header.byte_order != BYTE_ORDER_MARK || header.version != VERSION
+      || header.header_size != sizeof( Dump_Header )
+      || header.column_header_size != sizeof( Column_Header ) ) {
+    fclose( fp );
+    error = string( filename ) + " was written by another version of FRED, or on another platform";
+    return false;
+  }
+  frame.filename = filename;
+  frame.day = header.day;
+  header.date[ sizeof( header.date ) - 1 ] = '\0';
+  frame.date = header.date;
+  frame.number_of_diseases = header.number_of_diseases;
+  frame.number_persons = header.number_persons;
+  frame.number_places = header.number_places;
+
+  vector< char > stored;
+  for ( uint32_t i = 0; i < header.number_columns; ++i ) {
+    Column_Header column_header;
+    if ( fread( &column_header, sizeof( column_header ), 1, fp ) != 1 ) {
+      fclose( fp );
+      error = string( filename ) + " is truncated";
+      return false;
+    }
+    column_header.name[ NAME_SIZE - 1 ] = '\0';
+    size_t element_size = column_header.element_size;
+    size_t n = element_size ? column_header.size / element_size : 0;
+    char * data = (char *) frame.add_column( column_header.name, element_size, n );
+    stored.resize( align( column_header.stored_size ) );
+    bool ok = stored.empty() || fread( &( stored[ 0 ] ), stored.size(), 1, fp ) == 1;
+    if ( ok && column_header.compressed ) {
+      size_t length = 0;
+      ok = snappy::GetUncompressedLength( &( stored[ 0 ] ), column_header.stored_size, &length )
+        && length == column_header.size
+        && snappy::RawUncompress( &( stored[ 0 ] ), column_header.stored_size, data );
+    }
+    else if ( ok ) {
+      ok = column_header.stored_size == column_header.size;
+      if ( ok && column_header.size > 0 ) {
+        memcpy( data, &( stored[ 0 ] ), column_header.size );
+      }
+    }
+    if ( !ok ) {
+      fclose( fp );
+      error = string( filename ) + ": unable to read column " + column_header.name;
+      return false;
+    }
+  }
+  fclose( fp );
+  return true;
+}
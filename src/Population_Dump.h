@@ -0,0 +1,188 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Population_Dump.h
+//
+
+#ifndef _FRED_POPULATION_DUMP_H
+#define _FRED_POPULATION_DUMP_H
+
+/*
+ * Columnar binary dump of the population's state on a given day, written
+ * when the output_population parameter is set (see
+ * Population::write_population_dump).
+ *
+ * The population fills a Frame, one column at a time (a column holds one
+ * value for every person, or for every place); the Frame is then handed to a
+ * background thread that compresses and writes it, while the simulation goes
+ * on.  There are two Frames, so the next dump can be filled while the last
+ * one is being written; begin_frame waits only if both are still busy.
+ *
+ * Layout (native byte order; every section starts on an 8-byte boundary):
+ *
+ *   Dump_Header
+ *   for each column:
+ *     Column_Header
+ *     data            char[ stored_size ]  snappy compressed if compressed != 0
+ *
+ * This file depends on no other part of FRED, so that the popdump tool
+ * (popdump.cc) can read the dumps on its own.  Errors are returned rather
+ * than aborting; the background thread's are reported by the next call to
+ * begin_frame or finish.
+ */
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+class Population_Dump {
+
+public:
+
+  static const uint32_t VERSION = 1;
+  static const int NAME_SIZE = 32;
+
+  struct Column {
+    std::string name;
+    uint32_t element_size;
+    std::vector< char > data;
+
+    size_t get_number_of_elements() const {
+      return element_size ? data.size() / element_size : 0;
+    }
+    template< typename T > const T * get() const {
+      return data.empty() ? NULL : (const T *) &( data[ 0 ] );
+    }
+  };
+
+  struct Frame {
+    std::string filename;
+    int day;
+    std::string date;              // YYYYMMDD
+    int number_of_diseases;
+    uint64_t number_persons;
+    uint64_t number_places;
+
+    // only the first number_columns are in use; the others keep their
+    // storage for the next dump
+    std::vector< Column > columns;
+    int number_columns;
+
+    Frame() : day( 0 ), number_of_diseases( 0 ), number_persons( 0 ),
+        number_places( 0 ), number_columns( 0 ) { }
+
+    /// empties the frame, keeping its storage
+    void clear() { number_columns = 0; }
+
+    /**
+     * Adds a column of n elements, and returns its (uninitialized) storage.
+     * Columns should be added in the same order for every dump, so that
+     * their storage is reused.
+     */
+    void * add_column( const char * name, size_t element_size, size_t n );
+
+    template< typename T > T * add_column( const char * name, size_t n ) {
+      return (T *) add_column( name, sizeof( T ), n );
+    }
+
+    /// @return the column with the given name, or NULL
+    const Column * find_column( const char * name ) const;
+  };
+
+  /**
+   * @param compress if true, columns are compressed with snappy (each is
+   * stored uncompressed if that is no larger)
+   */
+  Population_Dump( bool compress );
+  ~Population_Dump();
+
+  /**
+   * Waits until a frame is free, and returns it empty.  Returns NULL if the
+   * writing of an earlier dump failed (see get_error).
+   */
+  Frame * begin_frame();
+
+  /// queues a frame from begin_frame to be written by the background thread
+  void write_frame( Frame * frame );
+
+  /**
+   * Waits until every queued frame has been written, and stops the
+   * background thread.
+   * @return <code>false</code> if any write failed (see get_error)
+   */
+  bool finish();
+
+  const std::string & get_error() { return error; }
+
+  /// bytes written to dump files so far (after compression)
+  uint64_t get_bytes_written();
+
+  /**
+   * Reads a dump file into frame, uncompressing its columns.
+   * @return <code>false</code> if the file could not be read, with the reason
+   * in error
+   */
+  static bool read( const char * filename, Frame & frame, std::string & error );
+
+private:
+
+  struct Dump_Header {
+    char magic[ 8 ];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t column_header_size;
+    uint32_t number_columns;
+    int32_t day;
+    char date[ 16 ];
+    uint32_t number_of_diseases;
+    uint32_t padding;
+    uint64_t number_persons;
+    uint64_t number_places;
+  };
+
+  struct Column_Header {
+    char name[ NAME_SIZE ];
+    uint32_t element_size;
+    uint32_t compressed;
+    uint64_t size;                 // uncompressed
+    uint64_t stored_size;
+  };
+
+  static const char MAGIC[ 8 ];
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+  enum Frame_State { FREE, FILLING, QUEUED };
+
+  bool compress;
+  Frame frames[ 2 ];
+  Frame_State state[ 2 ];
+  std::deque< int > queue;
+  bool stopping;
+  std::string error;
+  uint64_t bytes_written;
+
+  std::thread writer;
+  std::mutex lock;
+  std::condition_variable changed;
+
+  void run_writer();
+  bool write_file( const Frame & frame, std::string & message );
+
+  static size_t align( size_t offset ) { return ( offset + 7 ) & ~( (size_t) 7 ); }
+};
+
+#endif // _FRED_POPULATION_DUMP_H
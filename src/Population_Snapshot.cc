@@ -0,0 +1,254 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Population_Snapshot.cc
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Population_Snapshot.h"
+#include "Place_List.h"
+#include "Utils.h"
+
+const char Population_Snapshot::MAGIC[ 8 ] = { 'F', 'R', 'E', 'D', 'P', 'O', 'P', '\0' };
+
+Population_Snapshot::Population_Snapshot( const char * _filename, const std::string & _fingerprint ) {
+  char name[ FRED_STRING_SIZE ];
+  strcpy( name, _filename );
+  Utils::get_fred_file_name( name );
+  filename = name;
+  fingerprint = _fingerprint;
+  loaded = false;
+  map = NULL;
+  map_size = 0;
+  number_places = 0;
+  number_persons = 0;
+}
+
+Population_Snapshot::~Population_Snapshot() {
+  unload();
+}
+
+bool Population_Snapshot::load() {
+  int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 ) {
+    FRED_STATUS( 0, "population snapshot %s not found; it will be written after reading the population\n",
+        filename.c_str() );
+    return false;
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || st.st_size < (off_t) sizeof( Snapshot_Header ) ) {
+    close( fd );
+    Utils::fred_abort( "population snapshot %s is too short\n", filename.c_str() );
+  }
+  map_size = st.st_size;
+  map = mmap( NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if ( map == MAP_FAILED ) {
+    map = NULL;
+    Utils::fred_abort( "unable to map population snapshot %s\n", filename.c_str() );
+  }
+
+  const char * base = (const char *) map;
+  const Snapshot_Header * header = (const Snapshot_Header *) base;
+  if ( memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) != 0
+      || header->byte_order != BYTE_ORDER_MARK ) {
+    Utils::fred_abort( "%s is not a population snapshot for this machine\n", filename.c_str() );
+  }
+  if ( header->version != VERSION
+      || header->header_size != sizeof( Snapshot_Header )
+      || header->label_size != LABEL_SIZE
+      || header->census_block_size != CENSUS_BLOCK_SIZE
+      || header->person_size != sizeof( Snapshot_Person )
+      || header->geo_size != sizeof( fred::geo ) ) {
+    Utils::fred_abort( "population snapshot %s has version %d (expected %d); delete it to rebuild it\n",
+        filename.c_str(), header->version, VERSION );
+  }
+  if ( header->file_size != map_size ) {
+    Utils::fred_abort( "population snapshot %s is truncated\n", filename.c_str() );
+  }
+
+  size_t offset = align( sizeof( Snapshot_Header ) );
+  std::string snapshot_fingerprint( base + offset, header->fingerprint_size );
+  if ( snapshot_fingerprint != fingerprint ) {
+    Utils::fred_abort( "population snapshot %s was made from a different population:\n%s\n%s\n",
+        filename.c_str(), snapshot_fingerprint.c_str(), fingerprint.c_str() );
+  }
+  offset = align( offset + header->fingerprint_size );
+
+  number_places = header->number_places;
+  number_persons = header->number_persons;
+  place_type = base + offset;
+  offset = align( offset + number_places );
+  place_deme = (const unsigned char *) ( base + offset );
+  offset = align( offset + number_places );
+  place_gq = base + offset;
+  offset = align( offset + number_places );
+  place_income = (const int32_t *) ( base + offset );
+  offset = align( offset + number_places * sizeof( int32_t ) );
+  place_lat = (const fred::geo *) ( base + offset );
+  offset = align( offset + number_places * sizeof( fred::geo ) );
+  place_lon = (const fred::geo *) ( base + offset );
+  offset = align( offset + number_places * sizeof( fred::geo ) );
+  place_label = base + offset;
+  offset = align( offset + (size_t) number_places * LABEL_SIZE );
+  place_block = base + offset;
+  offset = align( offset + (size_t) number_places * CENSUS_BLOCK_SIZE );
+  persons = (const Snapshot_Person *) ( base + offset );
+  offset = align( offset + (size_t) number_persons * sizeof( Snapshot_Person ) );
+  assert( offset == map_size );
+
+  loaded = true;
+  FRED_STATUS( 0, "loaded population snapshot %s: %d places, %d persons\n",
+      filename.c_str(), number_places, number_persons );
+  return true;
+}
+
+void Population_Snapshot::unload() {
+  if ( map != NULL ) {
+    munmap( map, map_size );
+    map = NULL;
+    map_size = 0;
+  }
+  recorded_type = std::vector< char >();
+  recorded_deme = std::vector< unsigned char >();
+  recorded_gq = std::vector< char >();
+  recorded_income = std::vector< int32_t >();
+  recorded_lat = std::vector< fred::geo >();
+  recorded_lon = std::vector< fred::geo >();
+  recorded_label = std::vector< char >();
+  recorded_block = std::vector< char >();
+  recorded_persons = std::vector< Snapshot_Person >();
+}
+
+void Population_Snapshot::get_place_init_data( std::vector< Place_Init_Data > & place_init_data ) {
+  assert( loaded );
+  place_init_data.clear();
+  place_init_data.reserve( number_places );
+  for ( int i = 0; i < number_places; ++i ) {
+    place_init_data.push_back( Place_Init_Data( place_label + (size_t) i * LABEL_SIZE,
+          place_type[ i ], place_lat[ i ], place_lon[ i ], place_deme[ i ],
+          std::string( place_block + (size_t) i * CENSUS_BLOCK_SIZE ),
+          place_income[ i ], place_gq[ i ] ) );
+  }
+}
+
+void Population_Snapshot::record_places( const std::vector< Place_Init_Data > & place_init_data ) {
+  int n = place_init_data.size();
+  recorded_type.resize( n );
+  recorded_deme.resize( n );
+  recorded_gq.resize( n );
+  recorded_income.resize( n );
+  recorded_lat.resize( n );
+  recorded_lon.resize( n );
+  recorded_label.assign( (size_t) n * LABEL_SIZE, '\0' );
+  recorded_block.assign( (size_t) n * CENSUS_BLOCK_SIZE, '\0' );
+  for ( int i = 0; i < n; ++i ) {
+    const Place_Init_Data & pid = place_init_data[ i ];
+    if ( strlen( pid.s ) >= LABEL_SIZE || pid.census_block.size() >= CENSUS_BLOCK_SIZE ) {
+      Utils::fred_abort( "place label %s is too long for the population snapshot\n", pid.s );
+    }
+    recorded_type[ i ] = pid.place_type;
+    recorded_deme[ i ] = pid.deme_id;
+    recorded_gq[ i ] = pid.is_group_quarters;
+    recorded_income[ i ] = pid.income;
+    recorded_lat[ i ] = pid.lat;
+    recorded_lon[ i ] = pid.lon;
+    strcpy( &( recorded_label[ (size_t) i * LABEL_SIZE ] ), pid.s );
+    strcpy( &( recorded_block[ (size_t) i * CENSUS_BLOCK_SIZE ] ), pid.census_block.c_str() );
+  }
+}
+
+void Population_Snapshot::record_person( int id, int age, char sex, int race, int relationship,
+    int house, int work, int school ) {
+  Snapshot_Person person;
+  memset( &person, 0, sizeof( person ) );
+  person.id = id;
+  person.age = age;
+  person.sex = sex;
+  person.race = race;
+  person.relationship = relationship;
+  person.house = house;
+  person.work = work;
+  person.school = school;
+  recorded_persons.push_back( person );
+}
+
+void Population_Snapshot::write_section( FILE * fp, const void * data, size_t size, size_t * offset ) {
+  static const char zeros[ 8 ] = { 0 };
+  if ( size > 0 && fwrite( data, 1, size, fp ) != size ) {
+    Utils::fred_abort( "error writing population snapshot %s\n", filename.c_str() );
+  }
+  size_t end = align( *offset + size );
+  if ( end > *offset + size ) {
+    fwrite( zeros, 1, end - ( *offset + size ), fp );
+  }
+  *offset = end;
+}
+
+void Population_Snapshot::write() {
+  char temporary[ FRED_STRING_SIZE ];
+  sprintf( temporary, "%s.%d.tmp", filename.c_str(), (int) getpid() );
+  FILE * fp = fopen( temporary, "wb" );
+  if ( fp == NULL ) {
+    Utils::fred_abort( "unable to write population snapshot %s\n", temporary );
+  }
+
+  size_t n = recorded_type.size();
+  Snapshot_Header header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+  header.byte_order = BYTE_ORDER_MARK;
+  header.version = VERSION;
+  header.header_size = sizeof( Snapshot_Header );
+  header.label_size = LABEL_SIZE;
+  header.census_block_size = CENSUS_BLOCK_SIZE;
+  header.person_size = sizeof( Snapshot_Person );
+  header.geo_size = sizeof( fred::geo );
+  header.fingerprint_size = fingerprint.size();
+  header.number_places = n;
+  header.number_persons = recorded_persons.size();
+  header.file_size = align( sizeof( Snapshot_Header ) )
+    + align( fingerprint.size() )
+    + 3 * align( n )
+    + align( n * sizeof( int32_t ) )
+    + 2 * align( n * sizeof( fred::geo ) )
+    + align( n * LABEL_SIZE )
+    + align( n * CENSUS_BLOCK_SIZE )
+    + align( recorded_persons.size() * sizeof( Snapshot_Person ) );
+
+  size_t offset = 0;
+  write_section( fp, &header, sizeof( header ), &offset );
+  write_section( fp, fingerprint.data(), fingerprint.size(), &offset );
+  write_section( fp, n ? &recorded_type[ 0 ] : NULL, n, &offset );
+  write_section( fp, n ? &recorded_deme[ 0 ] : NULL, n, &offset );
+  write_section( fp, n ? &recorded_gq[ 0 ] : NULL, n, &offset );
+  write_section( fp, n ? &recorded_income[ 0 ] : NULL, n * sizeof( int32_t ), &offset );
+  write_section( fp, n ? &recorded_lat[ 0 ] : NULL, n * sizeof( fred::geo ), &offset );
+  write_section( fp, n ? &recorded_lon[ 0 ] : NULL, n * sizeof( fred::geo ), &offset );
+  write_section( fp, n ? &recorded_label[ 0 ] : NULL, n * LABEL_SIZE, &offset );
+  write_section( fp, n ? &recorded_block[ 0 ] : NULL, n * CENSUS_BLOCK_SIZE, &offset );
+  write_section( fp, recorded_persons.empty() ? NULL : &recorded_persons[ 0 ],
+      recorded_persons.size() * sizeof( Snapshot_Person ), &offset );
+  assert( offset == header.file_size );
+
+  if ( fclose( fp ) != 0 || rename( temporary, filename.c_str() ) != 0 ) {
+    Utils::fred_abort( "error writing population snapshot %s\n", filename.c_str() );
+  }
+  FRED_STATUS( 0, "wrote population snapshot %s: %d places, %d persons\n",
+      filename.c_str(), (int) n, (int) recorded_persons.size() );
+}
@@ -0,0 +1,175 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Population_Snapshot.h
+//
+
+#ifndef _FRED_POPULATION_SNAPSHOT_H
+#define _FRED_POPULATION_SNAPSHOT_H
+
+/*
+ * Binary snapshot of a synthetic population (the files produced by
+ * fred_convert_pop or RTI: *_synth_households.txt, *_workplaces.txt,
+ * *_schools.txt, *_synth_gq.txt, *_synth_people.txt, *_synth_gq_people.txt),
+ * used when the population_snapshot_file parameter is set.
+ *
+ * If the snapshot file exists it is memory-mapped and the places and people
+ * are created directly from it, with no text parsing and no place label
+ * lookups.  Otherwise the text files are read as usual, and what was read is
+ * recorded and written to the snapshot for later runs.
+ *
+ * Layout (native byte order; every section starts on an 8-byte boundary):
+ *
+ *   Snapshot_Header
+ *   fingerprint       char[ fingerprint_size ]  population directory, ids, options
+ *   place_type        char[ number_places ]
+ *   place_deme        unsigned char[ number_places ]
+ *   place_gq          char[ number_places ]     1 if group quarters
+ *   place_income      int32_t[ number_places ]
+ *   place_lat         fred::geo[ number_places ]
+ *   place_lon         fred::geo[ number_places ]
+ *   place_label       char[ number_places ][ LABEL_SIZE ]
+ *   place_block       char[ number_places ][ CENSUS_BLOCK_SIZE ]
+ *   persons           Snapshot_Person[ number_persons ]
+ *
+ * Places are stored in the order in which Place_List creates them, so a
+ * place's index in the snapshot is its place id; people are stored in the
+ * order in which they were added to the population.
+ */
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Global.h"
+
+class Place_Init_Data;
+
+class Population_Snapshot {
+
+public:
+
+  static const uint32_t VERSION = 1;
+  static const int LABEL_SIZE = 32;
+  static const int CENSUS_BLOCK_SIZE = 16;
+
+  // place index values for a person's house, work or school
+  static const int32_t NO_PLACE = -1;
+  // workplace not in the population; assign a random one when loading (see
+  // enable_local_workplace_assignment)
+  static const int32_t RANDOM_WORKPLACE = -2;
+
+  struct Snapshot_Person {
+    int32_t id;
+    int32_t age;
+    int32_t race;
+    int32_t relationship;
+    int32_t house;
+    int32_t work;
+    int32_t school;
+    char sex;
+    char padding[ 3 ];
+  };
+
+  /**
+   * @param filename the snapshot file
+   * @param fingerprint describes the population; a snapshot is only loaded
+   * if it was written with the same fingerprint
+   */
+  Population_Snapshot( const char * filename, const std::string & fingerprint );
+  ~Population_Snapshot();
+
+  /**
+   * Map the snapshot file, if it exists.  Aborts if the file exists but is
+   * not a valid snapshot of this population.
+   * @return <code>true</code> if the snapshot was loaded
+   */
+  bool load();
+
+  bool is_loaded() { return loaded; }
+
+  /// release the mapped file once places and people have been created
+  void unload();
+
+  int get_number_of_places() { return number_places; }
+  void get_place_init_data( std::vector< Place_Init_Data > & place_init_data );
+
+  int get_number_of_persons() { return number_persons; }
+  const Snapshot_Person & get_person( int i ) { return persons[ i ]; }
+
+  // recording, when the snapshot was not loaded
+  void record_places( const std::vector< Place_Init_Data > & place_init_data );
+  void record_person( int id, int age, char sex, int race, int relationship,
+      int house, int work, int school );
+
+  /**
+   * Write the recorded places and people.  The file is written under a
+   * temporary name and renamed, so concurrent runs never see a partial file.
+   */
+  void write();
+
+private:
+
+  struct Snapshot_Header {
+    char magic[ 8 ];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t label_size;
+    uint32_t census_block_size;
+    uint32_t person_size;
+    uint32_t geo_size;
+    uint32_t fingerprint_size;
+    uint64_t number_places;
+    uint64_t number_persons;
+    uint64_t file_size;
+  };
+
+  static const char MAGIC[ 8 ];
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+  std::string filename;
+  std::string fingerprint;
+  bool loaded;
+
+  // mapped file
+  void * map;
+  size_t map_size;
+
+  int number_places;
+  int number_persons;
+  const char * place_type;
+  const unsigned char * place_deme;
+  const char * place_gq;
+  const int32_t * place_income;
+  const fred::geo * place_lat;
+  const fred::geo * place_lon;
+  const char * place_label;
+  const char * place_block;
+  const Snapshot_Person * persons;
+
+  // recorded data, when writing
+  std::vector< char > recorded_type;
+  std::vector< unsigned char > recorded_deme;
+  std::vector< char > recorded_gq;
+  std::vector< int32_t > recorded_income;
+  std::vector< fred::geo > recorded_lat;
+  std::vector< fred::geo > recorded_lon;
+  std::vector< char > recorded_label;
+  std::vector< char > recorded_block;
+  std::vector< Snapshot_Person > recorded_persons;
+
+  static size_t align( size_t offset ) { return ( offset + 7 ) & ~( (size_t) 7 ); }
+  void write_section( FILE * fp, const void * data, size_t size, size_t * offset );
+};
+
+#endif // _FRED_POPULATION_SNAPSHOT_H
@@ -58,8 +58,8 @@ double draw_normal(double mu, double sigma) {
 }
 
 
-int draw_from_cdf(double *v, int size) {
-  double r = RANDOM();
+// the index s of the first element of the increasing array v with r <= v[s]
+static int search_cdf(double r, const double *v, int size) {
   int top = size-1;
   int bottom = 0;
   int s = top / 2;
@@ -86,33 +86,15 @@ int draw_from_cdf(double *v, int size) {
   return -1;
 }
 
+int draw_from_cdf(double *v, int size) {
+  double r = RANDOM();
+  return search_cdf(r, v, size);
+}
+
 int draw_from_cdf_vector(const vector <double>& v) {
   int size = v.size();
   double r = RANDOM();
-  int top = size-1;
-  int bottom = 0;
-  int s = top / 2;
-  while (bottom <= top) {
-    if (r <= v[s]) {
-      if (s == 0 || r > v[s-1])
-        return s;
-      else {
-        top = s-1;
-      }
-    }
-    else { // r > v[s]
-      if (s == size-1)
-        return s;
-      if (r < v[s+1])
-        return s+1;
-      else {
-        bottom = s+1;
-      }
-    }
-    s = bottom + (top-bottom)/2;
-  }
-  // assert(bottom <= top);
-  return -1;
+  return search_cdf(r, &v[0], size);
 }
 
 using namespace std;
@@ -153,12 +135,10 @@ double binomial_coefficient( int n, int k ) {
 }
 
 void build_binomial_cdf( double p, int n, std::vector< double > & cdf ) {
+  cdf.clear();
   for ( int i = 0; i <= n; ++i ) {
-    double prob = 0.0;
-    for ( int j = 0; j <= i; ++j ) {
-      prob += binomial_coefficient( n, i ) 
-        * pow( 10, ( ( i * log10( p ) ) + ( ( n - 1 ) * log10( 1 - p ) ) ) );
-    }
+    double prob = binomial_coefficient( n, i ) 
+      * pow( 10, ( ( i * log10( p ) ) + ( ( n - i ) * log10( 1 - p ) ) ) );
     if ( i > 0 ) {
       prob += cdf.back();
     }
@@ -173,6 +153,26 @@ void build_binomial_cdf( double p, int n, std::vector< double > & cdf ) {
   cdf.back() = 1.0;
 }
 
+/*
+Binomial variate by geometric skipping: the gaps between successes in a
+sequence of Bernoulli(p) trials are geometric, so only the successes (or,
+for p > 0.5, the failures) cost a random number.
+*/
+
+int draw_binomial(int n, double p) {
+  if (n <= 0 || p <= 0.0) return 0;
+  if (p >= 1.0) return n;
+  if (p > 0.5) return n - draw_binomial(n, 1.0 - p);
+  double log_q = log(1.0 - p);
+  double trials = 0.0;
+  int k = -1;
+  do {
+    trials += floor(log(1.0 - RANDOM()) / log_q) + 1.0;
+    k++;
+  } while (trials <= n);
+  return k;
+}
+
 void sample_range_without_replacement( int N, int s, int * result ) {
   std::vector< bool > selected( N, false );
   for ( int n = 0; n < s; ++n ) {
@@ -196,42 +196,281 @@ void sample_range_without_replacement( int N, int s, int * result ) {
 
 
 /////////////////////////////////////////////////////////////////
+// batch draws
+
+// uniforms are drawn into a chunk on the stack, then transformed
+static const int BATCH_CHUNK = 512;
+
+void draw_uniform_batch( double * out, int n ) {
+  RNG::random_doubles( out, n );
+}
+
+void draw_exponential_batch( double lambda, double * out, int n ) {
+  RNG::random_doubles( out, n );
+  for ( int i = 0; i < n; ++i ) {
+    out[ i ] = -log( out[ i ] ) / lambda;
+  }
+}
+
+void draw_standard_normal_batch( double * out, int n ) {
+  // Box-Muller, from the same (U,V) pairs as draw_standard_normal
+  double u[ BATCH_CHUNK ];
+  for ( int first = 0; first < n; first += BATCH_CHUNK / 2 ) {
+    int count = n - first < BATCH_CHUNK / 2 ? n - first : BATCH_CHUNK / 2;
+    RNG::random_doubles( u, 2 * count );
+    for ( int i = 0; i < count; ++i ) {
+      out[ first + i ] = sqrt( -2.0 * log( u[ 2 * i ] ) ) * cos( TWOPI * u[ 2 * i + 1 ] );
+    }
+  }
+}
+
+void draw_normal_batch( double mu, double sigma, double * out, int n ) {
+  draw_standard_normal_batch( out, n );
+  for ( int i = 0; i < n; ++i ) {
+    out[ i ] = mu + sigma * out[ i ];
+  }
+}
+
+void draw_from_cdf_batch( double * v, int size, int * out, int n ) {
+  double u[ BATCH_CHUNK ];
+  for ( int first = 0; first < n; first += BATCH_CHUNK ) {
+    int count = n - first < BATCH_CHUNK ? n - first : BATCH_CHUNK;
+    RNG::random_doubles( u, count );
+    for ( int i = 0; i < count; ++i ) {
+      out[ first + i ] = search_cdf( u[ i ], v, size );
+    }
+  }
+}
 
-RNG_State< 8192, 1024, 1024, 2048 > rng_state[ Global::MAX_NUM_THREADS ];
+// beyond this the Poisson table gets long and exp(-lambda) heads for underflow
+static const double POISSON_TABLE_MAX_LAMBDA = 500.0;
+
+void draw_poisson_batch( double lambda, int * out, int n ) {
+  if ( lambda <= 0.0 || lambda > POISSON_TABLE_MAX_LAMBDA ) {
+    for ( int i = 0; i < n; ++i ) {
+      out[ i ] = draw_poisson( lambda );
+    }
+    return;
+  }
+  // the probabilities of 0, 1, 2, ... until the tail is negligible
+  std::vector< double > pdf;
+  double p = exp( -lambda );
+  double total = 0.0;
+  for ( int k = 0; ; ++k ) {
+    pdf.push_back( p );
+    total += p;
+    if ( k > lambda && p < 1.0e-17 * total ) {
+      break;
+    }
+    p *= lambda / ( k + 1 );
+  }
+  Alias_Table table;
+  table.build( &pdf[ 0 ], pdf.size() );
+  table.draw_batch( out, n );
+}
+
+// build_binomial_cdf's coefficients overflow beyond about this many trials
+static const int BINOMIAL_TABLE_MAX_TRIALS = 1000;
+
+void draw_binomial_batch( int trials, double p, int * out, int n ) {
+  if ( trials <= 0 || p <= 0.0 || p >= 1.0 || trials > BINOMIAL_TABLE_MAX_TRIALS ) {
+    for ( int i = 0; i < n; ++i ) {
+      out[ i ] = draw_binomial( trials, p );
+    }
+    return;
+  }
+  std::vector< double > cdf;
+  build_binomial_cdf( p, trials, cdf );
+  Alias_Table table;
+  table.build_from_cdf( &cdf[ 0 ], cdf.size() );
+  table.draw_batch( out, n );
+}
+
+void Alias_Table::build( const double * pdf, int size ) {
+  prob.assign( size, 1.0 );
+  alias.resize( size );
+  double total = 0.0;
+  for ( int i = 0; i < size; ++i ) {
+    total += pdf[ i ];
+  }
+  // columns with less than the average weight are topped up from the others
+  std::vector< double > scaled( size );
+  std::vector< int > small;
+  std::vector< int > large;
+  for ( int i = 0; i < size; ++i ) {
+    alias[ i ] = i;
+    scaled[ i ] = pdf[ i ] * size / total;
+    if ( scaled[ i ] < 1.0 ) {
+      small.push_back( i );
+    }
+    else {
+      large.push_back( i );
+    }
+  }
+  while ( !small.empty() && !large.empty() ) {
+    int s = small.back();
+    small.pop_back();
+    int l = large.back();
+    prob[ s ] = scaled[ s ];
+    alias[ s ] = l;
+    scaled[ l ] = ( scaled[ l ] + scaled[ s ] ) - 1.0;
+    if ( scaled[ l ] < 1.0 ) {
+      large.pop_back();
+      small.push_back( l );
+    }
+  }
+  // whatever is left is full, up to rounding
+  for ( int i = 0; i < (int) small.size(); ++i ) {
+    prob[ small[ i ] ] = 1.0;
+  }
+  for ( int i = 0; i < (int) large.size(); ++i ) {
+    prob[ large[ i ] ] = 1.0;
+  }
+}
+
+void Alias_Table::build_from_cdf( const double * cdf, int size ) {
+  std::vector< double > pdf( size );
+  for ( int i = 0; i < size; ++i ) {
+    pdf[ i ] = cdf[ i ] - ( i > 0 ? cdf[ i - 1 ] : 0.0 );
+  }
+  build( &pdf[ 0 ], size );
+}
+
+void Alias_Table::draw_batch( int * out, int n ) const {
+  double u[ BATCH_CHUNK ];
+  for ( int first = 0; first < n; first += BATCH_CHUNK ) {
+    int count = n - first < BATCH_CHUNK ? n - first : BATCH_CHUNK;
+    RNG::random_doubles( u, count );
+    for ( int i = 0; i < count; ++i ) {
+      out[ first + i ] = lookup( u[ i ] );
+    }
+  }
+}
+
+
+/////////////////////////////////////////////////////////////////
+
+Thread_RNG_State rng_state[ Global::MAX_NUM_THREADS ];
+
+bool RNG::counter_streams = false;
+uint32_t RNG::counter_seed = 0;
+Counter_Stream RNG::serial_stream;
+
+// each thread's current keyed stream (NULL for the serial stream), padded
+// so that threads entering and leaving streams don't share a cache line
+struct Current_Stream {
+  Counter_Stream * stream;
+  char pad[ 64 - sizeof( Counter_Stream * ) ];
+  Current_Stream() : stream( NULL ) { }
+};
+
+static Current_Stream current_stream[ Global::MAX_NUM_THREADS ];
+
+void Counter_Stream::refresh_output() {
+  uint32_t k0 = key[ 0 ];
+  uint32_t k1 = key[ 1 ];
+  uint32_t x0 = counter[ 0 ];
+  uint32_t x1 = counter[ 1 ];
+  uint32_t x2 = counter[ 2 ];
+  uint32_t x3 = counter[ 3 ];
+  for ( int round = 0; round < 10; ++round ) {
+    uint64_t p0 = (uint64_t) 0xD2511F53 * x0;
+    uint64_t p1 = (uint64_t) 0xCD9E8D57 * x2;
+    x0 = (uint32_t) ( p1 >> 32 ) ^ x1 ^ k0;
+    x1 = (uint32_t) p1;
+    x2 = (uint32_t) ( p0 >> 32 ) ^ x3 ^ k1;
+    x3 = (uint32_t) p0;
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+  output[ 0 ] = x0;
+  output[ 1 ] = x1;
+  output[ 2 ] = x2;
+  output[ 3 ] = x3;
+  ++counter[ 0 ];
+  output_index = 0;
+}
 
 void RNG::init( int seed ) {
   dsfmt_gv_init_gen_rand( seed );
+  // the doubles' seeds come first, so they are the same as before the
+  // bytes and integers had seeds of their own
+  uint32_t seed_dbl[ Global::MAX_NUM_THREADS ];
   for (int i = 0; i < Global::MAX_NUM_THREADS; ++i) {
-    rng_state[ i ] = RNG_State< 8192, 1024, 1024, 2048 >();
-    rng_state[ i ].init( dsfmt_gv_genrand_uint32() );
+    seed_dbl[ i ] = dsfmt_gv_genrand_uint32();
   }
+  for (int i = 0; i < Global::MAX_NUM_THREADS; ++i) {
+    uint32_t seed_char = dsfmt_gv_genrand_uint32();
+    uint32_t seed_int = dsfmt_gv_genrand_uint32();
+    rng_state[ i ] = Thread_RNG_State();
+    rng_state[ i ].init( seed_dbl[ i ], seed_char, seed_int );
+  }
+  counter_seed = seed;
+  serial_stream.init( counter_seed, RNG_Stream::SERIAL, 0, 0, 0 );
+}
+
+Counter_Stream * RNG::get_counter_stream() {
+  Counter_Stream * stream = current_stream[ fred::omp_get_thread_num() ].stream;
+  return stream == NULL ? &serial_stream : stream;
 }
 
 double RNG::random_double() {
   assert( fred::omp_get_thread_num() < Global::MAX_NUM_THREADS );
+  if ( counter_streams ) {
+    return get_counter_stream()->random_double();
+  }
   return rng_state[ fred::omp_get_thread_num() ].random_double();
 }
 
+void RNG::random_doubles( double * out, int n ) {
+  assert( fred::omp_get_thread_num() < Global::MAX_NUM_THREADS );
+  if ( counter_streams ) {
+    Counter_Stream * stream = get_counter_stream();
+    for ( int i = 0; i < n; ++i ) {
+      out[ i ] = stream->random_double();
+    }
+    return;
+  }
+  rng_state[ fred::omp_get_thread_num() ].random_doubles( out, n );
+}
+
 unsigned char RNG::random_char() {
   assert( fred::omp_get_thread_num() < Global::MAX_NUM_THREADS );
+  if ( counter_streams ) {
+    return get_counter_stream()->random_char();
+  }
   return rng_state[ fred::omp_get_thread_num() ].random_char();
 }
 
 int RNG::random_int_0_7() {
   assert( fred::omp_get_thread_num() < Global::MAX_NUM_THREADS );
-  int int_0_7 = ( (int) ( rng_state[ fred::omp_get_thread_num() ].random_char() >> 5 ) );
+  int int_0_7 = ( (int) ( random_char() >> 5 ) );
   assert( int_0_7 < 8 && int_0_7 >= 0 );
   return int_0_7;
 }
 
 void RNG::refresh_all_buffers() {
   assert( fred::omp_get_thread_num() < Global::MAX_NUM_THREADS );
+  if ( counter_streams ) {
+    return;
+  }
   #pragma omp parallel for
   for ( int t = 0; t < fred::omp_get_max_threads(); ++t ) {
     rng_state[ t ].refresh_all_buffers();
   }
 }
 
+void RNG_Stream::begin( Kind kind, int day, int id, int sub ) {
+  stream.init( RNG::counter_seed, kind, id, day, sub );
+  Current_Stream & current = current_stream[ fred::omp_get_thread_num() ];
+  enclosing = current.stream;
+  current.stream = &stream;
+}
+
+void RNG_Stream::end() {
+  current_stream[ fred::omp_get_thread_num() ].stream = enclosing;
+}
+
 
 
 
@@ -18,7 +18,10 @@
 #define _FRED_RANDOM_H
 
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include <vector>
+#include <algorithm>
 
 #include "Global.h"
 
@@ -38,7 +41,7 @@
 #define INIT_RANDOM(SEED)   RNG::init(SEED)
 #define RANDOM()        RNG::random_double()
 
-#define IRAND(LOW,HIGH) ( (int) ( (LOW) + (int) ( ( (HIGH)-(LOW)+1 ) * RNG::random_double() ) ) )
+#define IRAND(LOW,HIGH) ( (int) ( (LOW) + RNG::random_int( (HIGH)-(LOW)+1 ) ) )
 #define URAND(LOW,HIGH) ((double)((LOW)+(((HIGH)-(LOW))*RANDOM())))
 
 #define IRAND_0_7() ( RNG::random_int_0_7() )
@@ -46,36 +49,58 @@
 
 
 
-// BufferLengthChar must be multiple of 4
+// Raw output of dSFMT: doubles in [1,2), whose low 52 bits are random.  The
+// integer and byte streams are cut from these bits, a buffer at a time, with
+// the same array generator as the doubles (dsfmt_genrand_uint32 also takes
+// the low 32 bits of the raw words).
+union RNG_Word {
+  double d;
+  uint64_t u;
+};
+
+// The buffers of raw words must be even in length and at least DSFMT_N64
+// (the minimum array size for dSFMT), so BufferLengthChar must be a multiple
+// of 6 (six bytes are taken from each word) and at least 6 * DSFMT_N64.
 
-template< int BufferLengthDouble, int BufferLengthChar, int BufferLengthInt, int MaxBufferedInt >
+template< int BufferLengthDouble, int BufferLengthChar, int BufferLengthInt >
 struct RNG_State {
 
+  static const int BYTES_PER_WORD = 6;
+  static const int BufferLengthCharWords = BufferLengthChar / BYTES_PER_WORD;
+
+  static_assert( BufferLengthChar % ( 2 * BYTES_PER_WORD ) == 0 && BufferLengthCharWords >= DSFMT_N64,
+      "RNG_State: bad BufferLengthChar" );
+  static_assert( BufferLengthInt % 2 == 0 && BufferLengthInt >= DSFMT_N64,
+      "RNG_State: bad BufferLengthInt" );
+
   double buffer_dbl[ BufferLengthDouble ];
   int buffer_index_dbl;
   dsfmt_t dsfmt_state_dbl;
 
-  union union_int {
-    struct union_char {
-      unsigned char c0, c1, c2, c3;
-    } uc;
-    unsigned int i;
-  };
-
-  char buffer_char[ BufferLengthChar ];
+  unsigned char buffer_char[ BufferLengthChar ];
+  RNG_Word buffer_char_words[ BufferLengthCharWords ];
   int buffer_index_char;
   dsfmt_t dsfmt_state_char;
 
+  RNG_Word buffer_int[ BufferLengthInt ];
+  int buffer_index_int;
+  dsfmt_t dsfmt_state_int;
+
   RNG_State() {
     buffer_index_dbl = BufferLengthDouble;
     buffer_index_char = BufferLengthChar;
+    buffer_index_int = BufferLengthInt;
     dsfmt_state_dbl = dsfmt_t();
     dsfmt_state_char = dsfmt_t();
+    dsfmt_state_int = dsfmt_t();
   }
    
-  void init( int seed ) {
-    dsfmt_init_gen_rand( &dsfmt_state_char, seed );
-    dsfmt_init_gen_rand( &dsfmt_state_dbl, seed );
+  // the streams are seeded separately, so that they are not cut from the
+  // same raw words
+  void init( uint32_t seed_dbl, uint32_t seed_char, uint32_t seed_int ) {
+    dsfmt_init_gen_rand( &dsfmt_state_dbl, seed_dbl );
+    dsfmt_init_gen_rand( &dsfmt_state_char, seed_char );
+    dsfmt_init_gen_rand( &dsfmt_state_int, seed_int );
   }
 
   double random_double() {
@@ -85,6 +110,23 @@ struct RNG_State {
     return buffer_dbl[ buffer_index_dbl++ ];
   }
 
+  // the next n doubles, as from n calls of random_double
+  void random_doubles( double * out, int n ) {
+    while ( n > 0 ) {
+      if ( buffer_index_dbl == BufferLengthDouble ) {
+        refresh_doubles_buffer();
+      }
+      int count = BufferLengthDouble - buffer_index_dbl;
+      if ( count > n ) {
+        count = n;
+      }
+      memcpy( out, buffer_dbl + buffer_index_dbl, count * sizeof( double ) );
+      buffer_index_dbl += count;
+      out += count;
+      n -= count;
+    }
+  }
+
   unsigned char random_char() {
     if ( buffer_index_char == BufferLengthChar ) {
       refresh_chars_buffer(); 
@@ -92,6 +134,13 @@ struct RNG_State {
     return buffer_char[ buffer_index_char++ ];
   }
 
+  uint32_t random_uint32() {
+    if ( buffer_index_int == BufferLengthInt ) {
+      refresh_ints_buffer();
+    }
+    return (uint32_t) buffer_int[ buffer_index_int++ ].u;
+  }
+
   void refresh_doubles_buffer() {
     dsfmt_fill_array_open_open( &dsfmt_state_dbl,
         buffer_dbl, BufferLengthDouble );
@@ -99,39 +148,224 @@ struct RNG_State {
   }
 
   void refresh_chars_buffer() {
-    int buffer_start = BufferLengthChar - buffer_index_char;
-    for ( int i = buffer_start; i < BufferLengthChar; i += 4 ) {
-      union_int u;
-      u.i = dsfmt_genrand_uint32( &dsfmt_state_char );
-      buffer_char[ i + 0 ] = u.uc.c0;
-      buffer_char[ i + 1 ] = u.uc.c1;
-      buffer_char[ i + 2 ] = u.uc.c1;
-      buffer_char[ i + 3 ] = u.uc.c1;
+    dsfmt_fill_array_close1_open2( &dsfmt_state_char,
+        &( buffer_char_words[ 0 ].d ), BufferLengthCharWords );
+    unsigned char * c = buffer_char;
+    for ( int i = 0; i < BufferLengthCharWords; ++i ) {
+      uint64_t bits = buffer_char_words[ i ].u;
+      for ( int b = 0; b < BYTES_PER_WORD; ++b ) {
+        *c++ = (unsigned char) ( bits >> ( 8 * b ) );
+      }
     }
     buffer_index_char = 0;
   }
 
+  void refresh_ints_buffer() {
+    dsfmt_fill_array_close1_open2( &dsfmt_state_int,
+        &( buffer_int[ 0 ].d ), BufferLengthInt );
+    buffer_index_int = 0;
+  }
+
   void refresh_all_buffers() {
     refresh_doubles_buffer();
     refresh_chars_buffer();
+    refresh_ints_buffer();
   }
 
 };
 
 
 
+// Counter-based generator (Philox4x32-10, Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3", SC11) used when counter streams are enabled
+// (see RNG_Stream).  The n-th block of output is a pure function of the key
+// and the counter, whose first word is n, so a stream can be started anywhere
+// without any state but its key and counter.
+
+struct Counter_Stream {
+
+  uint32_t key[ 2 ];
+  uint32_t counter[ 4 ];
+  uint32_t output[ 4 ];
+  int output_index;
+
+  void init( uint32_t seed, uint32_t kind, uint32_t id, uint32_t day, uint32_t sub ) {
+    key[ 0 ] = seed;
+    key[ 1 ] = kind;
+    counter[ 0 ] = 0;
+    counter[ 1 ] = id;
+    counter[ 2 ] = day;
+    counter[ 3 ] = sub;
+    output_index = 4;
+  }
+
+  uint32_t random_uint32() {
+    if ( output_index == 4 ) {
+      refresh_output();
+    }
+    return output[ output_index++ ];
+  }
+
+  // 53 random bits, in the open interval (0,1) like the dSFMT doubles
+  double random_double() {
+    uint64_t hi = random_uint32();
+    uint64_t x = ( hi << 32 ) | random_uint32();
+    return ( ( x >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+  }
+
+  unsigned char random_char() {
+    return (unsigned char) ( random_uint32() >> 24 );
+  }
+
+  void refresh_output();
+};
+
+
+
+typedef RNG_State< 8192, 2304, 1024 > Thread_RNG_State;
+
+extern Thread_RNG_State rng_state[ Global::MAX_NUM_THREADS ];
+
 struct RNG {
   static void init( int seed );
   static double random_double();
+  static void random_doubles( double * out, int n );
   static unsigned char random_char();
   static int random_int_0_7();
   static void refresh_all_buffers();
+
+  static uint32_t random_uint32() {
+    if ( counter_streams ) {
+      return get_counter_stream()->random_uint32();
+    }
+    return rng_state[ fred::omp_get_thread_num() ].random_uint32();
+  }
+
+  /**
+   * Uniform on 0..range-1 with no bias, by Lemire's multiply-and-shift
+   * ("Fast Random Integer Generation in an Interval", ACM TOMACS 2019): the
+   * high word of random_uint32() * range, redrawn in the rare case that the
+   * low word falls in the 2^32 mod range values that would favor some
+   * results.  One draw and no division almost always.
+   * @return 0 if range < 1
+   */
+  static int random_int( int range ) {
+    if ( range <= 1 ) {
+      return 0;
+    }
+    uint32_t r = (uint32_t) range;
+    uint64_t m = (uint64_t) random_uint32() * r;
+    uint32_t low = (uint32_t) m;
+    if ( low < r ) {
+      uint32_t threshold = ( 0u - r ) % r;
+      while ( low < threshold ) {
+        m = (uint64_t) random_uint32() * r;
+        low = (uint32_t) m;
+      }
+    }
+    return (int) ( m >> 32 );
+  }
+
+  // see RNG_Stream; set before init
+  static void use_counter_streams( bool enable ) { counter_streams = enable; }
+  static bool counter_streams;
+  static uint32_t counter_seed;
+  static Counter_Stream serial_stream;
+  static Counter_Stream * get_counter_stream();
+};
+
+
+
+/*
+ * Keys the draws made in a block of work when counter streams are enabled
+ * (enable_counter_rng), and does nothing otherwise.  While an RNG_Stream is
+ * in scope, the draws of the thread that created it come from a stream keyed
+ * by (seed, kind, day, id, sub), so they are the same whichever thread does
+ * the work and whatever else it did before; without one they come from a
+ * single serial stream.  Streams nest: the enclosing one resumes, where it
+ * left off, when the inner one goes out of scope.
+ */
+class RNG_Stream {
+
+public:
+
+  enum Kind {
+    SERIAL = 0,
+    SCHEDULE,           // a person's daily schedule (id is the person, sub the disease)
+    HEALTH,             // a person's daily health update
+    PLACE_SPREAD,       // a place's transmission set-up (sub is the disease)
+    INFECTOR_SPREAD,    // one infector's contacts in a place
+    TRANSMISSION,       // resolving the day's transmissions to a person
+    SAMPLE,             // sampling the infectious (sub is the disease)
+    INTERVENTION,       // a person's daily vaccine and antiviral update
+    BEHAVIOR            // a person's daily update of attitudes
+  };
+
+  RNG_Stream( Kind kind, int day, int id, int sub = 0 ) {
+    active = RNG::counter_streams;
+    if ( active ) {
+      begin( kind, day, id, sub );
+    }
+  }
+
+  ~RNG_Stream() {
+    if ( active ) {
+      end();
+    }
+  }
+
+private:
+
+  bool active;
+  Counter_Stream stream;
+  Counter_Stream * enclosing;
+
+  void begin( Kind kind, int day, int id, int sub );
+  void end();
+
+  RNG_Stream( const RNG_Stream & );
+  RNG_Stream & operator=( const RNG_Stream & );
+};
+
+/*
+ * While an RNG_Serial_Section is in scope, the draws of the thread that
+ * created it come from the generator of thread 0 (the threads' generators
+ * are swapped, and swapped back at the end).  Work done in order by one
+ * thread after another, as in an omp ordered section, then draws the same
+ * numbers as when one thread does it all.  Thread 0 must make no draws
+ * outside such sections meanwhile.  Counter streams need no swap, since the
+ * serial stream is shared by all threads.
+ */
+class RNG_Serial_Section {
+
+public:
+
+  RNG_Serial_Section() {
+    thread = fred::omp_get_thread_num();
+    if ( thread != 0 ) {
+      std::swap( rng_state[ 0 ], rng_state[ thread ] );
+    }
+  }
+
+  ~RNG_Serial_Section() {
+    if ( thread != 0 ) {
+      std::swap( rng_state[ 0 ], rng_state[ thread ] );
+    }
+  }
+
+private:
+
+  int thread;
+
+  RNG_Serial_Section( const RNG_Serial_Section & );
+  RNG_Serial_Section & operator=( const RNG_Serial_Section & );
 };
 
 
 // non-member functions 
 
 int draw_poisson(double lambda);
+int draw_binomial(int n, double p);
 double draw_exponential(double lambda);
 int draw_from_distribution(int n, double *dist);
 double draw_standard_normal();
@@ -142,6 +376,73 @@ double binomial_coefficient( int n, int k );
 void build_binomial_cdf( double p, int n, std::vector< double > & cdf );
 void sample_range_without_replacement( int n, int s, int * result );
 
+// Batch versions: each fills out[0..n-1] with n variates, drawing the
+// uniforms a buffer at a time.  The exponential, normal and cdf batches give
+// the same values, from the same random numbers, as n calls of the scalar
+// function.  The Poisson and binomial batches draw one uniform per variate
+// from an Alias_Table of the distribution, so they give the same
+// distribution as the scalar functions but not the same values.
+
+void draw_uniform_batch( double * out, int n );
+void draw_exponential_batch( double lambda, double * out, int n );
+void draw_standard_normal_batch( double * out, int n );
+void draw_normal_batch( double mu, double sigma, double * out, int n );
+void draw_from_cdf_batch( double * v, int size, int * out, int n );
+void draw_poisson_batch( double lambda, int * out, int n );
+void draw_binomial_batch( int trials, double p, int * out, int n );
+
+/*
+ * Walker's alias method (as in Vose, "A linear algorithm for generating
+ * random numbers with a given distribution", IEEE TSE 1991): draws from a
+ * discrete distribution over 0..size-1 in constant time, with one uniform,
+ * where draw_from_cdf needs a binary search.  Build once, draw many times.
+ */
+class Alias_Table {
+
+public:
+
+  Alias_Table() { }
+
+  /// @param pdf the (not necessarily normalized) weights of 0..size-1
+  void build( const double * pdf, int size );
+
+  /// @param cdf as for draw_from_cdf: increasing, with cdf[size-1] == 1
+  void build_from_cdf( const double * cdf, int size );
+
+  int size() const { return (int) prob.size(); }
+
+  int draw() const { return lookup( RANDOM() ); }
+
+  void draw_batch( int * out, int n ) const;
+
+private:
+
+  std::vector< double > prob;
+  std::vector< int > alias;
+
+  // the integer part of u * size picks a column, the fraction picks
+  // between the column and its alias
+  int lookup( double u ) const {
+    double x = u * prob.size();
+    int i = (int) x;
+    return ( x - i < prob[ i ] ) ? i : alias[ i ];
+  }
+};
+
+template <typename T> 
+void FYShuffle( T * array, int n ){
+  int m,randIndx;
+  T tmp;
+  m=n;
+  while (m > 0){
+    randIndx = (int)(RANDOM()*n);
+    m--;
+    tmp = array[m];
+    array[m] = array[randIndx];
+    array[randIndx] = tmp;
+  }
+}
+
 template <typename T> 
 void FYShuffle( std::vector <T> &array){
   int m,randIndx;
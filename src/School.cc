@@ -24,6 +24,7 @@
 #include "Classroom.h"
 #include "Date.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 
 //Private static variables that will be set by parameter lookups
 double * School::school_contacts_per_day;
@@ -260,6 +261,7 @@ double School::get_contacts_per_day(int disease_id) {
 }
 
 void School::enroll(Person * per) {
+  add_enrollee(per);
   N++;
   if (per->is_teacher()) {
     staff_size++;
@@ -276,6 +278,7 @@ void School::enroll(Person * per) {
 }
 
 void School::unenroll(Person * per) {
+  remove_enrollee(per);
   N--;
   if (per->is_teacher()) {
     staff_size--;
@@ -380,3 +383,30 @@ Place * School::select_classroom_for_student(Person *per) {
   return classrooms[grade][room];
 }
 
+void School::write_checkpoint(Checkpoint & checkpoint) {
+  Place::write_checkpoint(checkpoint);
+  checkpoint.write(students_with_age);
+  checkpoint.write(next_classroom);
+  checkpoint.write(closure_dates_have_been_set);
+  checkpoint.write(staff_size);
+}
+
+void School::read_checkpoint(Checkpoint & checkpoint) {
+  Place::read_checkpoint(checkpoint);
+  checkpoint.read(students_with_age);
+  checkpoint.read(next_classroom);
+  checkpoint.read(closure_dates_have_been_set);
+  checkpoint.read(staff_size);
+}
+
+void School::write_static_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write(global_closure_is_active);
+  checkpoint.write(global_close_date);
+  checkpoint.write(global_open_date);
+}
+
+void School::read_static_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read(global_closure_is_active);
+  checkpoint.read(global_close_date);
+  checkpoint.read(global_open_date);
+}
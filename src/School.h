@@ -42,6 +42,19 @@ public:
   double get_contacts_per_day(int disease_id);
   void enroll(Person * per);
   void unenroll(Person * per);
+
+  /**
+   * @see Place::write_checkpoint(Checkpoint & checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
+  /**
+   * Write the state of the global school closure policy to a checkpoint, or
+   * read it back
+   */
+  static void write_static_checkpoint(Checkpoint & checkpoint);
+  static void read_static_checkpoint(Checkpoint & checkpoint);
   int children_in_grade(int age) {
     if (0 <= age && age < GRADES)
       return students_with_age[age];
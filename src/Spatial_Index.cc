@@ -0,0 +1,168 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Spatial_Index.cc
+//
+
+#include <algorithm>
+#include <utility>
+#include <math.h>
+
+#include "Spatial_Index.h"
+
+using namespace std;
+
+Spatial_Index::Spatial_Index() {
+  rows = 0;
+  cols = 0;
+  min_x = 0.0;
+  min_y = 0.0;
+  cell_size = 1.0;
+}
+
+void Spatial_Index::build( int _rows, int _cols, double _min_x, double _min_y, double _cell_size,
+    const vector< double > & x, const vector< double > & y ) {
+  rows = _rows;
+  cols = _cols;
+  min_x = _min_x;
+  min_y = _min_y;
+  cell_size = _cell_size;
+
+  // counting sort by cell, stable within each cell
+  int n = (int) x.size();
+  vector< int > cells( n );
+  cell_start.assign( rows * cols + 1, 0 );
+  for ( int i = 0; i < n; ++i ) {
+    cells[ i ] = clamp_row( y[ i ] ) * cols + clamp_col( x[ i ] );
+    cell_start[ cells[ i ] + 1 ]++;
+  }
+  for ( int c = 0; c < rows * cols; ++c ) {
+    cell_start[ c + 1 ] += cell_start[ c ];
+  }
+  vector< int > next( cell_start.begin(), cell_start.end() - 1 );
+  point_x.resize( n );
+  point_y.resize( n );
+  point.resize( n );
+  for ( int i = 0; i < n; ++i ) {
+    int slot = next[ cells[ i ] ]++;
+    point_x[ slot ] = x[ i ];
+    point_y[ slot ] = y[ i ];
+    point[ slot ] = i;
+  }
+}
+
+// the edge cells extend outward, since they hold the points off the grid
+double Spatial_Index::cell_distance_squared( int row, int col, double x, double y ) const {
+  double x1 = min_x + col * cell_size;
+  double y1 = min_y + row * cell_size;
+  double x2 = x1 + cell_size;
+  double y2 = y1 + cell_size;
+  double dx = 0.0;
+  double dy = 0.0;
+  if ( x < x1 && col > 0 ) { dx = x1 - x; }
+  if ( x > x2 && col < cols - 1 ) { dx = x - x2; }
+  if ( y < y1 && row > 0 ) { dy = y1 - y; }
+  if ( y > y2 && row < rows - 1 ) { dy = y - y2; }
+  return dx * dx + dy * dy;
+}
+
+int Spatial_Index::clamp_row( double y ) const {
+  double row = floor( ( y - min_y ) / cell_size );
+  return row < 0 ? 0 : ( row > rows - 1 ? rows - 1 : (int) row );
+}
+
+int Spatial_Index::clamp_col( double x ) const {
+  double col = floor( ( x - min_x ) / cell_size );
+  return col < 0 ? 0 : ( col > cols - 1 ? cols - 1 : (int) col );
+}
+
+void Spatial_Index::get_within_distance( double x, double y, double radius, vector< int > & points ) const {
+  if ( rows == 0 || cols == 0 || radius < 0.0 ) {
+    return;
+  }
+  int r1 = clamp_row( y - radius );
+  int r2 = clamp_row( y + radius );
+  int c1 = clamp_col( x - radius );
+  int c2 = clamp_col( x + radius );
+  double radius_squared = radius * radius;
+  for ( int r = r1; r <= r2; ++r ) {
+    for ( int c = c1; c <= c2; ++c ) {
+      if ( cell_distance_squared( r, c, x, y ) > radius_squared ) {
+        continue;
+      }
+      int cell = r * cols + c;
+      for ( int i = cell_start[ cell ]; i < cell_start[ cell + 1 ]; ++i ) {
+        double dx = point_x[ i ] - x;
+        double dy = point_y[ i ] - y;
+        if ( dx * dx + dy * dy <= radius_squared ) {
+          points.push_back( point[ i ] );
+        }
+      }
+    }
+  }
+}
+
+// Scans rings of cells outward from the cell nearest to (x,y), keeping the
+// best k in a heap.  Every cell of ring L + 1 is at least L cells away, so
+// the scan stops once that is farther than the k-th best point.
+void Spatial_Index::get_nearest( double x, double y, int k, vector< int > & points ) const {
+  points.clear();
+  if ( k <= 0 || point.empty() ) {
+    return;
+  }
+  vector< pair< double, int > > best;
+  best.reserve( k + 1 );
+  int r0 = clamp_row( y );
+  int c0 = clamp_col( x );
+  int max_level = rows > cols ? rows : cols;
+  for ( int level = 0; level <= max_level; ++level ) {
+    for ( int r = r0 - level; r <= r0 + level; ++r ) {
+      if ( r < 0 || r >= rows ) {
+        continue;
+      }
+      bool edge_row = ( r == r0 - level || r == r0 + level );
+      int step = edge_row ? 1 : 2 * level;
+      for ( int c = c0 - level; c <= c0 + level; c += ( step > 0 ? step : 1 ) ) {
+        if ( c < 0 || c >= cols ) {
+          continue;
+        }
+        if ( (int) best.size() == k && cell_distance_squared( r, c, x, y ) > best.front().first ) {
+          continue;
+        }
+        int cell = r * cols + c;
+        for ( int i = cell_start[ cell ]; i < cell_start[ cell + 1 ]; ++i ) {
+          double dx = point_x[ i ] - x;
+          double dy = point_y[ i ] - y;
+          pair< double, int > candidate( dx * dx + dy * dy, point[ i ] );
+          if ( (int) best.size() < k ) {
+            best.push_back( candidate );
+            push_heap( best.begin(), best.end() );
+          }
+          else if ( candidate < best.front() ) {
+            pop_heap( best.begin(), best.end() );
+            best.back() = candidate;
+            push_heap( best.begin(), best.end() );
+          }
+        }
+      }
+    }
+    double reach = level * cell_size;
+    if ( (int) best.size() == k && reach * reach > best.front().first ) {
+      break;
+    }
+  }
+  sort_heap( best.begin(), best.end() );
+  for ( int i = 0; i < (int) best.size(); ++i ) {
+    points.push_back( best[ i ].second );
+  }
+}
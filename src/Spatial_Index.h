@@ -0,0 +1,83 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Spatial_Index.h
+//
+
+#ifndef _FRED_SPATIAL_INDEX_H
+#define _FRED_SPATIAL_INDEX_H
+
+#include <vector>
+
+/*
+ * Index of points in projected (x,y) km coordinates, laid out over the
+ * rows and columns of a grid: the points are sorted by grid cell into flat
+ * coordinate arrays, and cell_start gives the first point of each cell.
+ * The points are named by their position in the vectors passed to build,
+ * and keep that order within each cell.  Points off the grid go to the
+ * nearest edge cell, so the edge cells reach out without bound.
+ *
+ * Queries scan only the cells that can hold an answer, and compare squared
+ * distances against precomputed coordinates.
+ */
+class Spatial_Index {
+
+public:
+
+  Spatial_Index();
+
+  /**
+   * @param rows, cols the size of the grid
+   * @param min_x, min_y the SW corner of the grid
+   * @param cell_size km per side of a grid cell
+   * @param x, y the coordinates of each point
+   */
+  void build( int rows, int cols, double min_x, double min_y, double cell_size,
+      const std::vector< double > & x, const std::vector< double > & y );
+
+  int get_size() const { return (int) point.size(); }
+
+  /**
+   * Appends the points within radius km of (x,y) to points, in order of
+   * their cells (row by row), then in the order they were built.
+   */
+  void get_within_distance( double x, double y, double radius, std::vector< int > & points ) const;
+
+  /**
+   * Sets points to the k points nearest to (x,y), nearest first (ties in
+   * the order they were built), or to all points if there are fewer.
+   */
+  void get_nearest( double x, double y, int k, std::vector< int > & points ) const;
+
+private:
+
+  int rows;
+  int cols;
+  double min_x;
+  double min_y;
+  double cell_size;
+
+  // the points of cell c are cell_start[ c ] .. cell_start[ c + 1 ] - 1
+  std::vector< int > cell_start;
+  std::vector< double > point_x;
+  std::vector< double > point_y;
+  std::vector< int > point;
+
+  // squared distance from (x,y) to the nearest point of a cell
+  double cell_distance_squared( int row, int col, double x, double y ) const;
+
+  int clamp_row( double y ) const;
+  int clamp_col( double x ) const;
+};
+
+#endif // _FRED_SPATIAL_INDEX_H
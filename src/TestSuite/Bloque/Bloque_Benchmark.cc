@@ -0,0 +1,153 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Bloque_Benchmark.cc
+//
+// Measures the cost of a bloque sweep against mask density (0.01% to 100%),
+// in the style of Google Benchmark: each case is repeated until it has run
+// for at least min_time seconds, and the mean time per sweep is reported.
+//
+//   BM_bit_test      test every index with mask_is_set (bit-by-bit baseline)
+//   BM_masked_apply  bloque::masked_apply (count-trailing-zeros extraction)
+//   BM_mask_count    bloque::mask_count (popcount)
+//
+// The visited items are checked against mask_count, so this also serves as a
+// consistency check; exits non-zero on a mismatch.
+//
+// Build with 'make FRED_Bench_Bloque' in the src directory.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "Bloque.h"
+
+using namespace std;
+
+struct Item {
+  int value;
+  Item() : value( 1 ) { }
+};
+
+enum Bench_Masks { Selected };
+
+typedef bloque< Item, Bench_Masks > Item_Bloque;
+
+struct Sum {
+  long sum;
+  Sum() : sum( 0 ) { }
+  void operator() ( Item & item ) { sum += item.value; }
+};
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static const double min_time = 0.2;
+
+// run the case repeatedly for at least min_time; returns ns per sweep
+template < typename Case >
+static double run( Case & c, long * result, int * iterations ) {
+  int n = 0;
+  double start = now();
+  double elapsed = 0.0;
+  do {
+    *result = c();
+    ++n;
+    elapsed = now() - start;
+  } while ( elapsed < min_time );
+  *iterations = n;
+  return 1.0e9 * elapsed / n;
+}
+
+struct Bit_Test_Case {
+  Item_Bloque & blq;
+  size_t number_items;
+  Bit_Test_Case( Item_Bloque & b, size_t n ) : blq( b ), number_items( n ) { }
+  long operator() () {
+    long sum = 0;
+    for ( size_t i = 0; i < number_items; ++i ) {
+      if ( blq.mask_is_set( Selected, i ) ) { sum += blq[ i ].value; }
+    }
+    return sum;
+  }
+};
+
+struct Masked_Apply_Case {
+  Item_Bloque & blq;
+  Masked_Apply_Case( Item_Bloque & b ) : blq( b ) { }
+  long operator() () {
+    Sum sum;
+    blq.masked_apply( Selected, sum );
+    return sum.sum;
+  }
+};
+
+struct Mask_Count_Case {
+  Item_Bloque & blq;
+  Mask_Count_Case( Item_Bloque & b ) : blq( b ) { }
+  long operator() () { return blq.mask_count( Selected ); }
+};
+
+int main( int argc, char * argv[] ) {
+  size_t number_items = 1000000;
+  double densities[] = { 0.0001, 0.001, 0.01, 0.1, 0.5, 1.0 };
+  int number_densities = sizeof( densities ) / sizeof( double );
+  int errors = 0;
+
+  printf( "%d items\n", (int) number_items );
+  printf( "%-36s %14s %12s %10s\n", "Benchmark", "Time (ns)", "Iterations", "Items" );
+  printf( "--------------------------------------------------------------------------------\n" );
+  for ( int d = 0; d < number_densities; ++d ) {
+    Item_Bloque blq;
+    blq.add_mask( Selected );
+    for ( size_t i = 0; i < number_items; ++i ) {
+      int index = blq.get_free_index();
+      blq.mark_valid_by_index( index );
+    }
+    srand( 12345 );
+    for ( size_t i = 0; i < number_items; ++i ) {
+      if ( rand() < densities[ d ] * ( (double) RAND_MAX + 1.0 ) ) {
+        blq.set_mask_by_index( Selected, i );
+      }
+    }
+
+    long expected = blq.mask_count( Selected );
+    long result = 0;
+    int iterations = 0;
+    char name[ 64 ];
+
+    Bit_Test_Case bit_test( blq, number_items );
+    double t = run( bit_test, &result, &iterations );
+    sprintf( name, "BM_bit_test/density:%g%%", 100.0 * densities[ d ] );
+    printf( "%-36s %14.0f %12d %10ld\n", name, t, iterations, result );
+    if ( result != expected ) { ++errors; }
+
+    Masked_Apply_Case masked_apply( blq );
+    t = run( masked_apply, &result, &iterations );
+    sprintf( name, "BM_masked_apply/density:%g%%", 100.0 * densities[ d ] );
+    printf( "%-36s %14.0f %12d %10ld\n", name, t, iterations, result );
+    if ( result != expected ) { ++errors; }
+
+    Mask_Count_Case mask_count( blq );
+    t = run( mask_count, &result, &iterations );
+    sprintf( name, "BM_mask_count/density:%g%%", 100.0 * densities[ d ] );
+    printf( "%-36s %14.0f %12d %10ld\n", name, t, iterations, result );
+  }
+  if ( errors > 0 ) {
+    printf( "ERROR: %d sweeps disagree with mask_count\n", errors );
+  }
+  return errors;
+}
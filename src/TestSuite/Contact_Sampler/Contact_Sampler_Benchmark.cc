@@ -0,0 +1,152 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Contact_Sampler_Benchmark.cc
+//
+// Times the contact sampling step of Place::spread_infection on synthetic
+// places of 10 to 10,000 visitors, comparing the original per-infector
+// std::map tally with Contact_Sampler.  Both are driven from the same seed
+// and must visit identical (position, times drawn) sequences.
+//
+// Build with 'make FRED_Bench_Contact_Sampler' in the src directory.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+#include <sys/time.h>
+
+#include "Global.h"
+#include "Random.h"
+#include "Contact_Sampler.h"
+
+using namespace std;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+// a synthetic place: susceptible visitor ids, and infectors (some of whom
+// are also in the susceptible list, to exercise the self-contact redraw)
+struct Synthetic_Place {
+  vector< int > susceptibles;
+  vector< int > infectious;
+  int number_targets;
+
+  Synthetic_Place( int size ) {
+    number_targets = size;
+    int number_susceptibles = ( 9 * size ) / 10;
+    int number_infectious = size / 20 + 1;
+    for ( int i = 0; i < number_susceptibles; ++i ) {
+      susceptibles.push_back( i );
+    }
+    for ( int i = 0; i < number_infectious; ++i ) {
+      infectious.push_back( ( i % 2 == 0 ) ? i : size + i );
+    }
+  }
+};
+
+// the contact count drawn per infector (contact rate scaled by place size,
+// as for neighborhoods and workplaces)
+static int contact_count( int size ) {
+  double expected = 0.5 * size;
+  int count = (int) expected;
+  if ( RANDOM() < expected - count ) { ++count; }
+  return count;
+}
+
+// original tally; returns a checksum of the visited (position, times drawn) pairs
+static long map_tally( Synthetic_Place & place ) {
+  long checksum = 0;
+  int number_susceptibles = place.susceptibles.size();
+  for ( int k = 0; k < place.infectious.size(); ++k ) {
+    int infector = place.infectious[ k ];
+    int count = contact_count( place.number_targets );
+    std::map< int, int > sampling_map;
+    for ( int c = 0; c < count; ++c ) {
+      int pos = IRAND( 0, place.number_targets - 1 );
+      if ( pos < number_susceptibles ) {
+        if ( infector == place.susceptibles[ pos ] ) {
+          if ( number_susceptibles > 1 ) {
+            --( c );
+            continue;
+          }
+          else {
+            break;
+          }
+        }
+        sampling_map[ pos ]++;
+      }
+    }
+    std::map< int, int >::iterator i;
+    for ( i = sampling_map.begin(); i != sampling_map.end(); ++i ) {
+      checksum = checksum * 31 + ( *i ).first * 7 + ( *i ).second;
+    }
+  }
+  return checksum;
+}
+
+static long sampler_tally( Synthetic_Place & place, Contact_Sampler & sampler ) {
+  long checksum = 0;
+  int number_susceptibles = place.susceptibles.size();
+  for ( int k = 0; k < place.infectious.size(); ++k ) {
+    int infector = place.infectious[ k ];
+    int count = contact_count( place.number_targets );
+    sampler.sample( count, place.number_targets, &( place.susceptibles[ 0 ] ),
+        number_susceptibles, infector );
+    for ( int i = 0; i < sampler.size(); ++i ) {
+      checksum = checksum * 31 + sampler.get_position( i ) * 7 + sampler.get_times_drawn( i );
+    }
+  }
+  return checksum;
+}
+
+int main( int argc, char * argv[] ) {
+  int sizes[] = { 10, 30, 100, 300, 1000, 3000, 10000 };
+  int number_sizes = sizeof( sizes ) / sizeof( int );
+  int seed = 123456;
+  int errors = 0;
+  Contact_Sampler sampler;
+
+  printf( "%8s %8s %14s %14s %8s\n", "size", "reps", "map (us/day)", "flat (us/day)", "speedup" );
+  for ( int s = 0; s < number_sizes; ++s ) {
+    Synthetic_Place place( sizes[ s ] );
+    int reps = 2000000 / ( sizes[ s ] * place.infectious.size() ) + 1;
+
+    INIT_RANDOM( seed );
+    long map_checksum = 0;
+    double start = now();
+    for ( int r = 0; r < reps; ++r ) {
+      map_checksum += map_tally( place );
+    }
+    double map_time = now() - start;
+
+    INIT_RANDOM( seed );
+    long sampler_checksum = 0;
+    start = now();
+    for ( int r = 0; r < reps; ++r ) {
+      sampler_checksum += sampler_tally( place, sampler );
+    }
+    double sampler_time = now() - start;
+
+    printf( "%8d %8d %14.2f %14.2f %7.2fx\n", sizes[ s ], reps,
+        1.0e6 * map_time / reps, 1.0e6 * sampler_time / reps, map_time / sampler_time );
+    if ( map_checksum != sampler_checksum ) {
+      printf( "ERROR: contact sequences differ for place size %d\n", sizes[ s ] );
+      ++errors;
+    }
+  }
+  return errors;
+}
@@ -0,0 +1,192 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: RNG_Batch_Benchmark.cc
+//
+// Times the batch draws of Random.h (draw_*_batch, Alias_Table) against
+// calls of the scalar functions in a loop, in ns per variate.
+//
+// The uniform, exponential, normal and cdf batches must give exactly the
+// values of the scalar loop from the same seed.  The Poisson, binomial and
+// alias table batches draw from a table instead, so only their sample means
+// are checked against the scalar loop (within 6 standard errors).  Exits
+// non-zero if any check fails.
+//
+// Build with 'make FRED_Bench_RNG_Batch' in the src directory.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <sys/time.h>
+
+#include "Global.h"
+#include "Random.h"
+
+using namespace std;
+
+static const int N = 1000000;
+static const int seed = 123456;
+static int errors = 0;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static void report( const char * name, double scalar_time, double batch_time, const char * check, bool ok ) {
+  printf( "%-32s %10.2f %10.2f %7.2fx   %s %s\n", name, 1.0e9 * scalar_time / N,
+      1.0e9 * batch_time / N, scalar_time / batch_time, check, ok ? "ok" : "FAILED" );
+  if ( !ok ) { ++errors; }
+}
+
+template < typename T >
+static bool same( const vector< T > & a, const vector< T > & b ) {
+  for ( int i = 0; i < N; ++i ) {
+    if ( a[ i ] != b[ i ] ) { return false; }
+  }
+  return true;
+}
+
+template < typename T >
+static void mean_and_variance( const vector< T > & a, double * mean, double * variance ) {
+  double sum = 0.0;
+  double sum_sq = 0.0;
+  for ( int i = 0; i < N; ++i ) {
+    sum += a[ i ];
+    sum_sq += (double) a[ i ] * a[ i ];
+  }
+  *mean = sum / N;
+  *variance = sum_sq / N - *mean * *mean;
+}
+
+// the batch and scalar sample means agree within 6 standard errors
+template < typename T >
+static bool close_means( const vector< T > & scalar, const vector< T > & batch ) {
+  double m1, v1, m2, v2;
+  mean_and_variance( scalar, &m1, &v1 );
+  mean_and_variance( batch, &m2, &v2 );
+  return fabs( m1 - m2 ) <= 6.0 * sqrt( ( v1 + v2 ) / N ) + 1.0e-12;
+}
+
+int main( int argc, char * argv[] ) {
+  vector< double > scalar( N );
+  vector< double > batch( N );
+  vector< int > scalar_int( N );
+  vector< int > batch_int( N );
+  double start, scalar_time, batch_time;
+  char name[ 64 ];
+
+  printf( "%d variates per case\n", N );
+  printf( "%-32s %10s %10s %8s\n", "Distribution", "scalar ns", "batch ns", "speedup" );
+  printf( "--------------------------------------------------------------------------------\n" );
+
+  INIT_RANDOM( seed );
+  start = now();
+  for ( int i = 0; i < N; ++i ) { scalar[ i ] = RANDOM(); }
+  scalar_time = now() - start;
+  INIT_RANDOM( seed );
+  start = now();
+  draw_uniform_batch( &batch[ 0 ], N );
+  batch_time = now() - start;
+  report( "uniform", scalar_time, batch_time, "identical", same( scalar, batch ) );
+
+  INIT_RANDOM( seed );
+  start = now();
+  for ( int i = 0; i < N; ++i ) { scalar[ i ] = draw_exponential( 0.25 ); }
+  scalar_time = now() - start;
+  INIT_RANDOM( seed );
+  start = now();
+  draw_exponential_batch( 0.25, &batch[ 0 ], N );
+  batch_time = now() - start;
+  report( "exponential(0.25)", scalar_time, batch_time, "identical", same( scalar, batch ) );
+
+  INIT_RANDOM( seed );
+  start = now();
+  for ( int i = 0; i < N; ++i ) { scalar[ i ] = draw_normal( 280.0, 7.0 ); }
+  scalar_time = now() - start;
+  INIT_RANDOM( seed );
+  start = now();
+  draw_normal_batch( 280.0, 7.0, &batch[ 0 ], N );
+  batch_time = now() - start;
+  report( "normal(280,7)", scalar_time, batch_time, "identical", same( scalar, batch ) );
+
+  int cdf_sizes[] = { 8, 64, 1024 };
+  for ( int c = 0; c < 3; ++c ) {
+    int size = cdf_sizes[ c ];
+    vector< double > cdf( size );
+    double total = 0.0;
+    for ( int i = 0; i < size; ++i ) { total += 1.0 + ( i % 5 ); }
+    double sum = 0.0;
+    for ( int i = 0; i < size; ++i ) {
+      sum += 1.0 + ( i % 5 );
+      cdf[ i ] = sum / total;
+    }
+    cdf[ size - 1 ] = 1.0;
+
+    INIT_RANDOM( seed );
+    start = now();
+    for ( int i = 0; i < N; ++i ) { scalar_int[ i ] = draw_from_cdf( &cdf[ 0 ], size ); }
+    scalar_time = now() - start;
+    INIT_RANDOM( seed );
+    start = now();
+    draw_from_cdf_batch( &cdf[ 0 ], size, &batch_int[ 0 ], N );
+    batch_time = now() - start;
+    sprintf( name, "cdf(%d)", size );
+    report( name, scalar_time, batch_time, "identical", same( scalar_int, batch_int ) );
+
+    Alias_Table table;
+    table.build_from_cdf( &cdf[ 0 ], size );
+    INIT_RANDOM( seed + 1 );
+    start = now();
+    table.draw_batch( &batch_int[ 0 ], N );
+    batch_time = now() - start;
+    sprintf( name, "cdf(%d) alias table", size );
+    report( name, scalar_time, batch_time, "mean", close_means( scalar_int, batch_int ) );
+  }
+
+  double lambdas[] = { 0.5, 5.0, 50.0 };
+  for ( int l = 0; l < 3; ++l ) {
+    INIT_RANDOM( seed );
+    start = now();
+    for ( int i = 0; i < N; ++i ) { scalar_int[ i ] = draw_poisson( lambdas[ l ] ); }
+    scalar_time = now() - start;
+    INIT_RANDOM( seed + 1 );
+    start = now();
+    draw_poisson_batch( lambdas[ l ], &batch_int[ 0 ], N );
+    batch_time = now() - start;
+    sprintf( name, "poisson(%g)", lambdas[ l ] );
+    report( name, scalar_time, batch_time, "mean", close_means( scalar_int, batch_int ) );
+  }
+
+  int trials[] = { 10, 100, 1000 };
+  double probs[] = { 0.3, 0.02, 0.5 };
+  for ( int b = 0; b < 3; ++b ) {
+    INIT_RANDOM( seed );
+    start = now();
+    for ( int i = 0; i < N; ++i ) { scalar_int[ i ] = draw_binomial( trials[ b ], probs[ b ] ); }
+    scalar_time = now() - start;
+    INIT_RANDOM( seed + 1 );
+    start = now();
+    draw_binomial_batch( trials[ b ], probs[ b ], &batch_int[ 0 ], N );
+    batch_time = now() - start;
+    sprintf( name, "binomial(%d,%g)", trials[ b ], probs[ b ] );
+    report( name, scalar_time, batch_time, "mean", close_means( scalar_int, batch_int ) );
+  }
+
+  if ( errors > 0 ) {
+    printf( "ERROR: %d checks failed\n", errors );
+  }
+  return errors;
+}
@@ -0,0 +1,206 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: RNG_Stats_Test.cc
+//
+// Statistical tests of the small-integer streams of Random.h, for the
+// per-thread dSFMT states and for the counter streams:
+//
+//  1. random_char: byte frequencies, and frequencies of adjacent byte pairs
+//     (which caught bytes repeated within a word).
+//  2. IRAND_0_7: frequencies, and of adjacent pairs.
+//  3. IRAND: frequencies over ranges from 2 to 65537, and over the thirds of
+//     a range of 3 * 2^29, where reducing by modulo shows.
+//  4. random_uint32: the balance of each bit.
+//
+// Frequency tests are chi-square tests at the 99.9th percentile.  Also
+// reports the time per IRAND against the floating-point form it replaced.
+//
+// Build with 'make FRED_Test_RNG_Stats' in the src directory; exits non-zero
+// on failure.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <sys/time.h>
+
+#include "Global.h"
+#include "Random.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static void check( bool ok, const char * what ) {
+  printf( "%s: %s\n", ok ? "PASS" : "FAIL", what );
+  if ( !ok ) { ++failures; }
+}
+
+// chi-square test of counts against equal expected frequencies
+static void check_uniform( const vector< long > & observed, long samples, const char * name ) {
+  int cells = observed.size();
+  double expected = (double) samples / cells;
+  double chi2 = 0.0;
+  for ( int i = 0; i < cells; ++i ) {
+    chi2 += ( observed[ i ] - expected ) * ( observed[ i ] - expected ) / expected;
+  }
+  int dof = cells - 1;
+  // Wilson-Hilferty approximation to the 99.9th percentile
+  double z = 3.09;
+  double limit = dof * pow( 1.0 - 2.0 / ( 9.0 * dof ) + z * sqrt( 2.0 / ( 9.0 * dof ) ), 3 );
+  char what[ 256 ];
+  sprintf( what, "%s: chi2 = %.1f, dof = %d, limit = %.1f", name, chi2, dof, limit );
+  check( chi2 < limit, what );
+}
+
+static void test_chars( const char * mode ) {
+  char name[ 128 ];
+  long samples = 20000000;
+  vector< long > single( 256, 0 );
+  vector< long > pairs( 65536, 0 );
+  int previous = RNG::random_char();
+  for ( long s = 0; s < samples; ++s ) {
+    int c = RNG::random_char();
+    single[ c ]++;
+    pairs[ previous * 256 + c ]++;
+    previous = c;
+  }
+  sprintf( name, "%s random_char frequencies", mode );
+  check_uniform( single, samples, name );
+  sprintf( name, "%s random_char pairs", mode );
+  check_uniform( pairs, samples, name );
+}
+
+static void test_irand_0_7( const char * mode ) {
+  char name[ 128 ];
+  long samples = 4000000;
+  vector< long > single( 8, 0 );
+  vector< long > pairs( 64, 0 );
+  int previous = IRAND_0_7();
+  for ( long s = 0; s < samples; ++s ) {
+    int n = IRAND_0_7();
+    single[ n ]++;
+    pairs[ previous * 8 + n ]++;
+    previous = n;
+  }
+  sprintf( name, "%s IRAND_0_7 frequencies", mode );
+  check_uniform( single, samples, name );
+  sprintf( name, "%s IRAND_0_7 pairs", mode );
+  check_uniform( pairs, samples, name );
+}
+
+static void test_irand( const char * mode ) {
+  char name[ 128 ];
+  int ranges[] = { 2, 3, 7, 10, 100, 1000, 65537 };
+  for ( int r = 0; r < (int) ( sizeof( ranges ) / sizeof( int ) ); ++r ) {
+    int range = ranges[ r ];
+    long samples = 100L * range > 4000000 ? 100L * range : 4000000;
+    vector< long > observed( range, 0 );
+    bool in_range = true;
+    for ( long s = 0; s < samples; ++s ) {
+      int n = IRAND( 5, 5 + range - 1 ) - 5;
+      if ( n < 0 || n >= range ) { in_range = false; break; }
+      observed[ n ]++;
+    }
+    sprintf( name, "%s IRAND over %d values in range", mode, range );
+    check( in_range, name );
+    sprintf( name, "%s IRAND over %d values", mode, range );
+    check_uniform( observed, samples, name );
+  }
+
+  // for a range of 3 * 2^29, reducing a 32-bit draw modulo the range would
+  // give each of the lower two thirds of the range 3/8 of the draws, and the
+  // top third 1/4
+  int range = 3 << 29;
+  long samples = 6000000;
+  vector< long > thirds( 3, 0 );
+  for ( long s = 0; s < samples; ++s ) {
+    int n = IRAND( 0, range - 1 );
+    thirds[ n / ( 1 << 29 ) ]++;
+  }
+  sprintf( name, "%s IRAND over %d values, thirds", mode, range );
+  check_uniform( thirds, samples, name );
+
+  check( IRAND( 3, 3 ) == 3, "IRAND( 3, 3 ) == 3" );
+}
+
+static void test_bits( const char * mode ) {
+  long samples = 4000000;
+  vector< long > ones( 32, 0 );
+  for ( long s = 0; s < samples; ++s ) {
+    uint32_t x = RNG::random_uint32();
+    for ( int b = 0; b < 32; ++b ) {
+      ones[ b ] += ( x >> b ) & 1;
+    }
+  }
+  double worst = 0.0;
+  for ( int b = 0; b < 32; ++b ) {
+    double z = fabs( ones[ b ] - 0.5 * samples ) / sqrt( 0.25 * samples );
+    if ( z > worst ) { worst = z; }
+  }
+  char what[ 128 ];
+  // 32 bits, each within 4 standard deviations
+  sprintf( what, "%s random_uint32 bit balance: worst |z| = %.2f", mode, worst );
+  check( worst < 4.0, what );
+}
+
+static void time_irand() {
+  int draws = 50000000;
+  int range = 1000;
+  INIT_RANDOM( 1 );
+  long sum = 0;
+  double start = now();
+  for ( int i = 0; i < draws; ++i ) {
+    sum += (int) ( range * RNG::random_double() );
+  }
+  double float_time = now() - start;
+  INIT_RANDOM( 1 );
+  start = now();
+  for ( int i = 0; i < draws; ++i ) {
+    sum += IRAND( 0, range - 1 );
+  }
+  double irand_time = now() - start;
+  printf( "IRAND( 0, %d ): %.2f ns (floating point: %.2f ns)  [%ld]\n", range - 1,
+      1.0e9 * irand_time / draws, 1.0e9 * float_time / draws, sum % 10 );
+}
+
+int main( int argc, char * argv[] ) {
+  RNG::use_counter_streams( false );
+  INIT_RANDOM( 20120815 );
+  test_chars( "dSFMT" );
+  test_irand_0_7( "dSFMT" );
+  test_irand( "dSFMT" );
+  test_bits( "dSFMT" );
+
+  RNG::use_counter_streams( true );
+  INIT_RANDOM( 20120815 );
+  test_chars( "counter" );
+  test_irand_0_7( "counter" );
+  test_irand( "counter" );
+  test_bits( "counter" );
+  RNG::use_counter_streams( false );
+
+  time_irand();
+
+  if ( failures > 0 ) {
+    printf( "%d tests failed\n", failures );
+  }
+  return failures;
+}
@@ -0,0 +1,219 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Skip_Ahead_Test.cc
+//
+// Statistical equivalence test for skip-ahead transmission.
+//
+//  1. draw_binomial is checked against the exact distribution given by
+//     build_binomial_cdf (chi-square goodness of fit).
+//  2. A synthetic place with two contact groups and mixed susceptibility is
+//     run many times with the per-contact loop of Place::spread_infection
+//     (Contact_Sampler::sample) and with Contact_Sampler::sample_skip_ahead.
+//     Infections per group must agree in mean and variance.
+//
+// Build with 'make FRED_Test_Skip_Ahead' in the src directory; exits non-zero
+// on failure.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <sys/time.h>
+
+#include "Global.h"
+#include "Random.h"
+#include "Contact_Sampler.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static void check( bool ok, const char * what ) {
+  printf( "%s: %s\n", ok ? "PASS" : "FAIL", what );
+  if ( !ok ) { ++failures; }
+}
+
+///////////////////////// draw_binomial
+
+// chi-square statistic of draw_binomial( n, p ) against build_binomial_cdf;
+// cells with small expected counts are pooled into their neighbour
+static void test_draw_binomial( int n, double p, int samples ) {
+  vector< double > cdf;
+  build_binomial_cdf( p, n, cdf );
+  vector< int > observed( n + 1, 0 );
+  for ( int s = 0; s < samples; ++s ) {
+    observed[ draw_binomial( n, p ) ]++;
+  }
+  double chi2 = 0.0;
+  int dof = -1;
+  double expected = 0.0;
+  int count = 0;
+  for ( int k = 0; k <= n; ++k ) {
+    double pk = ( k < cdf.size() ? cdf[ k ] : 1.0 ) - ( k > 0 && k - 1 < cdf.size() ? cdf[ k - 1 ] : 0.0 );
+    expected += pk * samples;
+    count += observed[ k ];
+    if ( expected >= 20.0 || k == n ) {
+      if ( expected > 0.0 ) {
+        chi2 += ( count - expected ) * ( count - expected ) / expected;
+        ++dof;
+      }
+      expected = 0.0;
+      count = 0;
+    }
+  }
+  // Wilson-Hilferty approximation to the 99.9th percentile
+  double z = 3.09;
+  double limit = dof * pow( 1.0 - 2.0 / ( 9.0 * dof ) + z * sqrt( 2.0 / ( 9.0 * dof ) ), 3 );
+  char what[ 256 ];
+  sprintf( what, "draw_binomial( %d, %g ): chi2 = %.1f, dof = %d, limit = %.1f", n, p, chi2, dof, limit );
+  check( dof > 0 && chi2 < limit, what );
+}
+
+///////////////////////// synthetic place
+
+struct Synthetic_Place {
+  int number_targets;
+  vector< int > susceptibles;        // ids
+  vector< int > group;               // contact group of each id
+  vector< double > susceptibility;   // of each id
+  double contact_prob[ 2 ][ 2 ];     // per group pair
+  vector< char > infected;
+
+  Synthetic_Place( int size ) {
+    number_targets = size;
+    int number_susceptibles = size / 2;
+    for ( int i = 0; i < number_susceptibles; ++i ) {
+      susceptibles.push_back( i );
+      group.push_back( i % 3 == 0 ? 0 : 1 );
+      susceptibility.push_back( i % 4 == 0 ? 0.3 : 1.0 );
+    }
+    contact_prob[ 0 ][ 0 ] = 0.06;
+    contact_prob[ 0 ][ 1 ] = 0.02;
+    contact_prob[ 1 ][ 0 ] = 0.03;
+    contact_prob[ 1 ][ 1 ] = 0.04;
+  }
+
+  double transmission_prob( int infector_group, int id ) {
+    return contact_prob[ infector_group ][ group[ id ] ];
+  }
+
+  // as Place::attempt_transmission
+  void attempt_transmission( double transmission_prob, int id ) {
+    if ( RANDOM() < transmission_prob * susceptibility[ id ] ) {
+      infected[ id ] = 1;
+    }
+  }
+
+  // one day of Place::spread_infection; returns the number of new infections
+  // in each group
+  void spread_infection( bool skip_ahead, vector< int > & infector_groups,
+      double contact_rate, Contact_Sampler & sampler, int * infections ) {
+    int number_susceptibles = susceptibles.size();
+    infected.assign( number_susceptibles, 0 );
+    for ( int k = 0; k < infector_groups.size(); ++k ) {
+      int row = infector_groups[ k ];
+      int contact_count = (int) contact_rate;
+      if ( RANDOM() < contact_rate - contact_count ) { ++contact_count; }
+      double max_prob = 1.0;
+      if ( skip_ahead ) {
+        max_prob = 0.0;
+        for ( int col = 0; col < 2; ++col ) {
+          if ( contact_prob[ row ][ col ] > max_prob ) { max_prob = contact_prob[ row ][ col ]; }
+        }
+        sampler.sample_skip_ahead( contact_count, number_targets, number_susceptibles, max_prob );
+      }
+      else {
+        sampler.sample( contact_count, number_targets, &( susceptibles[ 0 ] ), number_susceptibles, -1 );
+      }
+      for ( int i = 0; i < sampler.size(); ++i ) {
+        int id = susceptibles[ sampler.get_position( i ) ];
+        double prob = transmission_prob( row, id ) / max_prob;
+        for ( int draw = 0; draw < sampler.get_times_drawn( i ); ++draw ) {
+          if ( !infected[ id ] ) {
+            attempt_transmission( prob, id );
+          }
+        }
+      }
+    }
+    infections[ 0 ] = infections[ 1 ] = 0;
+    for ( int i = 0; i < number_susceptibles; ++i ) {
+      infections[ group[ i ] ] += infected[ i ];
+    }
+  }
+};
+
+struct Moments {
+  double n, sum, sum_sq;
+  Moments() : n( 0 ), sum( 0 ), sum_sq( 0 ) { }
+  void add( double x ) { n += 1; sum += x; sum_sq += x * x; }
+  double mean() { return sum / n; }
+  double variance() { return ( sum_sq - sum * sum / n ) / ( n - 1 ); }
+};
+
+static void test_equivalence( int size, int number_infectious, double contact_rate, int trials ) {
+  Synthetic_Place place( size );
+  Contact_Sampler sampler;
+  vector< int > infector_groups;
+  for ( int k = 0; k < number_infectious; ++k ) {
+    infector_groups.push_back( k % 2 );
+  }
+  Moments per_contact[ 2 ], skip_ahead[ 2 ];
+  int infections[ 2 ];
+  double time[ 2 ];
+  for ( int method = 0; method < 2; ++method ) {
+    double start = now();
+    for ( int t = 0; t < trials; ++t ) {
+      place.spread_infection( method == 1, infector_groups, contact_rate, sampler, infections );
+      for ( int g = 0; g < 2; ++g ) {
+        ( method == 1 ? skip_ahead : per_contact )[ g ].add( infections[ g ] );
+      }
+    }
+    time[ method ] = now() - start;
+  }
+  for ( int g = 0; g < 2; ++g ) {
+    double se = sqrt( per_contact[ g ].variance() / trials + skip_ahead[ g ].variance() / trials );
+    double z_mean = ( skip_ahead[ g ].mean() - per_contact[ g ].mean() ) / se;
+    // variance ratio; its log is roughly normal with sd sqrt( 2 / ( n - 1 ) + 2 / ( n - 1 ) )
+    double z_var = log( skip_ahead[ g ].variance() / per_contact[ g ].variance() ) / sqrt( 4.0 / ( trials - 1 ) );
+    char what[ 256 ];
+    sprintf( what, "size %d, group %d: mean %.2f vs %.2f (z = %.2f), variance %.2f vs %.2f (z = %.2f)",
+        size, g, per_contact[ g ].mean(), skip_ahead[ g ].mean(), z_mean,
+        per_contact[ g ].variance(), skip_ahead[ g ].variance(), z_var );
+    check( fabs( z_mean ) < 4.0 && fabs( z_var ) < 4.0, what );
+  }
+  printf( "      per-contact %.1f us/day, skip-ahead %.1f us/day\n",
+      1.0e6 * time[ 0 ] / trials, 1.0e6 * time[ 1 ] / trials );
+}
+
+int main( int argc, char * argv[] ) {
+  INIT_RANDOM( 20120815 );
+
+  test_draw_binomial( 10, 0.3, 100000 );
+  test_draw_binomial( 100, 0.02, 100000 );
+  test_draw_binomial( 1000, 0.005, 100000 );
+  test_draw_binomial( 50, 0.8, 100000 );
+
+  test_equivalence( 100, 10, 20.0, 20000 );
+  test_equivalence( 1000, 100, 40.0, 4000 );
+  test_equivalence( 10000, 500, 40.0, 2000 );
+
+  printf( "%d failures\n", failures );
+  return failures;
+}
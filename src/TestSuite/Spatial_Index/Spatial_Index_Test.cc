@@ -0,0 +1,165 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Spatial_Index_Test.cc
+//
+// Checks the radius and k-nearest queries of Spatial_Index against a scan
+// of all points, on clustered points over a 60 x 80 grid of 1 km cells,
+// with some points and query centers off the grid.  Reports the time per
+// query of both.
+//
+// Build with 'make FRED_Test_Spatial_Index' in the src directory; exits
+// non-zero on failure.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <sys/time.h>
+
+#include "Global.h"
+#include "Random.h"
+#include "Spatial_Index.h"
+
+using namespace std;
+
+static const int rows = 60;
+static const int cols = 80;
+static const double min_x = 1000.0;
+static const double min_y = 2000.0;
+static const double cell_size = 1.0;
+
+static vector< double > x;
+static vector< double > y;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static void scan_within_distance( double px, double py, double radius, vector< int > & points ) {
+  for ( int i = 0; i < (int) x.size(); ++i ) {
+    double dx = x[ i ] - px;
+    double dy = y[ i ] - py;
+    if ( dx * dx + dy * dy <= radius * radius ) {
+      points.push_back( i );
+    }
+  }
+}
+
+static void scan_nearest( double px, double py, int k, vector< int > & points ) {
+  vector< pair< double, int > > all( x.size() );
+  for ( int i = 0; i < (int) x.size(); ++i ) {
+    double dx = x[ i ] - px;
+    double dy = y[ i ] - py;
+    all[ i ] = pair< double, int >( dx * dx + dy * dy, i );
+  }
+  int n = k < (int) all.size() ? k : (int) all.size();
+  partial_sort( all.begin(), all.begin() + n, all.end() );
+  points.clear();
+  for ( int i = 0; i < n; ++i ) {
+    points.push_back( all[ i ].second );
+  }
+}
+
+int main( int argc, char * argv[] ) {
+  INIT_RANDOM( 4242 );
+  int failures = 0;
+
+  // households in towns, with a few off the grid
+  int towns = 40;
+  for ( int t = 0; t < towns; ++t ) {
+    double cx = min_x + URAND( 0, cols * cell_size );
+    double cy = min_y + URAND( 0, rows * cell_size );
+    double spread = URAND( 0.5, 5.0 );
+    int houses = IRAND( 200, 5000 );
+    for ( int h = 0; h < houses; ++h ) {
+      x.push_back( cx + spread * draw_standard_normal() );
+      y.push_back( cy + spread * draw_standard_normal() );
+    }
+  }
+  printf( "%d points\n", (int) x.size() );
+
+  Spatial_Index index;
+  index.build( rows, cols, min_x, min_y, cell_size, x, y );
+  if ( index.get_size() != (int) x.size() ) {
+    printf( "FAIL: index holds %d points\n", index.get_size() );
+    ++failures;
+  }
+
+  int queries = 500;
+  vector< double > qx( queries );
+  vector< double > qy( queries );
+  vector< double > qr( queries );
+  vector< int > qk( queries );
+  for ( int q = 0; q < queries; ++q ) {
+    qx[ q ] = min_x + URAND( -5, cols * cell_size + 5 );
+    qy[ q ] = min_y + URAND( -5, rows * cell_size + 5 );
+    qr[ q ] = URAND( 0, 15 );
+    qk[ q ] = IRAND( 1, 200 );
+  }
+
+  // the index gives the points in cell order, so compare as sets
+  double index_time = 0.0;
+  double scan_time = 0.0;
+  int radius_failures = 0;
+  vector< int > found;
+  vector< int > expected;
+  for ( int q = 0; q < queries; ++q ) {
+    found.clear();
+    expected.clear();
+    double start = now();
+    index.get_within_distance( qx[ q ], qy[ q ], qr[ q ], found );
+    index_time += now() - start;
+    start = now();
+    scan_within_distance( qx[ q ], qy[ q ], qr[ q ], expected );
+    scan_time += now() - start;
+    sort( found.begin(), found.end() );
+    if ( found != expected ) { ++radius_failures; }
+  }
+  printf( "%s: radius queries (%d of %d differ); index %.1f us, scan %.1f us\n",
+      radius_failures ? "FAIL" : "PASS", radius_failures, queries,
+      1.0e6 * index_time / queries, 1.0e6 * scan_time / queries );
+  failures += radius_failures;
+
+  index_time = 0.0;
+  scan_time = 0.0;
+  int nearest_failures = 0;
+  for ( int q = 0; q < queries; ++q ) {
+    double start = now();
+    index.get_nearest( qx[ q ], qy[ q ], qk[ q ], found );
+    index_time += now() - start;
+    start = now();
+    scan_nearest( qx[ q ], qy[ q ], qk[ q ], expected );
+    scan_time += now() - start;
+    if ( found != expected ) { ++nearest_failures; }
+  }
+  printf( "%s: k-nearest queries (%d of %d differ); index %.1f us, scan %.1f us\n",
+      nearest_failures ? "FAIL" : "PASS", nearest_failures, queries,
+      1.0e6 * index_time / queries, 1.0e6 * scan_time / queries );
+  failures += nearest_failures;
+
+  index.get_nearest( min_x, min_y, (int) x.size() + 10, found );
+  if ( found.size() != x.size() ) {
+    printf( "FAIL: k-nearest for k past the size gives %d points\n", (int) found.size() );
+    ++failures;
+  }
+
+  if ( failures > 0 ) {
+    printf( "%d tests failed\n", failures );
+  }
+  return failures;
+}
@@ -0,0 +1,172 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Vaccine_Queue_Test.cc
+//
+// Unit test of Vaccine_Queue, walked by position the way
+// Vaccine_Manager::vaccinate_queue does while people are taken out with
+// remove_at(), with empty slots left in the queue by remove():
+//
+//  1. a hole behind the front, and the front taken out during the walk;
+//  2. holes in the middle, and people taken out at the front, in the middle
+//     and at the back during the walk;
+//  3. positions below zero (push_front), and everyone taken out.
+//
+// The queue's slots are read through the inline Vaccine_Queue::get, which
+// is compiled here with _GLIBCXX_ASSERTIONS, so a position outside the queue
+// aborts.
+//
+// Build with 'make FRED_Test_Vaccine_Queue' in the src directory; exits
+// non-zero on failure.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Global.h"
+#include "Random.h"
+#include "Person.h"
+#include "Vaccine_Queue.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static void check( bool ok, const char * what ) {
+  printf( "%s: %s\n", ok ? "PASS" : "FAIL", what );
+  if ( !ok ) { ++failures; }
+}
+
+static const int N = 16;
+static Person people[ N ];
+static vector< int > positions;
+
+typedef vector< int > ints;
+
+// the population indices of the people in the queue, in order
+static vector< int > contents( const Vaccine_Queue & q ) {
+  vector< int > result;
+  for ( int pos = q.begin(); pos < q.end(); ++pos ) {
+    if ( q.get( pos ) != NULL ) {
+      result.push_back( q.get( pos )->get_pop_index() );
+    }
+  }
+  return result;
+}
+
+// walks the queue as Vaccine_Manager::vaccinate_queue does, taking out the
+// people listed in take; returns the people seen, in order
+static vector< int > walk( Vaccine_Queue & q, const vector< int > & take ) {
+  vector< int > seen;
+  for ( int pos = q.begin(); pos < q.end(); ++pos ) {
+    Person * person = q.get( pos );
+    if ( person == NULL ) {
+      continue;
+    }
+    seen.push_back( person->get_pop_index() );
+    for ( int i = 0; i < (int) take.size(); ++i ) {
+      if ( take[ i ] == person->get_pop_index() ) {
+        q.remove_at( pos );
+      }
+    }
+  }
+  q.compact_if_sparse();
+  return seen;
+}
+
+// the queue holds exactly the people expected, in order, and knows where
+// each of them is
+static bool holds( const Vaccine_Queue & q, const vector< int > & expected ) {
+  if ( contents( q ) != expected || q.size() != (int) expected.size() ) {
+    return false;
+  }
+  for ( int i = 0; i < N; ++i ) {
+    bool in_queue = false;
+    for ( int j = 0; j < (int) expected.size(); ++j ) {
+      in_queue = in_queue || expected[ j ] == i;
+    }
+    if ( q.contains( &people[ i ] ) != in_queue ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_hole_behind_front() {
+  Vaccine_Queue q;
+  q.set_positions( &positions );
+  for ( int i = 0; i < 3; ++i ) {
+    q.push_back( &people[ i ] );
+  }
+  q.remove( &people[ 1 ] );
+  check( holds( q, ints { 0, 2 } ), "hole behind the front: queue after remove" );
+  vector< int > seen = walk( q, ints { 0 } );
+  check( seen == ints { 0, 2 }, "hole behind the front: walk sees everyone once" );
+  check( holds( q, ints { 2 } ), "hole behind the front: queue after walk" );
+}
+
+static void test_holes_in_middle() {
+  Vaccine_Queue q;
+  q.set_positions( &positions );
+  for ( int i = 0; i < 10; ++i ) {
+    q.push_back( &people[ i ] );
+  }
+  q.remove( &people[ 2 ] );
+  q.remove( &people[ 5 ] );
+  vector< int > seen = walk( q, ints { 0, 4, 9 } );
+  check( seen == ints { 0, 1, 3, 4, 6, 7, 8, 9 },
+         "holes in the middle: walk sees everyone once" );
+  check( holds( q, ints { 1, 3, 6, 7, 8 } ),
+         "holes in the middle: queue after taking out front, middle and back" );
+
+  // a second walk takes out everyone but the middle one
+  seen = walk( q, ints { 1, 3, 7, 8 } );
+  check( seen == ints { 1, 3, 6, 7, 8 }, "holes in the middle: second walk" );
+  check( holds( q, ints { 6 } ), "holes in the middle: queue after second walk" );
+
+  q.push_back( &people[ 10 ] );
+  q.push_front( &people[ 11 ] );
+  check( holds( q, ints { 11, 6, 10 } ), "holes in the middle: queue after push" );
+}
+
+static void test_take_everyone() {
+  Vaccine_Queue q;
+  q.set_positions( &positions );
+  for ( int i = 0; i < 4; ++i ) {
+    q.push_back( &people[ i ] );
+  }
+  q.push_front( &people[ 4 ] );
+  q.push_front( &people[ 5 ] );
+  q.remove( &people[ 1 ] );
+  check( q.begin() < 0, "take everyone: positions below zero" );
+  vector< int > seen = walk( q, ints { 5, 4, 0, 2, 3 } );
+  check( seen == ints { 5, 4, 0, 2, 3 }, "take everyone: walk sees everyone once" );
+  check( holds( q, ints() ) && q.begin() == q.end(), "take everyone: queue empty after walk" );
+  q.push_back( &people[ 6 ] );
+  check( holds( q, ints { 6 } ), "take everyone: queue after push" );
+}
+
+int main( int argc, char * argv[] ) {
+  INIT_RANDOM( 20120815 );
+  for ( int i = 0; i < N; ++i ) {
+    people[ i ].set_pop_index( i );
+  }
+  test_hole_behind_front();
+  test_holes_in_middle();
+  test_take_everyone();
+
+  if ( failures > 0 ) {
+    printf( "%d tests failed\n", failures );
+  }
+  return failures;
+}
@@ -58,6 +58,10 @@ public:
   // Utility Members
   int get_value_for_timestep(int ts, int offset); // returns the value for the given timestep - delay
   bool is_empty() const { return values->empty(); }
+
+  // the value last returned, kept for later timesteps (see Checkpoint)
+  int get_current_value() const { return current_value; }
+  void set_current_value(int value) { current_value = value; }
   virtual void print();
 
   virtual void read_map();
@@ -17,119 +17,190 @@
 #include "Random.h"
 #include <string>
 #include <sstream>
+#include <set>
+#include "Checkpoint.h"
 
 using namespace std;
 
-Trajectory::Trajectory() {
-  duration = 0;
+namespace {
+
+  struct Table_Less {
+    bool operator()(const Trajectory_Table * a, const Trajectory_Table * b) const {
+      return *a < *b;
+    }
+  };
+
+  std::set< const Trajectory_Table *, Table_Less > shared_tables;
+  fred::Mutex shared_tables_mutex;
+
+  Trajectory_Table empty_table = Trajectory_Table(map< int, trajectory_t >(), trajectory_t());
+
 }
 
-Trajectory::Trajectory(map< int, trajectory_t > infectivity_copy, trajectory_t symptomaticity_copy) {
-  duration = 0;
+Trajectory_Table::Trajectory_Table(const map< int, trajectory_t > & infectivity_copy,
+                                   const trajectory_t & symptomaticity_copy) {
   infectivity = infectivity_copy;
   symptomaticity = symptomaticity_copy;
 
+  int max_duration = (int) symptomaticity.size();
   for (map< int, trajectory_t >::iterator strain_iterator = infectivity.begin(); strain_iterator != infectivity.end(); ++strain_iterator) {
-    if ( (int) strain_iterator->second.size() > duration) {
-      duration = strain_iterator->second.size();
+    if ( (int) strain_iterator->second.size() > max_duration) {
+      max_duration = strain_iterator->second.size();
     }
   }
+  tabulate(max_duration);
+}
 
-  if ( (int) symptomaticity.size() > duration) {
-    duration = symptomaticity.size();
+const Trajectory_Table * Trajectory_Table::intern(const map< int, trajectory_t > & infectivity,
+                                                  const trajectory_t & symptomaticity) {
+  Trajectory_Table * table = new Trajectory_Table(infectivity, symptomaticity);
+  fred::Scoped_Lock lock(shared_tables_mutex);
+  pair< set< const Trajectory_Table *, Table_Less >::iterator, bool > inserted = shared_tables.insert(table);
+  if (!inserted.second) {
+    delete table;
   }
+  return *(inserted.first);
 }
 
-Trajectory * Trajectory::clone() {
-  Trajectory * cloned_trajectory = new Trajectory(infectivity, symptomaticity);
-  return cloned_trajectory;
+bool Trajectory_Table::operator<(const Trajectory_Table & other) const {
+  if (duration != other.duration) {
+    return duration < other.duration;
+  }
+  if (symptomaticity != other.symptomaticity) {
+    return symptomaticity < other.symptomaticity;
+  }
+  return infectivity < other.infectivity;
 }
 
-bool Trajectory::contains(int strain) {
-  return ( infectivity.find(strain) != infectivity.end() );
+void Trajectory_Table::tabulate(int _duration) {
+  duration = _duration;
+  total_infectivity.assign(duration + 1, 0.0);
+  total_symptomaticity.assign(duration + 1, 0.0);
+  // sum the strains in the same order as the map, as get_data_point always has
+  for (map< int, trajectory_t >::iterator strain_iterator = infectivity.begin(); strain_iterator != infectivity.end(); ++strain_iterator) {
+    const trajectory_t & inf = strain_iterator->second;
+    int days = min(duration, (int) inf.size());
+    for (int t = 0; t < days; t++) {
+      total_infectivity[t] += inf[t];
+    }
+  }
+  int days = min(duration, (int) symptomaticity.size());
+  for (int t = 0; t < days; t++) {
+    total_symptomaticity[t] += symptomaticity[t];
+  }
 }
 
-void Trajectory::set_infectivities(map<int, vector<double> > inf) {
-  infectivity = inf;
+Trajectory::Trajectory() {
+  table = &empty_table;
+  own_table = NULL;
 }
 
-trajectory_t Trajectory::get_infectivity_trajectory(int strain) {
-  return infectivity[strain];
+Trajectory::Trajectory(const map< int, trajectory_t > & infectivity_copy, const trajectory_t & symptomaticity_copy) {
+  own_table = new Trajectory_Table(infectivity_copy, symptomaticity_copy);
+  table = own_table;
 }
 
-trajectory_t Trajectory::get_symptomaticity_trajectory() {
-  return symptomaticity;
+Trajectory::Trajectory(const Trajectory_Table * shared_table) {
+  table = shared_table;
+  own_table = NULL;
 }
 
-void Trajectory::set_infectivity_trajectory(int strain, trajectory_t inf) {
-  map< int, trajectory_t >::iterator it = infectivity.find(strain);
+Trajectory::~Trajectory() {
+  delete own_table;
+}
 
-  if (it != infectivity.end()) {
-    infectivity.erase(it);
+Trajectory_Table * Trajectory::get_own_table() {
+  if (own_table == NULL) {
+    own_table = new Trajectory_Table(*table);
+    table = own_table;
   }
+  return own_table;
+}
 
-  infectivity[strain] = inf;
-
-  if (duration < (int) infectivity[strain].size()) {
-    duration = infectivity[strain].size();
+Trajectory * Trajectory::clone() {
+  if (own_table == NULL) {
+    return new Trajectory(table);
   }
+  Trajectory * cloned_trajectory = new Trajectory();
+  cloned_trajectory->own_table = new Trajectory_Table(*own_table);
+  cloned_trajectory->table = cloned_trajectory->own_table;
+  return cloned_trajectory;
 }
 
-void Trajectory::set_symptomaticity_trajectory(trajectory_t symt) {
-  symptomaticity = symt;
+void Trajectory::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write( (char) ( own_table != NULL ) );
+  checkpoint.write( table->duration );
+  checkpoint.write_size( table->infectivity.size() );
+  for (map< int, trajectory_t >::const_iterator it = table->infectivity.begin(); it != table->infectivity.end(); ++it) {
+    checkpoint.write( it->first );
+    checkpoint.write_vector( it->second );
+  }
+  checkpoint.write_vector( table->symptomaticity );
+}
 
-  if (duration < (int) symptomaticity.size()) {
-    duration = (int) symptomaticity.size();
+Trajectory * Trajectory::read_checkpoint(Checkpoint & checkpoint) {
+  char own;
+  int duration;
+  checkpoint.read( own );
+  checkpoint.read( duration );
+  map< int, trajectory_t > infectivity;
+  size_t strains = checkpoint.read_size();
+  for (size_t i = 0; i < strains; ++i) {
+    int strain;
+    checkpoint.read( strain );
+    checkpoint.read_vector( infectivity[ strain ] );
   }
+  trajectory_t symptomaticity;
+  checkpoint.read_vector( symptomaticity );
+  if (!own) {
+    return new Trajectory(Trajectory_Table::intern(infectivity, symptomaticity));
+  }
+  Trajectory * trajectory = new Trajectory();
+  trajectory->own_table = new Trajectory_Table(infectivity, symptomaticity);
+  trajectory->own_table->tabulate(duration);
+  trajectory->table = trajectory->own_table;
+  return trajectory;
 }
 
-Trajectory::point Trajectory::get_data_point(int t) {
-  double point_infectivity = 0.0;
-  double point_symptomaticity = 0.0;
+bool Trajectory::contains(int strain) {
+  return ( table->infectivity.find(strain) != table->infectivity.end() );
+}
 
-  if (duration > t) {
-    map< int, trajectory_t >::iterator strain_iterator;
+void Trajectory::set_infectivities(map<int, vector<double> > inf) {
+  Trajectory_Table * t = get_own_table();
+  t->infectivity = inf;
+  t->tabulate(t->duration);
+}
 
-    for (strain_iterator = infectivity.begin(); strain_iterator != infectivity.end(); ++strain_iterator) {
-      if ( (int) strain_iterator->second.size() > t) {
-        point_infectivity += strain_iterator->second[t];
-      }
-    }
+const trajectory_t & Trajectory::get_infectivity_trajectory(int strain) {
+  static const trajectory_t no_trajectory;
+  map< int, trajectory_t >::const_iterator it = table->infectivity.find(strain);
+  return ( it == table->infectivity.end() ) ? no_trajectory : it->second;
+}
 
-    if ( (int) symptomaticity.size() > t) {
-      point_symptomaticity += symptomaticity[t];
-    }
-  }
+const trajectory_t & Trajectory::get_symptomaticity_trajectory() {
+  return table->symptomaticity;
+}
 
-  return Trajectory::point(point_infectivity, point_symptomaticity);
+void Trajectory::set_infectivity_trajectory(int strain, trajectory_t inf) {
+  Trajectory_Table * t = get_own_table();
+  t->infectivity[strain] = inf;
+  t->tabulate(max(t->duration, (int) inf.size()));
 }
 
-/*
-void Trajectory::calculate_aggregate_infectivity() {
-  // not currently used anywhere, could be used in the trajectory iterator
-  aggregate_infectivity.assign(duration,0.0);
-  map< int, trajectory_t >::iterator strain_iterator;
-  trajectory_t::iterator strain_infectivity_iterator;
-
-  for (strain_iterator = infectivity.begin(); strain_iterator != infectivity.end(); ++strain_iterator) {
-    int t = 0;
-
-    for (strain_infectivity_iterator = strain_iterator->second.begin(); strain_infectivity_iterator != strain_iterator->second.end(); ++strain_infectivity_iterator) {
-      cout << t << "  " << *strain_infectivity_iterator << "  " << duration << endl;
-      aggregate_infectivity[t] += *strain_infectivity_iterator;
-      t++;
-    }
-  }
+void Trajectory::set_symptomaticity_trajectory(trajectory_t symt) {
+  Trajectory_Table * t = get_own_table();
+  t->symptomaticity = symt;
+  t->tabulate(max(t->duration, (int) symt.size()));
 }
-*/
 
 string Trajectory::to_string() {
   ostringstream os;
   os << "Infection Trajectories:";
-  map< int, trajectory_t >::iterator map;
-  trajectory_t::iterator vec;
+  map< int, trajectory_t >::const_iterator map;
+  trajectory_t::const_iterator vec;
 
-  for (map = infectivity.begin(); map != infectivity.end(); ++map) {
+  for (map = table->infectivity.begin(); map != table->infectivity.end(); ++map) {
     os << endl << " Strain " << map->first << ":";
 
     for (vec = map->second.begin(); vec != map->second.end(); ++vec) {
@@ -140,7 +211,7 @@ string Trajectory::to_string() {
   /*
   os << endl << "Symptomaticity Trajectories:" << endl;
 
-  for (vec = symptomaticity.begin(); vec != symptomaticity.end(); ++vec) {
+  for (vec = table->symptomaticity.begin(); vec != table->symptomaticity.end(); ++vec) {
     os << " " << *vec;
   }
 */
@@ -154,13 +225,14 @@ void Trajectory::print() {
 void Trajectory::print_alternate(stringstream &out) {
   //out << "Strains: ";
   //print();
+  const map<int, trajectory_t> & infectivity = table->infectivity;
   if(infectivity.size() == 1) { 
-    map<int, trajectory_t>::iterator it = infectivity.begin();
+    map<int, trajectory_t>::const_iterator it = infectivity.begin();
     out << it->first << " " << it->second.size();
   }
   else {
-    map<int, trajectory_t>::iterator it1 = infectivity.begin();
-    map<int, trajectory_t>::iterator it2 = infectivity.end();
+    map<int, trajectory_t>::const_iterator it1 = infectivity.begin();
+    map<int, trajectory_t>::const_iterator it2 = infectivity.end();
     int mut_day = 0;
     for(unsigned int i=0; i<it2->second.size(); i++) {
       if(it2->second.at(i) != 0) break;
@@ -176,9 +248,9 @@ void Trajectory::print_alternate(stringstream &out) {
 map<int, double> *Trajectory::get_current_loads(int day) {
   map<int, double> *infectivities = new map<int, double>;
 
-  map< int, trajectory_t > :: iterator it;
+  map< int, trajectory_t > :: const_iterator it;
 
-  for(it = infectivity.begin(); it != infectivity.end(); it++) {
+  for(it = table->infectivity.begin(); it != table->infectivity.end(); it++) {
     pair<int, double> p = pair<int, double> (it->first, (it->second)[day]);
     infectivities->insert(p);
   }
@@ -189,9 +261,9 @@ map<int, double> *Trajectory::get_current_loads(int day) {
 map<int, double> *Trajectory::getInoculum(int day) {
   map<int, double> *infectivities = new map<int, double>;
 
-  map< int, trajectory_t > :: iterator it;
+  map< int, trajectory_t > :: const_iterator it;
 
-  for(it = infectivity.begin(); it != infectivity.end(); it++) {
+  for(it = table->infectivity.begin(); it != table->infectivity.end(); it++) {
     pair<int, double> p = pair<int, double> (it->first, (it->second)[day]);
     infectivities->insert(p);
   }
@@ -203,18 +275,25 @@ void Trajectory::modify_symp_period(int startDate, int days_left) {
   // symptomaticty and infectivity trajectories become 0 after startDate + days_left
   int end_date = startDate + days_left;
 
-  if(end_date > (int) symptomaticity.size()) return;
+  if(end_date > (int) table->symptomaticity.size()) return;
 
+  Trajectory_Table * t = get_own_table();
+  trajectory_t & symptomaticity = t->symptomaticity;
+  map< int, trajectory_t > & infectivity = t->infectivity;
   symptomaticity.resize(end_date, 1);
   map< int, trajectory_t > :: iterator it;
 
   for(it = infectivity.begin(); it != infectivity.end(); it++) {
     (it->second).resize(end_date, 1);
   }
+  t->tabulate(t->duration);
 }
 
 void Trajectory::modify_asymp_period(int startDate, int days_left, int sympDate) {
   int end_date = startDate + days_left;
+  Trajectory_Table * t = get_own_table();
+  trajectory_t & symptomaticity = t->symptomaticity;
+  map< int, trajectory_t > & infectivity = t->infectivity;
 
   // if decreasing the asymp period
   if(end_date < sympDate) {
@@ -257,10 +336,14 @@ void Trajectory::modify_asymp_period(int startDate, int days_left, int sympDate)
       inf.insert(it, days_extended, inf[sympDate-1]);
     }
   }
+  t->tabulate(t->duration);
 }
 
 void Trajectory :: modify_develops_symp(int sympDate, int sympPeriod) {
   int end_date = sympDate + sympPeriod;
+  Trajectory_Table * t = get_own_table();
+  trajectory_t & symptomaticity = t->symptomaticity;
+  map< int, trajectory_t > & infectivity = t->infectivity;
 
   if(end_date < (int) symptomaticity.size()) {
     symptomaticity.resize(end_date);
@@ -276,19 +359,22 @@ void Trajectory :: modify_develops_symp(int sympDate, int sympPeriod) {
       inf.insert(it, end_date - symptomaticity.size(), inf[end_date-1]);
     }
   }
+  t->tabulate(t->duration);
 }
 
 void Trajectory :: get_all_strains(vector<int>& strains) {
   strains.clear();
-  map< int, trajectory_t > :: iterator inf_it;
+  map< int, trajectory_t > :: const_iterator inf_it;
 
-  for(inf_it = infectivity.begin(); inf_it != infectivity.end(); inf_it++) {
+  for(inf_it = table->infectivity.begin(); inf_it != table->infectivity.end(); inf_it++) {
     strains.push_back(inf_it->first);
   }
 }
 
 void Trajectory :: mutate(int old_strain, int new_strain, unsigned int day) {
-  if(infectivity.find(new_strain) != infectivity.end()) return; // HACK
+  if(table->infectivity.find(new_strain) != table->infectivity.end()) return; // HACK
+  Trajectory_Table * t = get_own_table();
+  map< int, trajectory_t > & infectivity = t->infectivity;
   if(infectivity.find(old_strain) == infectivity.end()){
     cout << "Strain Not Found: " << old_strain << endl;
     print();
@@ -304,6 +390,7 @@ void Trajectory :: mutate(int old_strain, int new_strain, unsigned int day) {
     old_inf[d] = 0;
   }
   infectivity.insert( pair<int, vector<double> > (new_strain, new_inf) );
+  t->tabulate(t->duration);
   //infectivity.insert( pair<int, vector<double> > (old_strain, old_inf) );
   
   //cout << "Mutated from " << old_strain << " to " << new_strain << " on day " << day << endl;
@@ -29,10 +29,72 @@
 
 typedef std::vector<double> trajectory_t;
 
+class Trajectory;
+class Checkpoint;
+
+/**
+ * The infectivity and symptomaticity of an infection by day since exposure.
+ *
+ * A table is immutable once built, so that infections with the same course
+ * can share one (see intern()).  Besides the trajectories of each strain it
+ * keeps the daily totals in flat arrays with a zero past the last day, so
+ * that the value for any day is a single read.
+ */
+class Trajectory_Table {
+  public:
+    Trajectory_Table(const std::map< int, trajectory_t > & infectivity, const trajectory_t & symptomaticity);
+
+    /**
+     * @return the shared table with these trajectories, created if this is
+     * the first infection to use it.  Shared tables are never deleted.
+     */
+    static const Trajectory_Table * intern(const std::map< int, trajectory_t > & infectivity,
+                                           const trajectory_t & symptomaticity);
+
+    int get_duration() const {
+      return duration;
+    }
+
+    // zero for days outside [0, duration)
+    double get_infectivity(int t) const {
+      return total_infectivity[ clamp(t) ];
+    }
+
+    double get_symptomaticity(int t) const {
+      return total_symptomaticity[ clamp(t) ];
+    }
+
+    bool operator<(const Trajectory_Table & other) const;
+
+  private:
+    friend class Trajectory;
+
+    int duration;
+    std::map< int, trajectory_t > infectivity;
+    trajectory_t symptomaticity;
+
+    // sums over strains for days [0, duration], the last always zero
+    std::vector<double> total_infectivity;
+    std::vector<double> total_symptomaticity;
+
+    int clamp(int t) const {
+      return ( (unsigned) t < (unsigned) duration ) ? t : duration;
+    }
+
+    // recompute the totals, reading the trajectories up to the given duration
+    void tabulate(int _duration);
+};
+
+/**
+ * The course of one infection.  It reads a Trajectory_Table, normally a shared
+ * one, and makes a private copy the first time the course is modified.
+ */
 class Trajectory {
   public:
     Trajectory();
-    Trajectory(std::map< int, trajectory_t > infectivity_copy, trajectory_t symptomaticity_copy);
+    Trajectory(const std::map< int, trajectory_t > & infectivity_copy, const trajectory_t & symptomaticity_copy);
+    Trajectory(const Trajectory_Table * shared_table);
+    ~Trajectory();
 
     /**
      * Create a copy of this Trajectory and return a pointer to it
@@ -47,8 +109,8 @@ class Trajectory {
     bool contains(int strain);
 
 
-    trajectory_t get_infectivity_trajectory(int strain);
-    trajectory_t get_symptomaticity_trajectory();
+    const trajectory_t & get_infectivity_trajectory(int strain);
+    const trajectory_t & get_symptomaticity_trajectory();
     void get_all_strains(std::vector<int> &);
 
     void set_symptomaticity_trajectory(trajectory_t symt);
@@ -58,7 +120,11 @@ class Trajectory {
     Transmission::Loads * get_current_loads( int day );
 
     int get_duration() {
-      return duration;
+      return table->get_duration();
+    }
+
+    double get_infectivity(int t) const {
+      return table->get_infectivity(t);
     }
 
     struct point {
@@ -70,7 +136,9 @@ class Trajectory {
       };
     };
 
-    point get_data_point(int t);
+    point get_data_point(int t) {
+      return point(table->get_infectivity(t), table->get_symptomaticity(t));
+    }
 
     /**
      * The class to allow iteration over a set of Trajectory objects
@@ -89,7 +157,7 @@ class Trajectory {
 
         bool has_next() {
           current++;
-          next_exists = ( current < trajectory->duration );
+          next_exists = ( current < trajectory->get_duration() );
           return next_exists;
         }
 
@@ -103,7 +171,6 @@ class Trajectory {
     };
 
 
-    //void calculate_aggregate_infectivity();
     std::map<int, double> * getInoculum(int day);
     void modify_symp_period(int startDate, int days_left);
     void modify_asymp_period(int startDate, int days_left, int sympDate);
@@ -114,13 +181,19 @@ class Trajectory {
     void print();
     void print_alternate(std::stringstream &out);
 
+    /// see Checkpoint; a shared table is shared again when read back
+    void write_checkpoint(Checkpoint & checkpoint);
+    static Trajectory * read_checkpoint(Checkpoint & checkpoint);
+
   private:
-    int duration;
+    // the table read by this trajectory; equal to own_table once modified
+    const Trajectory_Table * table;
+    Trajectory_Table * own_table;
 
-    std::map< int, trajectory_t > infectivity;
-    trajectory_t symptomaticity;
+    Trajectory_Table * get_own_table();
 
-    //trajectory_t aggregate_infectivity;
+    Trajectory(const Trajectory &);
+    void operator=(const Trajectory &);
   };
 
 #endif
@@ -24,6 +24,7 @@
 #include "Person.h"
 #include "Utils.h"
 #include "Geo_Utils.h"
+#include "Checkpoint.h"
 #include <stdio.h>
 #include <vector>
 #include <set>
@@ -48,6 +49,7 @@ static int max_trip_list_size;
 static double active_trip_fraction;
 static int max_trips_per_day;
 static int trips_per_day;
+static long trip_counter = 0;  // trips taken so far, for cycling through trip_list
 char tripfile[FRED_STRING_SIZE];
 
 // runtime parameters
@@ -258,9 +260,7 @@ void Travel::update_travel(int day) {
 }
 
 void Travel::select_visitor_and_visited(Person **v1, Person **v2, int day) {
-  //static int trip_counter = 0;
   // Anuroop
-  static long trip_counter = 0;
   Person * visitor = NULL;
   Person * visited = NULL;
 
@@ -348,6 +348,39 @@ void Travel::terminate_person(Person *person) {
   }
 }
 
+void Travel::get_travelers(std::vector<Person *> & travelers) {
+  if (!Global::Enable_Travel)
+    return;
+  for (int i = 0; i <= max_Travel_Duration; i++) {
+    travelers.insert(travelers.end(), traveler_list_ptr[i]->begin(), traveler_list_ptr[i]->end());
+  }
+}
+
+void Travel::write_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.write_tag("travel");
+  checkpoint.write(max_Travel_Duration);
+  for (int i = 0; i <= max_Travel_Duration; i++) {
+    checkpoint.write_people(*traveler_list_ptr[i]);
+  }
+  checkpoint.write_vector(trip_list);
+  checkpoint.write(trip_counter);
+}
+
+void Travel::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read_tag("travel");
+  int duration;
+  checkpoint.read(duration);
+  if (duration != max_Travel_Duration) {
+    Utils::fred_abort("Checkpoint has trips of up to %d days, but the parameters allow %d\n",
+        duration, max_Travel_Duration);
+  }
+  for (int i = 0; i <= max_Travel_Duration; i++) {
+    checkpoint.read_people(*traveler_list_ptr[i]);
+  }
+  checkpoint.read_vector(trip_list);
+  checkpoint.read(trip_counter);
+}
+
 void Travel::quality_control(char * directory) {
 }
 
@@ -18,7 +18,9 @@
 #define _FRED_TRAVEL_H
 
 #include <stdio.h>
+#include <vector>
 class Person;
+class Checkpoint;
 
 class Travel {
  public:
@@ -62,6 +64,18 @@ class Travel {
   static void quality_control(char * directory);
 
   static void terminate_person(Person *per);
+
+  /**
+   * Append the people who are currently traveling to travelers
+   */
+  static void get_travelers(std::vector<Person *> & travelers);
+
+  /**
+   * Write the travelers (by the day their trip ends) and the place in the
+   * trip list to a checkpoint, or read them back (see Checkpoint)
+   */
+  static void write_checkpoint(Checkpoint & checkpoint);
+  static void read_checkpoint(Checkpoint & checkpoint);
 };
 
 #endif // _FRED_TRAVEL_H
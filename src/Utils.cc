@@ -101,19 +101,22 @@ void Utils::fred_warning(const char* format, ...){
 void Utils::fred_open_output_files(char * directory, int run){
   char filename[FRED_STRING_SIZE];
 
+  // the files are opened for reading too, so that a checkpoint can take a
+  // copy of what has been written so far (see Checkpoint)
+
   // ErrorLog file is created at the first warning or error
   Global::ErrorLogfp = NULL;
   sprintf(ErrorFilename, "%s/err%d.txt", directory, run);
 
   sprintf(filename, "%s/out%d.txt", directory, run);
-  Global::Outfp = fopen(filename, "w");
+  Global::Outfp = fopen(filename, "w+");
   if (Global::Outfp == NULL) {
     Utils::fred_abort("Can't open %s\n", filename);
   }
   Global::Tracefp = NULL;
   if (strcmp(Global::Tracefilebase, "none") != 0) {
     sprintf(filename, "%s/trace%d.txt", directory, run);
-    Global::Tracefp = fopen(filename, "w");
+    Global::Tracefp = fopen(filename, "w+");
     if (Global::Tracefp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -121,7 +124,7 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::Infectionfp = NULL;
   if (Global::Track_infection_events) {
     sprintf(filename, "%s/infections%d.txt", directory, run);
-    Global::Infectionfp = fopen(filename, "w");
+    Global::Infectionfp = fopen(filename, "w+");
     if (Global::Infectionfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -131,13 +134,13 @@ void Utils::fred_open_output_files(char * directory, int run){
   if (1) {
     if (strcmp(Global::EventReportFile, "none") == 0) {
         sprintf(filename, "%s/report%d.json_lines", directory, run);
-        Global::Reportfp = fopen(filename, "w");
+        Global::Reportfp = fopen(filename, "w+");
         if (Global::Reportfp == NULL) {
             Utils::fred_abort("Can't open %s\n", filename);
         }
     }
     else {
-        Global::Reportfp = fopen(Global::EventReportFile, "w");
+        Global::Reportfp = fopen(Global::EventReportFile, "w+");
         if (Global::Reportfp == NULL) {
             Utils::fred_abort("Can't open %s\n", Global::EventReportFile);
         }
@@ -148,7 +151,7 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::VaccineTracefp = NULL;
   if (strcmp(Global::VaccineTracefilebase, "none") != 0) {
     sprintf(filename, "%s/vacctr%d.txt", directory, run);
-    Global::VaccineTracefp = fopen(filename, "w");
+    Global::VaccineTracefp = fopen(filename, "w+");
     if (Global::VaccineTracefp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -161,7 +164,7 @@ void Utils::fred_open_output_files(char * directory, int run){
       else {
           sprintf(filename, "%s/vaccinf%d.txt", directory, run);
       }
-      Global::VaccineInfectionTrackerfp = fopen(filename, "w");
+      Global::VaccineInfectionTrackerfp = fopen(filename, "w+");
       if (Global::VaccineInfectionTrackerfp == NULL) {
         Utils::fred_abort("Can't open %s\n", filename);
       }
@@ -169,7 +172,7 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::Birthfp = NULL;
   if (Global::Enable_Births) {
     sprintf(filename, "%s/births%d.txt", directory, run);
-    Global::Birthfp = fopen(filename, "w");
+    Global::Birthfp = fopen(filename, "w+");
     if (Global::Birthfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -177,7 +180,7 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::Deathfp = NULL;
   if (Global::Enable_Deaths) {
     sprintf(filename, "%s/deaths%d.txt", directory, run);
-    Global::Deathfp = fopen(filename, "w");
+    Global::Deathfp = fopen(filename, "w+");
     if (Global::Deathfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -185,16 +188,16 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::Immunityfp = NULL;
   if (strcmp(Global::Immunityfilebase, "none") != 0) {
     sprintf(filename, "%s/immunity%d.txt", directory, run);
-    Global::Immunityfp = fopen(filename, "w");
+    Global::Immunityfp = fopen(filename, "w+");
     if (Global::Immunityfp == NULL) {
       Utils::fred_abort("Help! Can't open %s\n", filename);
     }
     Global::Report_Immunity = true;
   }
-  Global::Householdfp = NULL;
-  if (Global::Print_Household_Locations) {
+  // households.txt is written during set up, and kept for every run of a batch
+  if (Global::Print_Household_Locations && Global::Householdfp == NULL) {
     sprintf(filename, "%s/households.txt", directory);
-    Global::Householdfp = fopen(filename, "w");
+    Global::Householdfp = fopen(filename, "w+");
     if (Global::Householdfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -202,7 +205,7 @@ void Utils::fred_open_output_files(char * directory, int run){
   Global::BlockDayfp = NULL;
   if(Global::Report_Epidemic_Data_By_Census_Block) {
     sprintf(filename,"%s/blockseday%d.txt",directory,run);
-    Global::BlockDayfp = fopen(filename,"w");
+    Global::BlockDayfp = fopen(filename,"w+");
     if (Global::BlockDayfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -222,6 +225,21 @@ void Utils::fred_make_directory(char * directory) {
 }
 
 
+void Utils::fred_close_output_files() {
+  // closes the files of one run, before the next run of a batch opens its own
+  FILE ** run_files[] = {
+    &Global::ErrorLogfp, &Global::Outfp, &Global::Tracefp, &Global::Infectionfp,
+    &Global::Reportfp, &Global::VaccineTracefp, &Global::VaccineInfectionTrackerfp,
+    &Global::Birthfp, &Global::Deathfp, &Global::Immunityfp, &Global::BlockDayfp
+  };
+  for (size_t i = 0; i < sizeof(run_files) / sizeof(run_files[0]); i++) {
+    if (*run_files[i] != NULL) {
+      fclose(*run_files[i]);
+      *run_files[i] = NULL;
+    }
+  }
+}
+
 void Utils::fred_end(void){
   // This is a function that cleans up FRED and exits
   if (Global::Outfp != NULL) fclose(Global::Outfp);
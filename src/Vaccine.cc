@@ -22,6 +22,7 @@ using namespace std;
 
 #include "Vaccine.h"
 #include "Vaccine_Dose.h"
+#include "Checkpoint.h"
 
 Vaccine::Vaccine(string _name, int _id, int _disease, 
                  int _total_avail, int _additional_per_day, 
@@ -78,3 +79,21 @@ int Vaccine::get_strain(int i) {
   if(i < num_strains) return strains[i];
   else return -1;
 }
+
+void Vaccine::write_checkpoint(Checkpoint & checkpoint) const {
+  checkpoint.write(initial_stock);
+  checkpoint.write(total_avail);
+  checkpoint.write(stock);
+  checkpoint.write(reserve);
+  checkpoint.write(number_delivered);
+  checkpoint.write(number_effective);
+}
+
+void Vaccine::read_checkpoint(Checkpoint & checkpoint) {
+  checkpoint.read(initial_stock);
+  checkpoint.read(total_avail);
+  checkpoint.read(stock);
+  checkpoint.read(reserve);
+  checkpoint.read(number_delivered);
+  checkpoint.read(number_effective);
+}
@@ -26,6 +26,7 @@
 using namespace std;
 
 class Vaccine_Dose;
+class Checkpoint;
 
 class Vaccine{
 public:
@@ -74,6 +75,10 @@ public:
   void print() const;
   void update(int day);
   void reset();
+
+  // see Checkpoint; the stocks and counts
+  void write_checkpoint(Checkpoint & checkpoint) const;
+  void read_checkpoint(Checkpoint & checkpoint);
   
 private:
   string name;
@@ -24,6 +24,8 @@
 #include "Health.h"
 #include "Person.h"
 #include "Global.h"
+#include "Vaccines.h"
+#include "Checkpoint.h"
 
 Vaccine_Health::Vaccine_Health(int _vaccination_day, Vaccine* _vaccine, int _age, 
              Person * _person, Vaccine_Manager* _vaccine_manager){
@@ -49,6 +51,52 @@ Vaccine_Health::Vaccine_Health(int _vaccination_day, Vaccine* _vaccine, int _age
   
 }
 
+Vaccine_Health::Vaccine_Health() {
+  vaccination_day = -1;
+  vaccination_effective_day = -1;
+  vaccine = NULL;
+  current_dose = 0;
+  days_to_next_dose = -1;
+  person = NULL;
+  vaccine_manager = NULL;
+  effective = false;
+}
+
+void Vaccine_Health::write_checkpoint(Checkpoint & checkpoint) const {
+  checkpoint.write(vaccination_day);
+  checkpoint.write(vaccination_effective_day);
+  Vaccines * vaccines = vaccine_manager->get_vaccines();
+  int vaccine_index = -1;
+  for (int i = 0; i < vaccines->get_number_vaccines(); i++) {
+    if (vaccines->get_vaccine(i) == vaccine) {
+      vaccine_index = i;
+    }
+  }
+  checkpoint.write(vaccine_index);
+  checkpoint.write(current_dose);
+  checkpoint.write(days_to_next_dose);
+  checkpoint.write(effective);
+}
+
+Vaccine_Health * Vaccine_Health::read_checkpoint(Person * person, Checkpoint & checkpoint) {
+  Vaccine_Health * vaccine_health = new Vaccine_Health();
+  vaccine_health->person = person;
+  vaccine_health->vaccine_manager = Global::Pop.get_vaccine_manager();
+  checkpoint.read(vaccine_health->vaccination_day);
+  checkpoint.read(vaccine_health->vaccination_effective_day);
+  int vaccine_index;
+  checkpoint.read(vaccine_index);
+  Vaccines * vaccines = vaccine_health->vaccine_manager->get_vaccines();
+  if (vaccine_index < 0 || vaccine_index >= vaccines->get_number_vaccines()) {
+    Utils::fred_abort("Checkpoint has vaccine %d, which is not in the parameters\n", vaccine_index);
+  }
+  vaccine_health->vaccine = vaccines->get_vaccine(vaccine_index);
+  checkpoint.read(vaccine_health->current_dose);
+  checkpoint.read(vaccine_health->days_to_next_dose);
+  checkpoint.read(vaccine_health->effective);
+  return vaccine_health;
+}
+
 void Vaccine_Health::print() const {
   // Need to make work :)
   cout << "\nVaccine_Status";
@@ -67,7 +115,7 @@ void Vaccine_Health::update(int day, int age){
     Disease* s = Global::Pop.get_disease(0);
     person->become_immune(s);
     effective = true;
-    if(Global::Debug < 1) {
+    if(Global::Debug > 1) {
       cout << "Agent " << person->get_id() 
      << " has become immune from dose "<< current_dose 
      << "on day " << day << "\n";
@@ -84,27 +132,14 @@ void Vaccine_Health::update(int day, int age){
       current_dose++;
       days_to_next_dose = day + vaccine->get_dose(current_dose)->get_days_between_doses();
       int vaccine_dose_priority = vaccine_manager->get_vaccine_dose_priority();
-      if(Global::Debug < 1){
+      if(Global::Debug > 1){
   cout << "Agent " << person->get_id()
        << " being put in to the queue with priority " << vaccine_dose_priority
        << " for dose " << current_dose 
        << " on day " << day << "\n";
       }
-      switch(vaccine_dose_priority){
-      case VACC_DOSE_NO_PRIORITY:
-  vaccine_manager->add_to_regular_queue_random(person);
-  break;
-      case VACC_DOSE_FIRST_PRIORITY:
-  vaccine_manager->add_to_priority_queue_begin(person);
-  break;
-      case VACC_DOSE_RAND_PRIORITY:
-  vaccine_manager->add_to_priority_queue_random(person);
-  break;
-      case VACC_DOSE_LAST_PRIORITY:
-  vaccine_manager->add_to_priority_queue_end(person);
-  break;
-  
-      }
+      // queued after the sweep (see Vaccine_Manager::queue_next_doses)
+      vaccine_manager->add_next_dose(person);
     }
   }
 }
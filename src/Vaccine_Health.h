@@ -29,6 +29,7 @@ class Vaccine_Dose;
 class Person;
 class Health;
 class Vaccine_Manager;
+class Checkpoint;
 
 class Vaccine_Health {
 public:
@@ -62,6 +63,10 @@ public:
   void printTrace() const;
   void update(int day, int age);
   void update_for_next_dose(int day, int age);
+
+  // see Checkpoint
+  void write_checkpoint(Checkpoint & checkpoint) const;
+  static Vaccine_Health * read_checkpoint(Person * person, Checkpoint & checkpoint);
   
 private:
   int vaccination_day;              // On which day did you get the vaccine
@@ -29,10 +29,11 @@
 #include "Global.h"
 #include "Timestep_Map.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 
 #include <algorithm>
 
-Vaccine_Manager::Vaccine_Manager() {
+Vaccine_Manager::Vaccine_Manager() : next_doses( NCPU ) {
     vaccine_package = NULL;
     vaccine_priority_age_low = -1;
     vaccine_priority_age_high = -1;
@@ -40,12 +41,16 @@ Vaccine_Manager::Vaccine_Manager() {
     vaccine_priority_only = false;
     vaccination_capacity_map = NULL;
     do_vacc = false;
+    priority_queue.set_positions(&queue_positions);
+    queue.set_positions(&queue_positions);
 }
 
 Vaccine_Manager::Vaccine_Manager(Population *_pop):
-    Manager(_pop) {
+    Manager(_pop), next_doses( NCPU ) {
 
     pop = _pop;
+    priority_queue.set_positions(&queue_positions);
+    queue.set_positions(&queue_positions);
 
     vaccine_package = new Vaccines();
     int num_vaccs = 0;
@@ -129,23 +134,21 @@ void Vaccine_Manager::fill_queues() {
     // We need to loop over the entire population that the Manager oversees to put them in a queue.
     int popsize = pop->get_pop_size();
 
+    vector <Person *> random_queue;
+    vector <Person *> random_priority_queue;
     for (int ip = 0; ip < popsize; ip++) {
         Person* current_person = pop->get_person_by_index(ip);
         if (policies[current_policy]->choose_first_positive(current_person,0,0)==true)
-            priority_queue.push_back(current_person);
+            random_priority_queue.push_back(current_person);
         else if (vaccine_priority_only == false)
-            queue.push_back(current_person);
+            random_queue.push_back(current_person);
     }
 
-    vector <Person *> random_queue(queue.size());
-    copy(queue.begin(),queue.end(),random_queue.begin());
     FYShuffle < Person *>(random_queue);
-    copy(random_queue.begin(), random_queue.end(),queue.begin());
+    queue.assign(random_queue);
 
-    vector <Person *> random_priority_queue(priority_queue.size());
-    copy(priority_queue.begin(),priority_queue.end(),random_priority_queue.begin());
     FYShuffle <Person *> (random_priority_queue);
-    copy(random_priority_queue.begin(),random_priority_queue.end(),priority_queue.begin());
+    priority_queue.assign(random_priority_queue);
 
     if (Global::Verbose > 0) {
         cout << "Vaccine Queue Stats \n";
@@ -167,35 +170,17 @@ void Vaccine_Manager::add_to_queue(Person* person) {
 
 void Vaccine_Manager::remove_from_queue(Person* person) {
     // remove the person from the queue if they are in there
-    list<Person *>::iterator pq = find(priority_queue.begin(),priority_queue.end(),person);
-    if (pq != priority_queue.end()) {
-        priority_queue.erase(pq);
-        return;
-    }
-    pq = find(queue.begin(),queue.end(),person);
-    if (pq != queue.end()) {
-        queue.erase(pq);
+    if (!priority_queue.remove(person)) {
+        queue.remove(person);
     }
 }
 
 void Vaccine_Manager::add_to_priority_queue_random(Person* person) {
-    // Find a position to put the person in
-    int size = priority_queue.size();
-    int position = (int)(RANDOM()*size);
-
-    list<Person*>::iterator pq = priority_queue.begin();
-    for (int i = 0; i < position; i++) ++pq;
-    priority_queue.insert(pq,person);
+    priority_queue.insert_random(person);
 }
 
 void Vaccine_Manager::add_to_regular_queue_random(Person* person) {
-    // Find a position to put the person in
-    int size = queue.size();
-    int position = (int)(RANDOM()*size);
-
-    list<Person*>::iterator pq = queue.begin();
-    for (int i = 0; i < position; i++) ++pq;
-    queue.insert(pq,person);
+    queue.insert_random(person);
 }
 
 void Vaccine_Manager::add_to_priority_queue_begin(Person* person) {
@@ -206,6 +191,32 @@ void Vaccine_Manager::add_to_priority_queue_end(Person* person) {
     priority_queue.push_back(person);
 }
 
+void Vaccine_Manager::queue_next_doses() {
+    vector < Person * > people;
+    for (int t = 0; t < next_doses.size(); t++) {
+        people.insert(people.end(), next_doses(t).begin(), next_doses(t).end());
+        next_doses(t).clear();
+    }
+    // the order the threads found them in varies from run to run
+    sort(people.begin(), people.end(), Person::compare_pop_index);
+    for (unsigned int i = 0; i < people.size(); i++) {
+        switch(vaccine_dose_priority){
+        case VACC_DOSE_NO_PRIORITY:
+            add_to_regular_queue_random(people[i]);
+            break;
+        case VACC_DOSE_FIRST_PRIORITY:
+            add_to_priority_queue_begin(people[i]);
+            break;
+        case VACC_DOSE_RAND_PRIORITY:
+            add_to_priority_queue_random(people[i]);
+            break;
+        case VACC_DOSE_LAST_PRIORITY:
+            add_to_priority_queue_end(people[i]);
+            break;
+        }
+    }
+}
+
 string Vaccine_Manager::get_vaccine_dose_priority_string() const {
     switch (vaccine_dose_priority) {
     case VACC_DOSE_NO_PRIORITY:
@@ -257,8 +268,6 @@ void Vaccine_Manager::vaccinate(int day) {
     }
 
     int number_vaccinated = 0;
-    int n_p_vaccinated = 0;
-    int n_r_vaccinated = 0;
     // Figure out the total number of vaccines we can hand out today
     int total_vaccines_avail = vaccine_package->get_total_vaccines_avail_today();
 
@@ -274,140 +283,100 @@ void Vaccine_Manager::vaccinate(int day) {
         return;
     }
 
-    // Start vaccinating Priority
-    list < Person* >:: iterator ip;
-    ip = priority_queue.begin();
+    // Run through the priority queue first, then the regular queue
+    if (vaccinate_queue(priority_queue, "priority", day, total_vaccines_avail, number_vaccinated))
+        vaccinate_queue(queue, "regular", day, total_vaccines_avail, number_vaccinated);
+}
+
+bool Vaccine_Manager::vaccinate_queue(Vaccine_Queue &q, const char *name, int day,
+                                      int &total_vaccines_avail, int &number_vaccinated) {
+    // Vaccinate the queue in order until the stock or the capacity runs out;
+    // returns false if it did.  Removal leaves the later positions unchanged.
+    int n_vaccinated = 0;
     int accept_count = 0;
     int reject_count = 0;
-    // Run through the priority queue first
-    while (ip!=priority_queue.end()) {
-        Person* current_person = *ip;
+    const char *stopped_by = NULL;
+    for (int pos = q.begin(); pos < q.end(); pos++) {
+        Person* current_person = q.get(pos);
+        if (current_person == NULL) continue;
 
         int vacc_app = vaccine_package->pick_from_applicable_vaccines(current_person->get_age());
-        if (vacc_app > -1) {
-            bool accept_vaccine = false;
-            if (current_person->get_health()->is_vaccinated()) {
-                accept_vaccine = current_person->acceptance_of_another_vaccine_dose();
-            } else {
-                accept_vaccine = current_person->acceptance_of_vaccine();
-            }
-            if (accept_vaccine==true) {
-                accept_count++;
-                number_vaccinated++;
-                current_vaccine_capacity--;
-                n_p_vaccinated++;
-                Vaccine* vacc = vaccine_package->get_vaccine(vacc_app);
-                vacc->remove_stock(1);
-                total_vaccines_avail--;
-                current_person->take_vaccine(vacc, day, this);
-                ip = priority_queue.erase(ip);  // remove a vaccinated person
-            } else {
-                reject_count++;
-                // skip non-compliant person under HBM
-                // if(strcmp(Global::Behavior_model_type,"HBM") == 0) ++ip;
-                if (0) ++ip;
-                // remove non-compliant person if not HBM
-                else ip = priority_queue.erase(ip);
-            }
-        } else {
+        if (vacc_app < 0) {
             if (Global::Verbose > 1) {
                 cout << "Vaccine not applicable for agent "<<current_person->get_id() << " " \
                      << current_person->get_age() << "\n";
             }
-            ++ip;
+            continue;
         }
-
-        if (total_vaccines_avail == 0) {
-            if (Global::Verbose > 0) {
-                cout << "Vaccinated priority to stock out "<< n_p_vaccinated << " agents, for a total of "
-                     << number_vaccinated << " on day " << day << "\n";
-                cout << "Left in queues:  Priority ("<< priority_queue.size() << ")    Regular ("
-                     <<queue.size() << ")\n";
-                cout << "Number of acceptances: " << accept_count << ", Number of rejections: " << reject_count << "\n";
-            }
-            return;
+        bool accept_vaccine = false;
+        if (current_person->get_health()->is_vaccinated()) {
+            accept_vaccine = current_person->acceptance_of_another_vaccine_dose();
+        } else {
+            accept_vaccine = current_person->acceptance_of_vaccine();
         }
-        if (current_vaccine_capacity == 0) {
-            if (Global::Verbose > 0) {
-                cout << "Vaccinated priority to capacity "<< n_p_vaccinated << " agents, for a total of "
-                     << number_vaccinated << " on day " << day << "\n";
-                cout << "Left in queues:  Priority ("<< priority_queue.size() << ")    Regular ("
-                     <<queue.size() << ")\n";
-                cout << "Number of acceptances: " << accept_count << ", Number of rejections: " << reject_count << "\n";
-            }
-            return;
+        // vaccinated and non-compliant people both leave the queue
+        q.remove_at(pos);
+        if (accept_vaccine == false) {
+            reject_count++;
+            continue;
         }
-    }
-
+        accept_count++;
+        number_vaccinated++;
+        current_vaccine_capacity--;
+        n_vaccinated++;
+        Vaccine* vacc = vaccine_package->get_vaccine(vacc_app);
+        vacc->remove_stock(1);
+        total_vaccines_avail--;
+        current_person->take_vaccine(vacc, day, this);
 
-    if (Global::Verbose > 0)
-        cout << "Vaccinated priority to population " << n_p_vaccinated
-             << " agents, for a total of "<< number_vaccinated << " on day "
-             << day << "\n";
-
-    // Run now through the regular queue
-    ip = queue.begin();
-    accept_count = 0;
-    reject_count = 0;
-    while (ip != queue.end()) {
-        Person* current_person = *ip;
-        int vacc_app = vaccine_package->pick_from_applicable_vaccines(current_person->get_age());
-        if (vacc_app > -1) {
-            bool accept_vaccine = true;
-            if (current_person->get_health()->is_vaccinated()) {
-                accept_vaccine = current_person->acceptance_of_another_vaccine_dose();
-            } else {
-                accept_vaccine = current_person->acceptance_of_vaccine();
-            }
-            if (accept_vaccine==true) {
-                accept_count++;
-                number_vaccinated++;
-                current_vaccine_capacity--;
-                n_r_vaccinated++;
-                Vaccine* vacc = vaccine_package->get_vaccine(vacc_app);
-                vacc->remove_stock(1);
-                total_vaccines_avail--;
-                current_person->take_vaccine(vacc,day,this);
-                ip = queue.erase(ip);  // remove a vaccinated person
-            } else {
-                reject_count++;
-                // skip non-compliant person under HBM
-                // if(strcmp(Global::Behavior_model_type,"HBM") == 0) ip++;
-                if (0) ip++;
-                // remove non-compliant person if not HBM
-                else ip = queue.erase(ip);
-            }
-        } else {
-            ip++;
-        }
         if (total_vaccines_avail == 0) {
-            if (Global::Verbose > 0) {
-                cout << "Vaccinated regular to stock_out "<< n_r_vaccinated << " agents, for a total of "
-                     << number_vaccinated << " on day " << day << "\n";
-                cout << "Left in queues:  priority ("<< priority_queue.size() << ")    Regular ("
-                     <<queue.size() << ")\n";
-                cout << "Number of acceptances: " << accept_count << ", Number of rejections: " << reject_count << "\n";
-            }
-            return;
+            stopped_by = "stock out";
+            break;
         }
         if (current_vaccine_capacity == 0) {
-            if (Global::Verbose > 0) {
-                cout << "Vaccinated regular to capacity "<< n_r_vaccinated << " agents, for a total of "
-                     << number_vaccinated << " on day " << day << "\n";
-                cout << "Left in queues:  priority ("<< priority_queue.size() << ")    Regular ("
-                     <<queue.size() << ")\n";
-                cout << "Number of acceptances: " << accept_count << ", Number of rejections: " << reject_count << "\n";
-            }
-            return;
+            stopped_by = "capacity";
+            break;
         }
     }
+    q.compact_if_sparse();
 
     if (Global::Verbose > 0) {
-        cout << "Vaccinated regular to population " << n_r_vaccinated
-             << " agents, for a total of "<< number_vaccinated << " on day " << day << "\n";
-        cout << "Left in queues:  priority ("<< priority_queue.size() << ")    Regular ("
+        cout << "Vaccinated " << name << " to " << (stopped_by != NULL ? stopped_by : "population")
+             << " " << n_vaccinated << " agents, for a total of "
+             << number_vaccinated << " on day " << day << "\n";
+        cout << "Left in queues:  Priority ("<< priority_queue.size() << ")    Regular ("
              <<queue.size() << ")\n";
         cout << "Number of acceptances: " << accept_count << ", Number of rejections: " << reject_count << "\n";
     }
-    return;
+    return stopped_by == NULL;
+}
+
+void Vaccine_Manager::write_checkpoint(Checkpoint & checkpoint) {
+    checkpoint.write_tag("vaccine manager");
+    checkpoint.write(do_vacc);
+    if (!do_vacc) return;
+    vaccine_package->write_checkpoint(checkpoint);
+    priority_queue.write_checkpoint(checkpoint);
+    queue.write_checkpoint(checkpoint);
+    checkpoint.write_vector(queue_positions);
+    checkpoint.write(current_vaccine_capacity);
+    checkpoint.write(vaccination_capacity_map->get_current_value());
+}
+
+void Vaccine_Manager::read_checkpoint(Checkpoint & checkpoint) {
+    checkpoint.read_tag("vaccine manager");
+    bool saved_do_vacc;
+    checkpoint.read(saved_do_vacc);
+    if (saved_do_vacc != do_vacc) {
+        Utils::fred_abort("Checkpoint was taken with%s vaccination\n", saved_do_vacc ? "" : "out");
+    }
+    if (!do_vacc) return;
+    vaccine_package->read_checkpoint(checkpoint);
+    priority_queue.read_checkpoint(checkpoint);
+    queue.read_checkpoint(checkpoint);
+    checkpoint.read_vector(queue_positions);
+    checkpoint.read(current_vaccine_capacity);
+    int capacity;
+    checkpoint.read(capacity);
+    vaccination_capacity_map->set_current_value(capacity);
 }
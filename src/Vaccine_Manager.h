@@ -26,10 +26,11 @@
 #define VACC_DOSE_RAND_PRIORITY 2
 #define VACC_DOSE_LAST_PRIORITY 3
 
-#include <list>
 #include <vector>
 #include <string>
 #include "Manager.h"
+#include "Vaccine_Queue.h"
+#include "State.h"
 
 
 using namespace std;
@@ -40,6 +41,7 @@ class Vaccines;
 class Person;
 class Policy;
 class Timestep_Map;
+class Checkpoint;
 
 class Vaccine_Manager: public Manager {
     //Vaccine_Manager handles a stock of vaccines
@@ -56,10 +58,10 @@ class Vaccine_Manager: public Manager {
     Vaccines* get_vaccines()                  const {
         return vaccine_package;
     }
-    list < Person* > get_priority_queue()     const {
+    const Vaccine_Queue & get_priority_queue() const {
         return priority_queue;
     }
-    list < Person* > get_queue()              const {
+    const Vaccine_Queue & get_queue()          const {
         return queue;
     }
     int get_number_in_priority_queue()        const {
@@ -82,6 +84,15 @@ class Vaccine_Manager: public Manager {
     void add_to_priority_queue_begin(Person* person);  //Adds person to the beginning of the priority queue
     void add_to_priority_queue_end(Person* person);    //Adds person to the end of the priority queue
 
+    // People due another dose are staged by the parallel sweep of
+    // Vaccine_Health::update (add_next_dose is thread safe), then put in
+    // the queues by queue_next_doses, in population order, according to
+    // the vaccine_dose_priority
+    void add_next_dose(Person* person) {
+        next_doses().push_back(person);
+    }
+    void queue_next_doses();
+
     //Paramters Access Members
     int get_vaccine_priority_age_low()  const {
         return vaccine_priority_age_low;
@@ -99,10 +110,16 @@ class Vaccine_Manager: public Manager {
     void reset();
     void print();
 
+    // see Checkpoint; the vaccine stocks, the queues and the capacity
+    void write_checkpoint(Checkpoint & checkpoint);
+    void read_checkpoint(Checkpoint & checkpoint);
+
   private:
     Vaccines* vaccine_package;              //Pointer to the vaccines that this manager oversees
-    list < Person* > priority_queue;      //Queue for the priority agents
-    list < Person* > queue;               //Queue for everyone else
+    Vaccine_Queue priority_queue;         //Queue for the priority agents
+    Vaccine_Queue queue;                  //Queue for everyone else
+    vector < int > queue_positions;       //Position of each agent in its queue, by population index
+    State< vector < Person * > > next_doses; //People due another dose, staged by each thread
 
     //Parameters from Input
     bool   do_vacc;                         //Is Vaccination being performed
@@ -117,6 +134,9 @@ class Vaccine_Manager: public Manager {
     // gets its value from the capacity change list
     int current_vaccine_capacity;           // variable to keep track of how many persons this
     // can vaccinate each timestep.
+
+    bool vaccinate_queue(Vaccine_Queue &q, const char *name, int day,
+                         int &total_vaccines_avail, int &number_vaccinated);
 };
 
 
@@ -0,0 +1,160 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Vaccine_Queue.cc
+//
+
+#include "Vaccine_Queue.h"
+#include "Person.h"
+#include "Random.h"
+#include "Checkpoint.h"
+
+Vaccine_Queue::Vaccine_Queue() {
+  first = 0;
+  number_of_people = 0;
+  positions = NULL;
+}
+
+void Vaccine_Queue::set_positions( std::vector< int > * _positions ) {
+  positions = _positions;
+}
+
+void Vaccine_Queue::set_position( Person * person, int position ) {
+  int index = person->get_pop_index();
+  if ( index >= (int) positions->size() ) {
+    positions->resize( index + 1, -1 );
+  }
+  ( *positions )[ index ] = position;
+}
+
+int Vaccine_Queue::get_position( Person * person ) const {
+  int index = person->get_pop_index();
+  if ( index >= (int) positions->size() ) {
+    return -1;
+  }
+  return ( *positions )[ index ];
+}
+
+bool Vaccine_Queue::contains( Person * person ) const {
+  int position = get_position( person );
+  return begin() <= position && position < end() && get( position ) == person;
+}
+
+void Vaccine_Queue::assign( const std::vector< Person * > & people ) {
+  clear();
+  for ( int i = 0; i < (int) people.size(); ++i ) {
+    push_back( people[ i ] );
+  }
+}
+
+void Vaccine_Queue::clear() {
+  for ( int i = 0; i < (int) slots.size(); ++i ) {
+    if ( slots[ i ] != NULL ) {
+      set_position( slots[ i ], -1 );
+    }
+  }
+  slots.clear();
+  first = 0;
+  number_of_people = 0;
+}
+
+void Vaccine_Queue::push_front( Person * person ) {
+  slots.push_front( person );
+  --first;
+  set_position( person, first );
+  ++number_of_people;
+}
+
+void Vaccine_Queue::push_back( Person * person ) {
+  set_position( person, end() );
+  slots.push_back( person );
+  ++number_of_people;
+}
+
+void Vaccine_Queue::insert_random( Person * person ) {
+  int position = first + (int) ( RANDOM() * slots.size() );
+  if ( position == end() ) {
+    push_back( person );
+    return;
+  }
+  Person * displaced = get( position );
+  slots[ position - first ] = person;
+  set_position( person, position );
+  ++number_of_people;
+  if ( displaced != NULL ) {
+    set_position( displaced, end() );
+    slots.push_back( displaced );
+  }
+}
+
+bool Vaccine_Queue::remove( Person * person ) {
+  if ( !contains( person ) ) {
+    return false;
+  }
+  remove_at( get_position( person ) );
+  compact_if_sparse();
+  return true;
+}
+
+void Vaccine_Queue::remove_at( int position ) {
+  Person * person = get( position );
+  if ( person == NULL ) {
+    return;
+  }
+  set_position( person, -1 );
+  slots[ position - first ] = NULL;
+  --number_of_people;
+}
+
+void Vaccine_Queue::trim() {
+  // drop empty slots at the ends; the other positions are unchanged
+  while ( !slots.empty() && slots.front() == NULL ) {
+    slots.pop_front();
+    ++first;
+  }
+  while ( !slots.empty() && slots.back() == NULL ) {
+    slots.pop_back();
+  }
+  if ( slots.empty() ) {
+    first = 0;
+  }
+}
+
+void Vaccine_Queue::compact_if_sparse() {
+  trim();
+  if ( (int) slots.size() - number_of_people > number_of_people ) {
+    compact();
+  }
+}
+
+void Vaccine_Queue::compact() {
+  std::deque< Person * > people;
+  for ( int i = 0; i < (int) slots.size(); ++i ) {
+    if ( slots[ i ] != NULL ) {
+      set_position( slots[ i ], first + (int) people.size() );
+      people.push_back( slots[ i ] );
+    }
+  }
+  slots.swap( people );
+}
+
+void Vaccine_Queue::write_checkpoint( Checkpoint & checkpoint ) const {
+  checkpoint.write( first );
+  checkpoint.write( number_of_people );
+  checkpoint.write_people( slots );
+}
+
+void Vaccine_Queue::read_checkpoint( Checkpoint & checkpoint ) {
+  checkpoint.read( first );
+  checkpoint.read( number_of_people );
+  checkpoint.read_people( slots );
+}
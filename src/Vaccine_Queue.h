@@ -0,0 +1,108 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Vaccine_Queue.h
+//
+
+#ifndef _FRED_VACCINE_QUEUE_H
+#define _FRED_VACCINE_QUEUE_H
+
+/*
+ * A vaccine queue (see Vaccine_Manager) with constant-time insertion at the
+ * front, the back or a random position, and constant-time removal of any
+ * person.
+ *
+ * Entries are addressed by position.  Positions are stable: inserting at the
+ * front takes the position before the first one, and a removed entry leaves
+ * an empty slot (NULL) rather than moving the entries after it, so the queue
+ * can be walked by position while people are taken out with remove_at().
+ * Empty slots at either end are dropped by remove() and compact_if_sparse();
+ * the others are squeezed out by compact(), which renumbers the positions.
+ *
+ * Each person's position is kept in a table indexed by population index,
+ * which may be shared by several queues, since a person is in at most one.
+ */
+
+#include <deque>
+#include <vector>
+
+class Person;
+class Checkpoint;
+
+class Vaccine_Queue {
+
+public:
+
+  Vaccine_Queue();
+
+  /// @param positions the table of positions by population index
+  void set_positions( std::vector< int > * positions );
+
+  /// @return the number of people in the queue
+  int size() const { return number_of_people; }
+
+  // the positions in use are [ begin(), end() )
+  int begin() const { return first; }
+  int end() const { return first + (int) slots.size(); }
+
+  /// @return the person at the position, or NULL if the slot is empty
+  Person * get( int position ) const { return slots[ position - first ]; }
+
+  bool contains( Person * person ) const;
+
+  /// replace the contents, in the given order
+  void assign( const std::vector< Person * > & people );
+  void clear();
+
+  void push_front( Person * person );
+  void push_back( Person * person );
+
+  /**
+   * Put the person at a random position.  The person there, if any, is moved
+   * to the back.
+   */
+  void insert_random( Person * person );
+
+  /// @return <code>true</code> if the person was in the queue
+  bool remove( Person * person );
+
+  /**
+   * Empty the slot at the position, leaving begin() and end() unchanged, so
+   * it may be called while walking the queue.
+   */
+  void remove_at( int position );
+
+  /**
+   * Drop the empty slots at the ends, and squeeze out the others if they
+   * outnumber the people.  Renumbers the positions, so it must not be called
+   * while walking the queue.
+   */
+  void compact_if_sparse();
+
+  /// see Checkpoint; the positions table is written by the Vaccine_Manager
+  void write_checkpoint( Checkpoint & checkpoint ) const;
+  void read_checkpoint( Checkpoint & checkpoint );
+
+private:
+
+  std::deque< Person * > slots;
+  int first;
+  int number_of_people;
+  std::vector< int > * positions;
+
+  void set_position( Person * person, int position );
+  int get_position( Person * person ) const;
+  void trim();
+  void compact();
+};
+
+#endif // _FRED_VACCINE_QUEUE_H
@@ -29,6 +29,8 @@ using namespace std;
 #include "Vaccine_Dose.h"
 #include "Random.h"
 #include "Age_Map.h"
+#include "Checkpoint.h"
+#include "Utils.h"
 
 void Vaccines::setup(void) {
 
@@ -125,3 +127,22 @@ int Vaccines::get_total_vaccines_avail_today() const {
   }
   return total;
 }
+
+void Vaccines::write_checkpoint(Checkpoint & checkpoint) const {
+  checkpoint.write((int) vaccines.size());
+  for(unsigned int i=0;i<vaccines.size();i++){
+    vaccines[i]->write_checkpoint(checkpoint);
+  }
+}
+
+void Vaccines::read_checkpoint(Checkpoint & checkpoint) {
+  int number_vaccines;
+  checkpoint.read(number_vaccines);
+  if(number_vaccines != (int) vaccines.size()) {
+    Utils::fred_abort("Checkpoint has %d vaccines, but the parameters have %d\n",
+        number_vaccines, (int) vaccines.size());
+  }
+  for(unsigned int i=0;i<vaccines.size();i++){
+    vaccines[i]->read_checkpoint(checkpoint);
+  }
+}
@@ -19,6 +19,7 @@
 
 class Vaccine;
 class Vaccine_Dose;
+class Checkpoint;
 
 class Vaccines {
   // Vaccines is a class used to describe a group of Vaccine Classes
@@ -28,6 +29,7 @@ public:
   void setup();
   
   Vaccine *get_vaccine(int i) const { return vaccines[i];}
+  int get_number_vaccines() const { return vaccines.size(); }
   
   vector <int> which_vaccines_applicable(int age) const;
   int pick_from_applicable_vaccines(int age) const;
@@ -39,6 +41,10 @@ public:
   void print_current_stocks() const;
   void update(int day);
   void reset();
+
+  // see Checkpoint
+  void write_checkpoint(Checkpoint & checkpoint) const;
+  void read_checkpoint(Checkpoint & checkpoint);
 private:
   vector < Vaccine* > vaccines;
 }; 
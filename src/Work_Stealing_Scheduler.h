@@ -0,0 +1,272 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: Work_Stealing_Scheduler.h
+//
+
+#ifndef _FRED_WORK_STEALING_SCHEDULER_H
+#define _FRED_WORK_STEALING_SCHEDULER_H
+
+/*
+ * Work-stealing scheduler for irregular parallel sweeps (bloque sweeps and
+ * Epidemic::transmit), used when Global::Enable_Work_Stealing is set.
+ *
+ * A sweep is described up front as a list of tasks, each with an estimated
+ * cost.  run() sorts the tasks heaviest first and deals them out to one queue
+ * per thread in alternating ("snake") order, so that every thread starts with
+ * about the same estimated load and the largest tasks start first.  A thread
+ * takes work from the front of its own queue and, when that is empty, steals
+ * from the back of the other threads' queues, which evens out misestimated
+ * costs at the end of the sweep.
+ *
+ * With a single thread the tasks are run in the order in which they were added.
+ *
+ * For each thread the time spent in tasks (busy) and the time spent waiting
+ * for the rest of the sweep to finish (idle) are accumulated over all sweeps;
+ * see report().
+ *
+ * Header-only so that Bloque.h remains self-contained.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <sys/time.h>
+#include <assert.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class Work_Stealing_Scheduler {
+
+public:
+
+  /**
+   * A unit of work: what 'index' and [first, last) refer to is up to the
+   * caller (e.g. a bloque block and a range of its registers, or a place and a
+   * range of its infectious visitors).
+   */
+  struct Task {
+    int index;
+    int first;
+    int last;
+    double cost;
+  };
+
+  Work_Stealing_Scheduler() : queues( NULL ), number_queues( 0 ), sweeps( 0 ) { }
+
+  ~Work_Stealing_Scheduler() { delete[] queues; }
+
+  void clear() { tasks.clear(); }
+
+  void add_task( int index, int first, int last, double cost ) {
+    Task task = { index, first, last, cost };
+    tasks.push_back( task );
+  }
+
+  int get_number_of_tasks() { return tasks.size(); }
+
+  /**
+   * Run all tasks added since the last clear(), calling f( task ) for each;
+   * the tasks are cleared afterwards.  Must not be called from inside a
+   * parallel region.
+   */
+  template < typename Functor >
+  void run( Functor & f ) {
+    int number_threads = get_max_threads();
+    setup( number_threads );
+    ++sweeps;
+    double sweep_start = get_time();
+    if ( number_threads == 1 || tasks.size() <= 1 ) {
+      for ( int i = 0; i < tasks.size(); ++i ) {
+        f( tasks[ i ] );
+      }
+      double elapsed = get_time() - sweep_start;
+      stats[ 0 ].busy += elapsed;
+      stats[ 0 ].tasks += tasks.size();
+      for ( int t = 1; t < number_threads; ++t ) {
+        stats[ t ].idle += elapsed;
+      }
+      tasks.clear();
+      return;
+    }
+
+    // deal out heaviest first; ties keep the order in which they were added
+    std::stable_sort( tasks.begin(), tasks.end(), heavier );
+    for ( int t = 0; t < number_threads; ++t ) {
+      queues[ t ].items.clear();
+    }
+    for ( int i = 0; i < tasks.size(); ++i ) {
+      int round = i / number_threads;
+      int t = i % number_threads;
+      queues[ ( round % 2 == 0 ) ? t : number_threads - 1 - t ].items.push_back( i );
+    }
+    for ( int t = 0; t < number_threads; ++t ) {
+      queues[ t ].head = 0;
+      queues[ t ].tail = queues[ t ].items.size();
+      sweep_busy[ t ] = 0.0;
+    }
+
+    #pragma omp parallel
+    {
+      int t = get_thread_num();
+      double busy = 0.0;
+      long executed = 0;
+      long stolen = 0;
+      int i;
+      bool was_stolen;
+      while ( next_task( t, number_threads, & i, & was_stolen ) ) {
+        double task_start = get_time();
+        f( tasks[ i ] );
+        busy += get_time() - task_start;
+        ++executed;
+        if ( was_stolen ) { ++stolen; }
+      }
+      sweep_busy[ t ] = busy;
+      stats[ t ].tasks += executed;
+      stats[ t ].steals += stolen;
+    }
+
+    double elapsed = get_time() - sweep_start;
+    for ( int t = 0; t < number_threads; ++t ) {
+      stats[ t ].busy += sweep_busy[ t ];
+      stats[ t ].idle += elapsed - sweep_busy[ t ];
+    }
+    tasks.clear();
+  }
+
+  /**
+   * Print accumulated per-thread busy and idle times.  Efficiency is the
+   * fraction of thread time spent in tasks.
+   */
+  void report( FILE * fp, const char * name ) {
+    double total_busy = 0.0;
+    double total_idle = 0.0;
+    fprintf( fp, "%s: %d sweeps on %d threads\n", name, sweeps, number_queues );
+    for ( int t = 0; t < number_queues; ++t ) {
+      fprintf( fp, "%s: thread %3d busy %10.3f s idle %10.3f s tasks %10ld stolen %10ld\n",
+          name, t, stats[ t ].busy, stats[ t ].idle, stats[ t ].tasks, stats[ t ].steals );
+      total_busy += stats[ t ].busy;
+      total_idle += stats[ t ].idle;
+    }
+    if ( total_busy + total_idle > 0.0 ) {
+      fprintf( fp, "%s: efficiency %.1f%%\n", name,
+          100.0 * total_busy / ( total_busy + total_idle ) );
+    }
+    fflush( fp );
+  }
+
+private:
+
+  struct Thread_Stats {
+    double busy;
+    double idle;
+    long tasks;
+    long steals;
+    Thread_Stats() : busy( 0.0 ), idle( 0.0 ), tasks( 0 ), steals( 0 ) { }
+  };
+
+  // task positions; the owner takes from head, thieves from tail
+  struct Task_Queue {
+    std::vector< int > items;
+    int head;
+    int tail;
+    #ifdef _OPENMP
+    omp_lock_t lock;
+    Task_Queue() : head( 0 ), tail( 0 ) { omp_init_lock( & lock ); }
+    ~Task_Queue() { omp_destroy_lock( & lock ); }
+    void Lock() { omp_set_lock( & lock ); }
+    void Unlock() { omp_unset_lock( & lock ); }
+    #else
+    Task_Queue() : head( 0 ), tail( 0 ) { }
+    void Lock() { }
+    void Unlock() { }
+    #endif
+    // keep queues on separate cache lines
+    char padding[ 64 ];
+  };
+
+  std::vector< Task > tasks;
+  Task_Queue * queues;
+  int number_queues;
+  std::vector< Thread_Stats > stats;
+  std::vector< double > sweep_busy;
+  int sweeps;
+
+  static bool heavier( const Task & a, const Task & b ) { return a.cost > b.cost; }
+
+  void setup( int number_threads ) {
+    if ( number_threads > number_queues ) {
+      delete[] queues;
+      queues = new Task_Queue[ number_threads ];
+      number_queues = number_threads;
+      stats.resize( number_threads );
+      sweep_busy.resize( number_threads );
+    }
+  }
+
+  bool next_task( int t, int number_threads, int * i, bool * was_stolen ) {
+    Task_Queue & own = queues[ t ];
+    own.Lock();
+    if ( own.head < own.tail ) {
+      *i = own.items[ own.head++ ];
+      own.Unlock();
+      *was_stolen = false;
+      return true;
+    }
+    own.Unlock();
+    for ( int n = 1; n < number_threads; ++n ) {
+      Task_Queue & victim = queues[ ( t + n ) % number_threads ];
+      victim.Lock();
+      if ( victim.head < victim.tail ) {
+        *i = victim.items[ --victim.tail ];
+        victim.Unlock();
+        *was_stolen = true;
+        return true;
+      }
+      victim.Unlock();
+    }
+    return false;
+  }
+
+  static double get_time() {
+    #ifdef _OPENMP
+    return omp_get_wtime();
+    #else
+    struct timeval tv;
+    gettimeofday( & tv, NULL );
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+    #endif
+  }
+
+  static int get_max_threads() {
+    #ifdef _OPENMP
+    return omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+  }
+
+  static int get_thread_num() {
+    #ifdef _OPENMP
+    return omp_get_thread_num();
+    #else
+    return 0;
+    #endif
+  }
+
+  Work_Stealing_Scheduler( const Work_Stealing_Scheduler & );
+  void operator=( const Work_Stealing_Scheduler & );
+};
+
+#endif // _FRED_WORK_STEALING_SCHEDULER_H
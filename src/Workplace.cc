@@ -23,6 +23,7 @@
 #include "Place_List.h"
 #include "Office.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 
 //Private static variables that will be set by parameter lookups
 double * Workplace::Workplace_contacts_per_day;
@@ -178,3 +179,13 @@ Place * Workplace::assign_office(Person *per) {
     next_office = 0;
   return offices[i];
 }
+
+void Workplace::write_checkpoint(Checkpoint & checkpoint) {
+  Place::write_checkpoint(checkpoint);
+  checkpoint.write(next_office);
+}
+
+void Workplace::read_checkpoint(Checkpoint & checkpoint) {
+  Place::read_checkpoint(checkpoint);
+  checkpoint.read(next_office);
+}
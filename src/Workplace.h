@@ -89,6 +89,12 @@ public:
    */
   Place * assign_office(Person *per);
 
+  /**
+   * @see Place::write_checkpoint(Checkpoint & checkpoint)
+   */
+  void write_checkpoint(Checkpoint & checkpoint);
+  void read_checkpoint(Checkpoint & checkpoint);
+
   /**
    * Determine if the Workplace should be open. It is dependent on the disease and simulation day.
    *
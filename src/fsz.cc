@@ -33,7 +33,9 @@ int main( int argc, char *argv[] ) {
 
   char * filename;
 
-  while ((f = getopt (argc, argv, "c:u:")) != -1) {
+  size_t block_size = 1ul << 25;
+
+  while ((f = getopt (argc, argv, "c:u:b:")) != -1) {
     switch (f) {
       case 'c':
         compress_flag = 1;
@@ -43,10 +45,15 @@ int main( int argc, char *argv[] ) {
         uncompress_flag = 1;
         filename = optarg;
         break;
+      case 'b':
+        block_size = strtoul( optarg, NULL, 10 );
+        break;
       case '?':
         std::cerr << "\nfsz, FRED's snappy compression utility.  Usage:\n\n";
         std::cerr << "  fsz -c <file> => file will be compressed using snappy and written to stdout\n";
-        std::cerr << "  fsz -u <file> => file assumed to have been compressed with snappy; will be uncompressed to stdout\n\n";
+        std::cerr << "  fsz -u <file> => file assumed to have been compressed with snappy; will be uncompressed to stdout\n";
+        std::cerr << "  fsz -b <bytes> -c <file> => compress in blocks of about <bytes> bytes (default 32 MB);\n";
+        std::cerr << "    smaller blocks let more threads uncompress the file in parallel\n\n";
         break;
       default:
         abort();
@@ -65,7 +72,7 @@ int main( int argc, char *argv[] ) {
   SnappyFileCompression compressor = SnappyFileCompression( filename );
 
   if ( compress_flag ) {
-    compressor.compress_file_to_stdout();
+    compressor.compress_file_to_stdout( block_size );
   }
   else if ( uncompress_flag ) {
     compressor.uncompress_file_to_stdout();
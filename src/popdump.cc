@@ -0,0 +1,132 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette,
+  Shawn Brown, Roni Rosenfield, Alona Fyshe, David Galloway, Nathan
+  Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+// File: popdump.cc
+//
+// Reads the population dumps written when output_population is set (see
+// Population_Dump.h).
+//
+
+#include <string>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Population_Dump.h"
+
+static const Population_Dump::Column * get_column( const Population_Dump::Frame & frame,
+    const char * name, size_t element_size, size_t n ) {
+  const Population_Dump::Column * column = frame.find_column( name );
+  if ( column == NULL || column->element_size != element_size
+      || column->get_number_of_elements() != n ) {
+    std::cerr << frame.filename << ": missing or malformed column " << name << "\n";
+    exit( 1 );
+  }
+  return column;
+}
+
+static void print_info( const Population_Dump::Frame & frame ) {
+  printf( "file %s\n", frame.filename.c_str() );
+  printf( "day %d date %s diseases %d persons %llu places %llu\n", frame.day,
+      frame.date.c_str(), frame.number_of_diseases,
+      (unsigned long long) frame.number_persons, (unsigned long long) frame.number_places );
+  for ( int i = 0; i < frame.number_columns; ++i ) {
+    const Population_Dump::Column & column = frame.columns[ i ];
+    printf( "  %-20s %3u bytes x %llu\n", column.name.c_str(), column.element_size,
+        (unsigned long long) column.get_number_of_elements() );
+  }
+}
+
+// the format of the text population output file of earlier versions:
+// id age sex race household school classroom workplace office relationship
+static void print_text( const Population_Dump::Frame & frame ) {
+  size_t n = frame.number_persons;
+  size_t number_places = frame.number_places;
+  const int32_t * id = get_column( frame, "id", 4, n )->get< int32_t >();
+  const int16_t * age = get_column( frame, "age", 2, n )->get< int16_t >();
+  const char * sex = get_column( frame, "sex", 1, n )->get< char >();
+  const int16_t * race = get_column( frame, "race", 2, n )->get< int16_t >();
+  const int16_t * relationship = get_column( frame, "relationship", 2, n )->get< int16_t >();
+  const char * places[] = { "household", "school", "classroom", "workplace", "office" };
+  const int32_t * place[ 5 ];
+  for ( int j = 0; j < 5; ++j ) {
+    place[ j ] = get_column( frame, places[ j ], 4, n )->get< int32_t >();
+  }
+  const char * label = get_column( frame, "place_label", 32, number_places )->get< char >();
+
+  for ( size_t i = 0; i < n; ++i ) {
+    printf( "%d %d %c %d", id[ i ], age[ i ], sex[ i ], race[ i ] );
+    for ( int j = 0; j < 5; ++j ) {
+      int32_t p = place[ j ][ i ];
+      if ( p < 0 || (size_t) p >= number_places ) {
+        printf( " -1" );
+      }
+      else {
+        printf( " %.32s", label + 32 * (size_t) p );
+      }
+    }
+    printf( " %d\n", relationship[ i ] );
+  }
+}
+
+int main( int argc, char *argv[] ) {
+
+  int info_flag = 0;
+  int text_flag = 0;
+
+  opterr = 0;
+  extern char * optarg;
+
+  int f;
+
+  char * filename = NULL;
+
+  while ((f = getopt (argc, argv, "i:t:")) != -1) {
+    switch (f) {
+      case 'i':
+        info_flag = 1;
+        filename = optarg;
+        break;
+      case 't':
+        text_flag = 1;
+        filename = optarg;
+        break;
+      default:
+        std::cerr << "\npopdump, FRED's population dump reader.  Usage:\n\n";
+        std::cerr << "  popdump -i <file> => print the day, counts and columns of the dump\n";
+        std::cerr << "  popdump -t <file> => write the people to stdout in the text format of\n";
+        std::cerr << "    the population output files of earlier versions\n\n";
+        exit(1);
+    }
+  }
+
+  if ( info_flag == text_flag ) {
+    std::cerr << "Specify either [-i] or [-t]\n\n";
+    exit(1);
+  }
+
+  Population_Dump::Frame frame;
+  std::string error;
+  if ( !Population_Dump::read( filename, frame, error ) ) {
+    std::cerr << error << "\n";
+    exit(1);
+  }
+
+  if ( info_flag ) {
+    print_info( frame );
+  }
+  else {
+    print_text( frame );
+  }
+  return 0;
+}